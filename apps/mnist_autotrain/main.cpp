@@ -88,6 +88,17 @@ float compute_score(	const int i,
     return score;
 }
 
+// loads binary samples file if available (cf. samples_converter), csv file otherwise
+void _load_kaggle_samples( samples_manager& smp_manager, const std::string& basename )
+{
+    std::ifstream binary_file( basename + ".bin" );
+
+    if ( binary_file.good() )
+        smp_manager.load_binary_samples( basename + ".bin" );
+    else
+        smp_manager.load_kaggle_digit_recognizer( basename + ".csv" );
+}
+
 int main( int argc, char *argv[] )
 {
     std::cout << "Welcome to mnist_autotrain!" << std::endl;
@@ -138,13 +149,13 @@ int main( int argc, char *argv[] )
         if ( train_restrict )
             smp_train_manager.restrict_dataset( train_restrict );
         //smp_train_manager.load_samples( "../nets/mnist/training/mnist-train.txt" );
-        smp_train_manager.load_kaggle_digit_recognizer( "../nets/mnist/training/kaggle/train.csv" );
+        _load_kaggle_samples( smp_train_manager, "../nets/mnist/training/kaggle/train" );
 
         samples_manager smp_validate_manager;
         if ( valid_restrict )
             smp_validate_manager.restrict_dataset( valid_restrict );
         //smp_validate_manager.load_samples( "../nets/mnist/training/mnist-validate.txt" );
-        smp_validate_manager.load_kaggle_digit_recognizer( "../nets/mnist/training/kaggle/test.csv" );
+        _load_kaggle_samples( smp_validate_manager, "../nets/mnist/training/kaggle/test" );
 
         std::shared_ptr<network_manager_interface> net_manager = network_factory::build();
         //net_manager->load_network( "../nets/mnist/topology-mnist.txt", "../nets/mnist/weights-mnist.bin" );
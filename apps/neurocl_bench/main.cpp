@@ -0,0 +1,458 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "neurocl.h"
+#include "common/network_sample.h"
+#include "common/samples_file.h"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+using namespace neurocl;
+namespace bfs = boost::filesystem;
+namespace po = boost::program_options;
+namespace pt = boost::property_tree;
+
+using t_clock = std::chrono::steady_clock;
+
+struct topology_info
+{
+    bool convnet;
+    size_t input_x;
+    size_t input_y;
+    size_t input_size;
+    size_t output_size;
+};
+
+struct bench_config
+{
+    std::string backend;
+    size_t threads;
+};
+
+// POD result sent back by the benchmark child process
+struct bench_result
+{
+    int status;
+    float train_sps;
+    float p50_us;
+    float p99_us;
+    long peak_rss_kb;
+    char error[256];
+};
+
+struct bench_params
+{
+    std::string topology;
+    std::string weights;
+    std::string samples;
+    size_t epochs;
+    size_t batch_size;
+    size_t inferences;
+};
+
+topology_info read_topology( const std::string& topology_path )
+{
+    std::ifstream topology( topology_path );
+    if ( !topology || !topology.is_open() )
+        throw network_exception( "error opening topology file " + topology_path );
+
+    std::vector<std::vector<std::string>> layers;
+    std::string line;
+    while ( std::getline( topology, line ) )
+    {
+        if ( !boost::starts_with( line, "layer" ) )
+            continue;
+
+        std::vector<std::string> split_vec;
+        boost::split( split_vec, line, boost::is_any_of(":x") );
+        layers.push_back( split_vec );
+    }
+
+    if ( layers.empty() )
+        throw network_exception( "empty topology file" );
+
+    // convnet layers declare their type (layer:conv:1:24x24x6:5), mlp layers do not (layer:1:6x6)
+    topology_info info;
+    info.convnet = !std::all_of( layers.front()[1].begin(), layers.front()[1].end(), ::isdigit );
+
+    auto _size = [&info]( const std::vector<std::string>& layer, size_t& x, size_t& y ) {
+        const size_t first = info.convnet ? 3 : 2;
+        if ( layer.size() < first + 2 )
+            throw network_exception( "malformed line in topology file" );
+        x = std::stoul( layer[first] );
+        y = std::stoul( layer[first+1] );
+        const size_t z = ( info.convnet && ( layer.size() > first + 2 ) ) ? std::stoul( layer[first+2] ) : 1;
+        return x * y * z;
+    };
+
+    size_t output_x, output_y;
+    info.input_size = _size( layers.front(), info.input_x, info.input_y );
+    info.output_size = _size( layers.back(), output_x, output_y );
+    info.input_y = info.input_size / info.input_x;
+
+    return info;
+}
+
+// uniform random inputs with random one-hot outputs, no dataset needed
+void write_synthetic_samples( const std::string& filename, const topology_info& info, const size_t count )
+{
+    std::mt19937 rng( 42 );
+    std::uniform_real_distribution<float> input_dist( 0.f, 1.f );
+
+    std::vector<float> data( count * ( info.input_size + info.output_size ), 0.f );
+    std::vector<sample> samples;
+
+    for ( size_t i=0; i<count; i++ )
+    {
+        float* isample = data.data() + i * ( info.input_size + info.output_size );
+        float* osample = isample + info.input_size;
+
+        std::generate( isample, osample, [&]() { return input_dist( rng ); } );
+        osample[rng() % info.output_size] = 1.f;
+
+        samples.emplace_back( info.input_size, isample, info.output_size, osample );
+    }
+
+    samples_file::write( filename, samples, info.input_x, info.input_y );
+}
+
+network_factory::t_neural_backend to_backend( const std::string& backend )
+{
+    if ( backend == "BNU_REF" )
+        return network_factory::t_neural_backend::NEURAL_BACKEND_BNU_REF;
+    else if ( backend == "BNU_FAST" )
+        return network_factory::t_neural_backend::NEURAL_BACKEND_BNU_FAST;
+    else if ( backend == "CONVNET" )
+        return network_factory::t_neural_backend::NEURAL_BACKEND_DEFAULT;
+    else if ( backend == "CONVNET_PARALLEL" )
+        return network_factory::t_neural_backend::NEURAL_BACKEND_PARALLEL;
+    else
+        throw network_exception( "unmanaged benchmark backend : " + backend );
+}
+
+void run_bench( const bench_config& config, const bench_params& params, const topology_info& info, bench_result& result )
+{
+    // random initial weights are used when no weights file is given
+    const std::string weights = params.weights.empty() ?
+        ( bfs::temp_directory_path() / bfs::unique_path( "neurocl-bench-%%%%-%%%%.bin" ) ).string() : params.weights;
+
+    try
+    {
+        std::shared_ptr<network_manager_interface> net = network_factory::build(
+            info.convnet ? network_factory::t_neural_impl::NEURAL_IMPL_CONVNET : network_factory::t_neural_impl::NEURAL_IMPL_MLP,
+            to_backend( config.backend ), config.threads );
+        net->load_network( params.topology, weights );
+
+        samples_manager smp;
+        smp.load_binary_samples( params.samples );
+
+        // training throughput
+        const t_clock::time_point start = t_clock::now();
+        net->batch_train( smp, params.epochs, params.batch_size );
+        const double train_seconds = std::chrono::duration<double>( t_clock::now() - start ).count();
+        result.train_sps = static_cast<float>( params.epochs * smp.samples_size() / train_seconds );
+
+        // single sample inference latency
+        const std::vector<sample>& samples = smp.get_samples();
+        std::vector<float> output( info.output_size );
+        std::vector<double> latencies;
+
+        for ( size_t i=0; i<params.inferences + 10; i++ )
+        {
+            const sample& s = samples[i % samples.size()];
+            sample _s( s.isample_size, s.isample, s.osample_size, output.data() );
+
+            const t_clock::time_point inference_start = t_clock::now();
+            net->compute_output( _s );
+            if ( i >= 10 ) // warmup
+                latencies.push_back( std::chrono::duration<double,std::micro>( t_clock::now() - inference_start ).count() );
+        }
+
+        std::sort( latencies.begin(), latencies.end() );
+        auto _percentile = [&latencies]( const double p ) {
+            return static_cast<float>( latencies[ std::min( latencies.size() - 1, static_cast<size_t>( p * latencies.size() ) ) ] );
+        };
+        result.p50_us = _percentile( 0.50 );
+        result.p99_us = _percentile( 0.99 );
+
+        result.status = 0;
+    }
+    catch( std::exception& e )
+    {
+        result.status = 1;
+        std::strncpy( result.error, e.what(), sizeof( result.error ) - 1 );
+    }
+
+    if ( params.weights.empty() )
+        bfs::remove( weights );
+
+    struct rusage usage;
+    getrusage( RUSAGE_SELF, &usage );
+#ifdef __APPLE__
+    result.peak_rss_kb = usage.ru_maxrss / 1024; // bytes on OSX
+#else
+    result.peak_rss_kb = usage.ru_maxrss;
+#endif
+}
+
+// each configuration runs in its own process : isolated peak RSS, and no state shared between
+// backends (network_parallel shares tensors through a global tank)
+bench_result fork_bench( const bench_config& config, const bench_params& params, const topology_info& info )
+{
+    bench_result result;
+    std::memset( &result, 0, sizeof( bench_result ) );
+
+    int fds[2];
+    if ( pipe( fds ) != 0 )
+        throw network_exception( "unable to create benchmark pipe" );
+
+    std::cout << std::flush;
+
+    const pid_t pid = fork();
+    if ( pid < 0 )
+        throw network_exception( "unable to fork benchmark process" );
+
+    if ( pid == 0 )
+    {
+        close( fds[0] );
+
+        // training progress would garble the report
+        if ( !std::freopen( "/dev/null", "w", stdout ) )
+            _exit( 1 );
+
+        run_bench( config, params, info, result );
+
+        const ssize_t written = write( fds[1], &result, sizeof( bench_result ) );
+        close( fds[1] );
+        _exit( ( written == sizeof( bench_result ) ) ? 0 : 1 );
+    }
+
+    close( fds[1] );
+    const ssize_t read_size = read( fds[0], &result, sizeof( bench_result ) );
+    close( fds[0] );
+
+    int status = 0;
+    waitpid( pid, &status, 0 );
+
+    if ( read_size != sizeof( bench_result ) )
+    {
+        std::memset( &result, 0, sizeof( bench_result ) );
+        result.status = 1;
+        std::strncpy( result.error, "benchmark process crashed", sizeof( result.error ) - 1 );
+    }
+
+    return result;
+}
+
+std::string config_key( const bench_config& config )
+{
+    return config.backend + "_" + std::to_string( config.threads );
+}
+
+int main( int argc, char *argv[] )
+{
+    std::cout << "Welcome to neurocl_bench!" << std::endl;
+
+    bench_params params;
+    std::vector<std::string> backends;
+    std::vector<size_t> threads;
+    size_t samples_size;
+    std::string baseline;
+    bool update_baseline = false;
+    float tolerance;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("topology,t", po::value<std::string>( &params.topology )->required(), "network topology file")
+        ("weights,w", po::value<std::string>( &params.weights ), "weights file (random weights if not given)")
+        ("backends,b", po::value<std::vector<std::string>>( &backends )->multitoken(), "benchmarked backends : BNU_REF / BNU_FAST (mlp), CONVNET / CONVNET_PARALLEL (convnet), all topology backends by default")
+        ("threads,j", po::value<std::vector<size_t>>( &threads )->multitoken(), "CONVNET_PARALLEL threads counts (powers of two up to hardware concurrency by default)")
+        ("samples,s", po::value<size_t>( &samples_size )->default_value( 1000 ), "synthetic training samples count")
+        ("epochs,e", po::value<size_t>( &params.epochs )->default_value( 1 ), "training epochs")
+        ("batch,n", po::value<size_t>( &params.batch_size )->default_value( 10 ), "training mini-batch size")
+        ("inferences,i", po::value<size_t>( &params.inferences )->default_value( 1000 ), "timed single sample inferences")
+        ("baseline", po::value<std::string>( &baseline ), "JSON baseline results file to compare with")
+        ("update-baseline", po::bool_switch( &update_baseline ), "write current results to the baseline file")
+        ("tolerance", po::value<float>( &tolerance )->default_value( 0.1f ), "relative regression tolerance against the baseline")
+    ;
+
+    po::variables_map vm;
+    po::store( po::parse_command_line( argc, argv, desc ), vm );
+
+    if ( vm.count( "help" ) )
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    bool regression = false;
+
+    try
+    {
+        po::notify( vm );
+
+        const topology_info info = read_topology( params.topology );
+
+        if ( backends.empty() )
+            backends = info.convnet ? std::vector<std::string>{ "CONVNET", "CONVNET_PARALLEL" }
+                : std::vector<std::string>{ "BNU_REF", "BNU_FAST" };
+
+        if ( threads.empty() )
+        {
+            // network_parallel manages at most 10 concurrent tasks
+            const size_t hardware_threads = std::min( 10u, std::max( 1u, std::thread::hardware_concurrency() ) );
+            for ( size_t t=1; t<hardware_threads; t*=2 )
+                threads.push_back( t );
+            threads.push_back( hardware_threads );
+        }
+
+        std::vector<bench_config> configs;
+        for ( const auto& backend : backends )
+        {
+            if ( backend == "CONVNET_PARALLEL" )
+                for ( const auto& t : threads )
+                    configs.push_back( bench_config{ backend, t } );
+            else
+                configs.push_back( bench_config{ backend, 1 } );
+        }
+
+        params.samples = ( bfs::temp_directory_path() / bfs::unique_path( "neurocl-bench-%%%%-%%%%.smp" ) ).string();
+        write_synthetic_samples( params.samples, info, samples_size );
+
+        pt::ptree baseline_tree;
+        const bool compare = !baseline.empty() && bfs::exists( baseline ) && !update_baseline;
+        if ( compare )
+            pt::read_json( baseline, baseline_tree );
+
+        pt::ptree results_tree;
+
+        std::cout << std::endl << "| Implementation | Threads | Training | Inference p50 | Inference p99 | Peak RSS |" << std::endl;
+        std::cout << "| :--- | :---: | :---: | :---: | :---: | :---: |" << std::endl;
+        std::cout << "| `" << bfs::path( params.topology ).filename().string() << " - " << samples_size << " samples / "
+            << params.epochs << " epochs / " << params.batch_size << " samples per batch` | | | | | |" << std::endl;
+
+        for ( const auto& config : configs )
+        {
+            const bench_result result = fork_bench( config, params, info );
+
+            if ( result.status != 0 )
+            {
+                std::cout << "| " << config.backend << " | " << config.threads << " | " << result.error << " | | | |" << std::endl;
+                continue;
+            }
+
+            // training throughput and median latency are checked, p99 is too noisy
+            std::string train_delta, latency_delta;
+            if ( compare )
+            {
+                const std::string key = config_key( config );
+                const boost::optional<float> base_sps = baseline_tree.get_optional<float>( key + ".train_sps" );
+                const boost::optional<float> base_p50 = baseline_tree.get_optional<float>( key + ".p50_us" );
+
+                auto _delta = []( const float value, const float base ) {
+                    std::stringstream ss;
+                    ss << std::showpos << std::fixed << std::setprecision( 1 ) << 100.f * ( value - base ) / base << "%";
+                    return ss.str();
+                };
+
+                if ( base_sps && ( base_sps.get() > 0.f ) )
+                {
+                    const bool regressed = result.train_sps < base_sps.get() * ( 1.f - tolerance );
+                    train_delta = " (" + _delta( result.train_sps, base_sps.get() ) + ( regressed ? " REGRESSION" : "" ) + ")";
+                    regression |= regressed;
+                }
+                if ( base_p50 && ( base_p50.get() > 0.f ) )
+                {
+                    const bool regressed = result.p50_us > base_p50.get() * ( 1.f + tolerance );
+                    latency_delta = " (" + _delta( result.p50_us, base_p50.get() ) + ( regressed ? " REGRESSION" : "" ) + ")";
+                    regression |= regressed;
+                }
+            }
+
+            std::cout << std::fixed << std::setprecision( 1 )
+                << "| " << config.backend << " | " << config.threads
+                << " | " << result.train_sps << " samples/s" << train_delta
+                << " | " << std::setprecision( 3 ) << result.p50_us / 1000.f << "ms" << latency_delta
+                << " | " << result.p99_us / 1000.f << "ms"
+                << " | " << std::setprecision( 1 ) << result.peak_rss_kb / 1024.f << "MB |" << std::endl;
+
+            pt::ptree result_tree;
+            result_tree.put( "train_sps", result.train_sps );
+            result_tree.put( "p50_us", result.p50_us );
+            result_tree.put( "p99_us", result.p99_us );
+            result_tree.put( "peak_rss_kb", result.peak_rss_kb );
+            results_tree.add_child( config_key( config ), result_tree );
+        }
+
+        bfs::remove( params.samples );
+
+        if ( !baseline.empty() && ( update_baseline || !bfs::exists( baseline ) ) )
+        {
+            pt::write_json( baseline, results_tree );
+            std::cout << std::endl << "baseline results written to " << baseline << std::endl;
+        }
+
+        if ( regression )
+            std::cout << std::endl << "performance regression against baseline " << baseline
+                << " (tolerance " << 100.f * tolerance << "%)" << std::endl;
+    }
+    catch( po::error& e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return -1;
+    }
+    catch( neurocl::network_exception& e )
+    {
+        std::cerr << "network exception : " << e.what() << std::endl;
+        return -1;
+    }
+    catch( std::exception& e )
+    {
+        std::cerr << "std::exception : " << e.what() << std::endl;
+        return -1;
+    }
+
+    return regression ? 2 : 0;
+}
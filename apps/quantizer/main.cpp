@@ -0,0 +1,177 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "neurocl.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+using namespace neurocl;
+namespace po = boost::program_options;
+
+void load_samples( samples_manager& smp_manager, const std::string& input, const std::string& format )
+{
+    if ( format == "binary" )
+        smp_manager.load_binary_samples( input );
+    else if ( format == "kaggle" )
+        smp_manager.load_kaggle_digit_recognizer( input );
+    else if ( format == "samples" )
+        smp_manager.load_samples( input );
+    else
+        throw network_exception( "unmanaged samples format : " + format );
+}
+
+size_t max_comp_idx( const float* values, const size_t size )
+{
+    return std::distance( values, std::max_element( values, values + size ) );
+}
+
+int main( int argc, char *argv[] )
+{
+    std::cout << "Welcome to quantizer!" << std::endl;
+
+    std::string topology;
+    std::string weights;
+    std::string output;
+    std::string calibration;
+    std::string validation;
+    std::string format;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("topology,t", po::value<std::string>( &topology )->required(), "convnet topology file")
+        ("weights,w", po::value<std::string>( &weights )->required(), "float weights file")
+        ("output,o", po::value<std::string>( &output )->required(), "output int8 quantized weights file")
+        ("calibration,c", po::value<std::string>( &calibration )->required(), "calibration samples")
+        ("validation,v", po::value<std::string>( &validation ), "validation samples (accuracy report)")
+        ("format,f", po::value<std::string>( &format )->default_value( "binary" ), "samples format : binary (samples file) / samples (images list) / kaggle (digit recognizer csv)")
+    ;
+
+    po::variables_map vm;
+    po::store( po::parse_command_line( argc, argv, desc ), vm );
+
+    if ( vm.count( "help" ) )
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    logger_manager& lm = logger_manager::instance();
+    lm.add_logger( policy_type::cout, "quantizer" );
+
+    try
+    {
+        po::notify( vm );
+
+        // int8 network saves to its loaded weights file : float weights are copied to output first
+        {
+            std::ifstream weights_in( weights, std::ios::in | std::ios::binary );
+            std::ofstream weights_out( output, std::ios::out | std::ios::binary | std::ios::trunc );
+            if ( !weights_in || !weights_out )
+                throw network_exception( "unable to copy weights file to " + output );
+            weights_out << weights_in.rdbuf();
+        }
+
+        std::shared_ptr<network_manager_interface> int8_net = network_factory::build(
+            network_factory::t_neural_impl::NEURAL_IMPL_CONVNET, network_factory::t_neural_backend::NEURAL_BACKEND_INT8 );
+        int8_net->load_network( topology, output );
+
+        samples_manager calibration_smp;
+        load_samples( calibration_smp, calibration, format );
+
+        int8_net->calibrate( calibration_smp );
+        int8_net->save_network();
+
+        std::cout << "calibrated on " << calibration_smp.samples_size() << " samples, quantized weights saved to " << output << std::endl;
+
+        if ( validation.empty() )
+            return 0;
+
+        std::shared_ptr<network_manager_interface> float_net = network_factory::build(
+            network_factory::t_neural_impl::NEURAL_IMPL_CONVNET );
+        float_net->load_network( topology, weights );
+
+        samples_manager validation_smp;
+        load_samples( validation_smp, validation, format );
+
+        size_t float_success = 0;
+        size_t int8_success = 0;
+        size_t agreement = 0;
+        float max_output_delta = 0.f;
+
+        for ( const auto& s : validation_smp.get_samples() )
+        {
+            std::vector<float> float_output( s.osample_size );
+            std::vector<float> int8_output( s.osample_size );
+
+            sample _float_sample( s.isample_size, s.isample, s.osample_size, float_output.data() );
+            float_net->compute_output( _float_sample );
+            sample _int8_sample( s.isample_size, s.isample, s.osample_size, int8_output.data() );
+            int8_net->compute_output( _int8_sample );
+
+            const size_t expected = max_comp_idx( s.osample, s.osample_size );
+            const size_t float_idx = max_comp_idx( float_output.data(), s.osample_size );
+            const size_t int8_idx = max_comp_idx( int8_output.data(), s.osample_size );
+
+            float_success += ( float_idx == expected );
+            int8_success += ( int8_idx == expected );
+            agreement += ( float_idx == int8_idx );
+
+            for ( size_t i=0; i<s.osample_size; i++ )
+                max_output_delta = std::max( max_output_delta, std::fabs( float_output[i] - int8_output[i] ) );
+        }
+
+        const float size = static_cast<float>( std::max( validation_smp.samples_size(), size_t(1) ) );
+        const float float_accuracy = 100.f * float_success / size;
+        const float int8_accuracy = 100.f * int8_success / size;
+
+        std::cout << "validation on " << validation_smp.samples_size() << " samples :" << std::endl;
+        std::cout << "float accuracy : " << float_accuracy << "%" << std::endl;
+        std::cout << "int8 accuracy : " << int8_accuracy << "% (delta " << ( int8_accuracy - float_accuracy ) << "%)" << std::endl;
+        std::cout << "float/int8 top1 agreement : " << 100.f * agreement / size << "%, max output delta " << max_output_delta << std::endl;
+    }
+    catch( po::error& e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return -1;
+    }
+    catch( neurocl::network_exception& e )
+    {
+        std::cerr << "network exception : " << e.what() << std::endl;
+        return -1;
+    }
+    catch( std::exception& e )
+    {
+        std::cerr << "std::exception : " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
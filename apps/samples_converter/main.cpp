@@ -0,0 +1,102 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "neurocl.h"
+
+#include <boost/program_options.hpp>
+
+#include <iostream>
+
+using namespace neurocl;
+namespace po = boost::program_options;
+
+int main( int argc, char *argv[] )
+{
+    std::cout << "Welcome to samples_converter!" << std::endl;
+
+    std::string input;
+    std::string output;
+    std::string format;
+    bool uint8_inputs = false;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("input,i", po::value<std::string>( &input )->required(), "input samples file")
+        ("output,o", po::value<std::string>( &output )->required(), "output binary samples file")
+        ("format,f", po::value<std::string>( &format )->default_value( "samples" ), "input samples format : samples (images list) / kaggle (digit recognizer csv)")
+        ("uint8,u", po::value<bool>( &uint8_inputs )->default_value( false ), "store inputs as 8 bits values")
+    ;
+
+    po::variables_map vm;
+    po::store( po::parse_command_line( argc, argv, desc ), vm );
+
+    if ( vm.count( "help" ) )
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    logger_manager& lm = logger_manager::instance();
+    lm.add_logger( policy_type::cout, "samples_converter" );
+
+    try
+    {
+        po::notify( vm );
+
+        samples_manager smp_manager;
+
+        if ( format == "kaggle" )
+            smp_manager.load_kaggle_digit_recognizer( input );
+        else if ( format == "samples" )
+            smp_manager.load_samples( input );
+        else
+        {
+            std::cerr << "unmanaged input samples format : " << format << std::endl;
+            return -1;
+        }
+
+        smp_manager.save_binary_samples( output, uint8_inputs );
+
+        std::cout << "converted " << smp_manager.samples_size() << " samples to " << output << std::endl;
+    }
+    catch( po::error& e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return -1;
+    }
+    catch( neurocl::network_exception& e )
+    {
+        std::cerr << "network exception : " << e.what() << std::endl;
+        return -1;
+    }
+    catch( std::exception& e )
+    {
+        std::cerr << "std::exception : " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -60,7 +60,7 @@ public:
     {
 		logger_manager& lm = logger_manager::instance();
 		lm.add_logger( policy_type::cout, "pyneurocl" );
-		lm.add_logger( policy_type::file, "pyneurocl.log" );
+		lm.add_logger( policy_type::file, "pyneurocl.log", true /*asynchronous*/ );
 
         if ( !verbose )
             std::cout.rdbuf(NULL);
@@ -82,6 +82,9 @@ public:
 
         m_progress = 0;
 
+        if ( m_batch_trainer )
+            m_batch_trainer->wait();
+
         m_smp_manager.load_samples( samples );
         m_net_manager->batch_train( m_smp_manager, epochs, batch, std::bind( &py_neurocl_helper::_progress, this, std::placeholders::_1 ) );
     }
@@ -93,36 +96,80 @@ public:
         return m_progress;
     }
 
+    // single sample inference : all input values form the sample, outputs are written to the out array
     void compute( const boost::python::numeric::array& in, boost::python::numeric::array& out )
     {
-        using namespace boost::python;
+        _compute( in, out, false );
+    }
 
-		const tuple& shape_in = extract<tuple>( in.attr("shape") );
-		const tuple& shape_out = extract<tuple>( out.attr("shape") );
+    // batched inference : the first dimension of both arrays is the batch size
+    void compute_batch( const boost::python::numeric::array& in, boost::python::numeric::array& out )
+    {
+        _compute( in, out, true );
+    }
 
-        int wi = extract<int>( shape_in[1] ); // cols
-        int hi = extract<int>( shape_in[0] ); // rows
+    /********** STREAMING TRAINING ***************/
+
+    // queue a numpy mini-batch (inputs & targets share their first dimension) for asynchronous training,
+    // arrays are copied and can be refilled as soon as the call returns
+    void train_batch( const boost::python::numeric::array& inputs, const boost::python::numeric::array& targets )
+    {
+        _train_batch( inputs, targets );
+    }
+
+    // train (inputs, targets) mini-batches of an iterable : next batch is produced while the current one is trained
+    int train_generator( const boost::python::object& batches )
+    {
+        using namespace boost::python;
 
-        int wo = extract<int>( shape_out[1] );
-        int ho = extract<int>( shape_out[0] );
+        int count = 0;
+        for ( stl_input_iterator<object> iter( batches ), end; iter != end; ++iter )
+        {
+            const object batch = *iter;
+            _train_batch( batch[0], batch[1] );
+            ++count;
+        }
 
-		std::cout << wi << " " << hi << " " << wo << " " << ho << std::endl;
+        train_wait();
 
-        boost::shared_array<float> _in( new float[wi*hi] );
-        boost::shared_array<float> _out( new float[wo*ho] );
+        return count;
+    }
 
-		_array_converter<unsigned char,float>( in, _in.get() );
+    // wait for queued mini-batches to be trained
+    void train_wait()
+    {
+        if ( !m_batch_trainer )
+            return;
 
-        sample _sample( wi * hi, _in.get() , wo * ho, _out.get() );
+        releaseGIL unlock;
 
-        m_net_manager->compute_output( _sample );
+        m_batch_trainer->wait();
+    }
 
-        for ( auto i=0; i<wo*ho; i++ )
-            out[i] = _out[i];
+    // non-blocking streaming training statistics : trained batches & samples, queued batches, last batch loss
+    boost::python::dict train_stats()
+    {
+        async_batch_trainer::stats stats{ 0, 0, 0, 0.f };
+        if ( m_batch_trainer )
+            stats = m_batch_trainer->get_stats();
+
+        boost::python::dict d;
+        d["batches"] = stats.batches;
+        d["samples"] = stats.samples;
+        d["pending"] = stats.pending;
+        d["loss"] = stats.loss;
+        return d;
     }
 
     void uninit()
     {
+        if ( m_batch_trainer )
+        {
+            // queued batches are trained before saving
+            releaseGIL unlock;
+            m_batch_trainer.reset();
+        }
+
         m_net_manager->save_network();
         m_net_manager.reset();
     }
@@ -157,6 +204,85 @@ private:
         m_progress = p;
     }
 
+    void _compute( const boost::python::numeric::array& in, boost::python::numeric::array& out, const bool batched )
+    {
+        using namespace boost::python;
+
+        // C-contiguous float32 input is used in place, other inputs (e.g. uint8 images) are converted
+        PyArrayObject* np_in = reinterpret_cast<PyArrayObject*>( PyArray_FROM_OTF( in.ptr(), NPY_FLOAT32, NPY_ARRAY_IN_ARRAY ) );
+        if ( !np_in )
+            throw_error_already_set();
+        handle<> np_in_ref( reinterpret_cast<PyObject*>( np_in ) );
+
+        if ( !PyArray_Check( out.ptr() ) )
+            throw network_exception( "output must be a numpy array" );
+
+        // outputs are written directly to the caller array
+        PyArrayObject* np_out = reinterpret_cast<PyArrayObject*>( out.ptr() );
+        if ( ( PyArray_TYPE( np_out ) != NPY_FLOAT32 ) || !PyArray_ISCARRAY( np_out ) )
+            throw network_exception( "output array must be a writeable C-contiguous float32 array" );
+
+        size_t batch_size = 1;
+        if ( batched )
+        {
+            if ( !PyArray_NDIM( np_in ) || !PyArray_NDIM( np_out ) || ( PyArray_DIM( np_in, 0 ) != PyArray_DIM( np_out, 0 ) ) )
+                throw network_exception( "input & output arrays must have the same first (batch) dimension" );
+
+            batch_size = PyArray_DIM( np_in, 0 );
+            if ( !batch_size )
+                return;
+        }
+
+        const size_t isample_size = PyArray_SIZE( np_in ) / batch_size;
+        const size_t osample_size = PyArray_SIZE( np_out ) / batch_size;
+        const float* _in = static_cast<const float*>( PyArray_DATA( np_in ) );
+        float* _out = static_cast<float*>( PyArray_DATA( np_out ) );
+
+        // arrays stay referenced while the Global Interpreter Lock is released
+        releaseGIL unlock;
+
+        // queued mini-batches are trained first
+        if ( m_batch_trainer )
+            m_batch_trainer->wait();
+
+        m_net_manager->compute_output( batch_size, isample_size, _in, osample_size, _out );
+    }
+
+    void _train_batch( const boost::python::object& inputs, const boost::python::object& targets )
+    {
+        using namespace boost::python;
+
+        PyArrayObject* np_in = reinterpret_cast<PyArrayObject*>( PyArray_FROM_OTF( inputs.ptr(), NPY_FLOAT32, NPY_ARRAY_IN_ARRAY ) );
+        if ( !np_in )
+            throw_error_already_set();
+        handle<> np_in_ref( reinterpret_cast<PyObject*>( np_in ) );
+
+        PyArrayObject* np_out = reinterpret_cast<PyArrayObject*>( PyArray_FROM_OTF( targets.ptr(), NPY_FLOAT32, NPY_ARRAY_IN_ARRAY ) );
+        if ( !np_out )
+            throw_error_already_set();
+        handle<> np_out_ref( reinterpret_cast<PyObject*>( np_out ) );
+
+        if ( !PyArray_NDIM( np_in ) || !PyArray_NDIM( np_out ) || ( PyArray_DIM( np_in, 0 ) != PyArray_DIM( np_out, 0 ) ) )
+            throw network_exception( "inputs & targets arrays must have the same first (batch) dimension" );
+
+        const size_t batch_size = PyArray_DIM( np_in, 0 );
+        if ( !batch_size )
+            return;
+
+        if ( !m_batch_trainer )
+            m_batch_trainer = std::make_shared<async_batch_trainer>( m_net_manager );
+
+        const size_t isample_size = PyArray_SIZE( np_in ) / batch_size;
+        const size_t osample_size = PyArray_SIZE( np_out ) / batch_size;
+        const float* _in = static_cast<const float*>( PyArray_DATA( np_in ) );
+        const float* _out = static_cast<const float*>( PyArray_DATA( np_out ) );
+
+        // waits for a free slot while the Global Interpreter Lock is released
+        releaseGIL unlock;
+
+        m_batch_trainer->push( batch_size, isample_size, _in, osample_size, _out );
+    }
+
 	template <typename Ti,typename To>
 	void _array_converter( const boost::python::numeric::array& in, To* out )
     {
@@ -184,6 +310,7 @@ private:
 
     samples_manager m_smp_manager;
 	std::shared_ptr<network_manager_interface> m_net_manager;
+	std::shared_ptr<async_batch_trainer> m_batch_trainer;
 };
 
 BOOST_PYTHON_MODULE(pyneurocl)
@@ -192,6 +319,10 @@ BOOST_PYTHON_MODULE(pyneurocl)
 
 	boost::python::numeric::array::set_module_and_type("numpy", "ndarray");
 
+	// numpy C API (arrays conversion & checks)
+	if ( _import_array() < 0 )
+		throw_error_already_set();
+
 	register_exception_translator<network_exception>( translateException );
 
 	class_<py_neurocl_helper>("helper",init<bool>())
@@ -199,7 +330,12 @@ BOOST_PYTHON_MODULE(pyneurocl)
 		.def("uninit",&py_neurocl_helper::uninit)
 		.def("train",&py_neurocl_helper::train)
 		.def("compute",&py_neurocl_helper::compute)
+		.def("compute_batch",&py_neurocl_helper::compute_batch)
 		.def("train_progress",&py_neurocl_helper::train_progress)
+		.def("train_batch",&py_neurocl_helper::train_batch)
+		.def("train_generator",&py_neurocl_helper::train_generator)
+		.def("train_wait",&py_neurocl_helper::train_wait)
+		.def("train_stats",&py_neurocl_helper::train_stats)
         .def("digit_recognizer",&py_neurocl_helper::digit_recognizer)
 	;
 }
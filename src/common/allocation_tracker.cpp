@@ -0,0 +1,204 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "allocation_tracker.h"
+#include "logger.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+namespace neurocl {
+
+std::atomic<bool> allocation_tracker::s_enabled( false );
+
+namespace {
+
+// allocations made by the tracker itself are not tracked
+thread_local int t_untracked = 0;
+thread_local const allocation_scope* t_scope = nullptr;
+
+std::atomic<std::uint64_t> s_process_allocations( 0 );
+
+} // anonymous namespace
+
+allocation_tracker& allocation_tracker::instance()
+{
+    static allocation_tracker s;
+    return s;
+}
+
+std::uint64_t allocation_tracker::process_allocations()
+{
+    return s_process_allocations.load( std::memory_order_relaxed );
+}
+
+void allocation_tracker::set_enabled( const bool enabled )
+{
+#ifndef ALLOCATION_TRACKING_ENABLED
+    if ( enabled )
+    {
+        LOGGER(warning) << "allocation_tracker::set_enabled - allocations tracking is not built in (ALLOCATION_TRACKING_ENABLED is not defined)" << std::endl;
+    }
+#endif
+    s_enabled.store( enabled, std::memory_order_relaxed );
+}
+
+void allocation_tracker::reset()
+{
+    allocation_untracked_scope _untracked;
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    m_stats.clear();
+    m_violations = 0;
+}
+
+void allocation_tracker::add_allocation( const size_t bytes )
+{
+    allocation_untracked_scope _untracked;
+
+    const allocation_scope* scope = t_scope;
+    const bool steady_state = scope && m_steady_state.load( std::memory_order_relaxed );
+
+    if ( steady_state )
+        m_violations.fetch_add( 1, std::memory_order_relaxed );
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    allocation_stats& stats = scope ? m_stats[std::make_pair( scope->name(), std::string( scope->phase() ) )]
+        : m_stats[std::make_pair( std::string( "(untracked)" ), std::string() )];
+
+    ++stats.allocations;
+    stats.bytes += bytes;
+    if ( steady_state )
+        ++stats.steady_state_allocations;
+}
+
+const std::string allocation_tracker::report() const
+{
+    allocation_untracked_scope _untracked;
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    std::stringstream ss;
+
+    ss << "allocations report";
+#ifndef ALLOCATION_TRACKING_ENABLED
+    ss << " (tracking is not built in, define ALLOCATION_TRACKING_ENABLED)";
+#endif
+    ss << std::endl << std::endl;
+
+    ss << std::left << std::setw( 32 ) << "section" << std::setw( 20 ) << "phase" << std::right
+        << std::setw( 14 ) << "allocations" << std::setw( 16 ) << "bytes" << std::setw( 14 ) << "steady state" << std::endl;
+
+    for ( const auto& _stats : m_stats )
+    {
+        ss << std::left << std::setw( 32 ) << _stats.first.first << std::setw( 20 ) << _stats.first.second << std::right
+            << std::setw( 14 ) << _stats.second.allocations
+            << std::setw( 16 ) << _stats.second.bytes
+            << std::setw( 14 ) << _stats.second.steady_state_allocations << std::endl;
+    }
+
+    if ( m_steady_state_check )
+        ss << std::endl << "steady state violations: " << m_violations.load() << std::endl;
+
+    return ss.str();
+}
+
+allocation_untracked_scope::allocation_untracked_scope() : m_released( false )
+{
+    ++t_untracked;
+}
+
+void allocation_untracked_scope::release()
+{
+    if ( !m_released )
+    {
+        --t_untracked;
+        m_released = true;
+    }
+}
+
+allocation_scope::allocation_scope( std::string&& name, const char* phase, allocation_untracked_scope& untracked )
+    : m_name( std::move( name ) ), m_phase( phase ), m_enabled( allocation_tracker::enabled() ), m_parent( t_scope )
+{
+    if ( m_enabled )
+        t_scope = this;
+
+    untracked.release();
+}
+
+allocation_scope::~allocation_scope()
+{
+    if ( m_enabled )
+        t_scope = m_parent;
+}
+
+} //namespace neurocl
+
+#ifdef ALLOCATION_TRACKING_ENABLED
+
+// NOTE : replaced operators are global to the process whatever the library symbols visibility, client application
+// allocations are hooked too (reported outside sections), applications needing their own allocations count read
+// allocation_tracker::process_allocations instead of replacing operator new again
+void* operator new( std::size_t size )
+{
+    neurocl::s_process_allocations.fetch_add( 1, std::memory_order_relaxed );
+
+    if ( neurocl::allocation_tracker::enabled() && !neurocl::t_untracked )
+        neurocl::allocation_tracker::instance().add_allocation( size );
+
+    if ( void* ptr = std::malloc( size ? size : 1 ) )
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[]( std::size_t size )
+{
+    return operator new( size );
+}
+
+void operator delete( void* ptr ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete[]( void* ptr ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete( void* ptr, std::size_t ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete[]( void* ptr, std::size_t ) noexcept
+{
+    std::free( ptr );
+}
+
+#endif
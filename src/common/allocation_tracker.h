@@ -0,0 +1,139 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include "export.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace neurocl {
+
+//! heap allocations counters per tracked section (layer) and phase, hooked on a global operator new replacement
+//! NOTE : the hook and section macros below are compiled out unless ALLOCATION_TRACKING_ENABLED is defined
+//! NOTE : the replacement is process wide, allocations made outside library sections (client application,
+//! python bindings...) are reported as "(untracked)", and client applications must not replace operator new
+class NEUROCL_PUBLIC allocation_tracker
+{
+public:
+
+    static allocation_tracker& instance();
+
+    //! runtime tracking flag
+    static bool enabled() { return s_enabled.load( std::memory_order_relaxed ); }
+    void set_enabled( const bool enabled );
+    //! clear all results
+    void reset();
+
+    //! flag allocations made in tracked sections once training reached its steady state
+    void set_steady_state_check( const bool check ) { m_steady_state_check = check; }
+    bool steady_state_check() const { return m_steady_state_check; }
+    //! steady state is entered after the first training mini-batch
+    void set_steady_state( const bool steady ) { m_steady_state.store( steady, std::memory_order_relaxed ); }
+
+    //! process wide heap allocations count since program start, whether tracking is enabled or not
+    //! (always 0 unless ALLOCATION_TRACKING_ENABLED is defined)
+    static std::uint64_t process_allocations();
+
+    //! allocations made in tracked sections during steady state
+    std::uint64_t violations() const { return m_violations.load( std::memory_order_relaxed ); }
+
+    //! record an allocation in the current thread section
+    void add_allocation( const size_t bytes );
+
+    //! results as a text table
+    const std::string report() const;
+
+private:
+
+    allocation_tracker() : m_steady_state_check( false ), m_steady_state( false ), m_violations( 0 ) {}
+    virtual ~allocation_tracker() {}
+
+private:
+
+    struct allocation_stats
+    {
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+        std::uint64_t steady_state_allocations;
+    };
+
+    static std::atomic<bool> s_enabled;
+
+    bool m_steady_state_check;
+    std::atomic<bool> m_steady_state;
+    std::atomic<std::uint64_t> m_violations;
+
+    mutable std::mutex m_mutex;
+    std::map<std::pair<std::string,std::string>,allocation_stats> m_stats;
+};
+
+//! excludes current thread allocations from tracking while in scope
+class NEUROCL_PUBLIC allocation_untracked_scope
+{
+public:
+    allocation_untracked_scope();
+    ~allocation_untracked_scope() { release(); }
+
+    void release();
+
+private:
+    bool m_released;
+};
+
+//! scoped tracked section phase, restoring the enclosing one at exit
+class NEUROCL_PUBLIC allocation_scope
+{
+public:
+    //! name is built under the untracked scope, which is released once the section is entered
+    allocation_scope( std::string&& name, const char* phase, allocation_untracked_scope& untracked );
+    ~allocation_scope();
+
+    const std::string& name() const { return m_name; }
+    const char* phase() const { return m_phase; }
+
+private:
+    const std::string m_name;
+    const char* m_phase;
+    const bool m_enabled;
+    const allocation_scope* m_parent;
+};
+
+} //namespace neurocl
+
+#ifdef ALLOCATION_TRACKING_ENABLED
+// section name building is not accounted to the enclosing section
+#define ALLOCATION_SCOPE(name,phase) \
+    neurocl::allocation_untracked_scope _allocation_untracked_scope; \
+    neurocl::allocation_scope _allocation_scope( neurocl::allocation_tracker::enabled() ? std::string( name ) : std::string(), phase, _allocation_untracked_scope )
+#else
+#define ALLOCATION_SCOPE(name,phase)
+#endif
+
+#endif //ALLOCATION_TRACKER_H
@@ -0,0 +1,177 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "async_batch_trainer.h"
+#include "logger.h"
+
+#include "interfaces/network_manager_interface.h"
+
+#include <algorithm>
+
+namespace neurocl {
+
+async_batch_trainer::async_batch_trainer( const std::shared_ptr<network_manager_interface>& net_manager, const size_t queue_size )
+    : m_net_manager( net_manager ), m_slots( std::max( queue_size, size_t( 1 ) ) ), m_head( 0 ), m_count( 0 ),
+      m_stop( false ), m_stats{ 0, 0, 0, 0.f }
+{
+    m_trainer = std::thread( &async_batch_trainer::_train, this );
+}
+
+async_batch_trainer::~async_batch_trainer()
+{
+    {
+        std::unique_lock<std::mutex> lock( m_mutex ); // scoped lock
+        m_stop = true;
+    }
+    m_cond.notify_all();
+
+    // trainer thread drains queued batches before leaving
+    m_trainer.join();
+
+    if ( m_error )
+    {
+        LOGGER(error) << "async_batch_trainer::~async_batch_trainer - training error not reported" << std::endl;
+    }
+}
+
+void async_batch_trainer::push( const size_t batch_size,
+                                const size_t isample_size, const float* inputs,
+                                const size_t osample_size, const float* outputs )
+{
+    if ( !batch_size )
+        return;
+
+    // a producer owns the next free slot until it is queued (e.g. Python threads releasing the GIL)
+    std::unique_lock<std::mutex> push_lock( m_push_mutex ); // scoped lock
+
+    slot* _slot = nullptr;
+
+    {
+        std::unique_lock<std::mutex> lock( m_mutex ); // scoped lock
+
+        m_cond.wait( lock, [this]() { return ( m_count < m_slots.size() ) || m_error; } );
+
+        _rethrow();
+
+        _slot = &m_slots[( m_head + m_count ) % m_slots.size()];
+    }
+
+    // only the trainer thread reads queued slots : free slot is filled without the queue lock,
+    // and slot buffers keep their capacity (no allocation in steady state)
+    _slot->batch_size = batch_size;
+    _slot->isample_size = isample_size;
+    _slot->osample_size = osample_size;
+    _slot->inputs.assign( inputs, inputs + batch_size * isample_size );
+    _slot->outputs.assign( outputs, outputs + batch_size * osample_size );
+
+    {
+        std::unique_lock<std::mutex> lock( m_mutex ); // scoped lock
+        ++m_count;
+        m_stats.pending = m_count;
+    }
+    m_cond.notify_all();
+}
+
+void async_batch_trainer::wait()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    m_cond.wait( lock, [this]() { return !m_count || m_error; } );
+
+    _rethrow();
+}
+
+async_batch_trainer::stats async_batch_trainer::get_stats() const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_stats;
+}
+
+void async_batch_trainer::_rethrow()
+{
+    if ( m_error )
+    {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception( error );
+    }
+}
+
+void async_batch_trainer::_train()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    while ( true )
+    {
+        m_cond.wait( lock, [this]() { return m_count || m_stop; } );
+
+        if ( !m_count )
+            break; // stopped and drained
+
+        slot& _slot = m_slots[m_head];
+
+        bool trained = false;
+        float loss = 0.f;
+        std::exception_ptr error;
+
+        // queued batches are dropped until a training error is reported to the producer
+        if ( !m_error )
+        {
+            lock.unlock();
+
+            try
+            {
+                loss = m_net_manager->train_batch( _slot.batch_size,
+                    _slot.isample_size, _slot.inputs.data(),
+                    _slot.osample_size, _slot.outputs.data() );
+                trained = true;
+            }
+            catch(...)
+            {
+                LOGGER(error) << "async_batch_trainer::_train - error training mini-batch" << std::endl;
+                error = std::current_exception();
+            }
+
+            lock.lock();
+        }
+
+        m_head = ( m_head + 1 ) % m_slots.size();
+        --m_count;
+
+        if ( trained )
+        {
+            ++m_stats.batches;
+            m_stats.samples += _slot.batch_size;
+            m_stats.loss = loss;
+        }
+        else if ( error )
+            m_error = error;
+
+        m_stats.pending = m_count;
+
+        m_cond.notify_all();
+    }
+}
+
+} //namespace neurocl
@@ -0,0 +1,111 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef ASYNC_BATCH_TRAINER_H
+#define ASYNC_BATCH_TRAINER_H
+
+#include "export.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace neurocl {
+
+class network_manager_interface;
+
+/**
+ *  Asynchronous mini-batches trainer, for externally produced batches (e.g. Python pipelines) :
+ *  batches are copied into a ring of preallocated slots and trained by a background thread,
+ *  so that the producer prepares the next batch while the current one is trained.
+ *  Pushing blocks only while all slots are queued.
+ */
+class NEUROCL_PUBLIC async_batch_trainer
+{
+public:
+
+    struct stats
+    {
+        std::uint64_t batches;  // trained batches
+        std::uint64_t samples;  // trained samples
+        size_t pending;         // queued batches, including the one being trained
+        float loss;             // last trained batch loss
+    };
+
+public:
+
+    async_batch_trainer( const std::shared_ptr<network_manager_interface>& net_manager, const size_t queue_size = 2 );
+    //! queued batches are trained before returning
+    virtual ~async_batch_trainer();
+
+    //! queue a mini-batch of contiguously stored samples (concurrent producers are serialized), rethrows training errors
+    void push(  const size_t batch_size,
+                const size_t isample_size, const float* inputs,
+                const size_t osample_size, const float* outputs );
+
+    //! wait for queued batches to be trained, rethrows training errors
+    void wait();
+
+    //! non-blocking training statistics
+    stats get_stats() const;
+
+private:
+
+    struct slot
+    {
+        size_t batch_size = 0;
+        size_t isample_size = 0;
+        size_t osample_size = 0;
+        std::vector<float> inputs;
+        std::vector<float> outputs;
+    };
+
+    void _train();
+    void _rethrow();
+
+private:
+
+    std::shared_ptr<network_manager_interface> m_net_manager;
+
+    std::vector<slot> m_slots;
+    size_t m_head; // next slot to train
+    size_t m_count; // queued slots
+
+    std::thread m_trainer;
+    std::mutex m_push_mutex; // one producer at a time fills the next free slot
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+
+    bool m_stop;
+    stats m_stats;
+    std::exception_ptr m_error;
+};
+
+} //namespace neurocl
+
+#endif //ASYNC_BATCH_TRAINER_H
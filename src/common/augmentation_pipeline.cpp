@@ -0,0 +1,272 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "augmentation_pipeline.h"
+#include "network_config.h"
+#include "network_random.h"
+#include "network_exception.h"
+
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace neurocl {
+
+// per thread scratch buffers, reused from one sample to the other
+struct augmentation_scratch
+{
+    std::vector<float> source;
+    std::vector<float> dx;
+    std::vector<float> dy;
+    std::vector<float> tmp;
+    std::vector<float> kernel;
+    std::vector<float> noise;
+};
+
+static augmentation_scratch& _scratch()
+{
+    static thread_local augmentation_scratch s;
+    return s;
+}
+
+// uniform values in [-1,1)
+static inline void _uniform_symmetric( random::philox_generator& rng, float* out, const size_t size )
+{
+    rng.uniform( out, size );
+    for ( size_t i=0; i<size; i++ )
+        out[i] = 2.f * out[i] - 1.f;
+}
+
+// bilinear sampling, out of image pixels being null
+static inline float _bilinear( const float* src, const int w, const int h, const float x, const float y )
+{
+    const int x0 = static_cast<int>( std::floor( x ) );
+    const int y0 = static_cast<int>( std::floor( y ) );
+    const float fx = x - x0;
+    const float fy = y - y0;
+
+    auto _at = [src,w,h]( const int xi, const int yi )
+    {
+        return ( ( xi < 0 ) || ( yi < 0 ) || ( xi >= w ) || ( yi >= h ) ) ? 0.f : src[yi*w+xi];
+    };
+
+    return ( 1.f - fy ) * ( ( 1.f - fx ) * _at( x0, y0 ) + fx * _at( x0 + 1, y0 ) )
+        + fy * ( ( 1.f - fx ) * _at( x0, y0 + 1 ) + fx * _at( x0 + 1, y0 + 1 ) );
+}
+
+// separable gaussian blur with clamped borders
+static void _gaussian_blur( std::vector<float>& field, const int w, const int h, const float sigma, augmentation_scratch& s )
+{
+    const int radius = std::max( 1, static_cast<int>( std::ceil( 3.f * sigma ) ) );
+
+    s.kernel.resize( 2 * radius + 1 );
+    for ( int k=-radius; k<=radius; k++ )
+        s.kernel[k+radius] = std::exp( -0.5f * k * k / ( sigma * sigma ) );
+    const float norm = std::accumulate( s.kernel.begin(), s.kernel.end(), 0.f );
+    for ( auto& k : s.kernel )
+        k /= norm;
+
+    s.tmp.resize( field.size() );
+
+    for ( int y=0; y<h; y++ )
+        for ( int x=0; x<w; x++ )
+        {
+            float acc = 0.f;
+            for ( int k=-radius; k<=radius; k++ )
+                acc += s.kernel[k+radius] * field[y*w + std::min( std::max( x + k, 0 ), w - 1 )];
+            s.tmp[y*w+x] = acc;
+        }
+
+    for ( int y=0; y<h; y++ )
+        for ( int x=0; x<w; x++ )
+        {
+            float acc = 0.f;
+            for ( int k=-radius; k<=radius; k++ )
+                acc += s.kernel[k+radius] * s.tmp[std::min( std::max( y + k, 0 ), h - 1 )*w + x];
+            field[y*w+x] = acc;
+        }
+}
+
+augmentation_pipeline::augmentation_pipeline( const size_t sizeX, const size_t sizeY, const std::uint32_t seed )
+    : m_sizeX( sizeX ), m_sizeY( sizeY ), m_seed( seed ), m_max_angle( 0.f ), m_max_shift( 0.f ), m_max_zoom( 0.f ),
+    m_noise_sigma( 0.f ), m_elastic_alpha( 0.f ), m_elastic_sigma( 0.f )
+{
+    if ( !m_sizeX || !m_sizeY )
+        throw network_exception( "invalid augmentation sample size" );
+}
+
+augmentation_pipeline& augmentation_pipeline::rotate( const float max_angle )
+{
+    m_max_angle = max_angle;
+    return *this;
+}
+
+augmentation_pipeline& augmentation_pipeline::translate( const float max_shift )
+{
+    m_max_shift = max_shift;
+    return *this;
+}
+
+augmentation_pipeline& augmentation_pipeline::zoom( const float max_ratio )
+{
+    if ( ( max_ratio < 0.f ) || ( max_ratio >= 1.f ) )
+        throw network_exception( "invalid augmentation zoom ratio" );
+
+    m_max_zoom = max_ratio;
+    return *this;
+}
+
+augmentation_pipeline& augmentation_pipeline::noise( const float sigma )
+{
+    m_noise_sigma = sigma;
+    return *this;
+}
+
+augmentation_pipeline& augmentation_pipeline::elastic( const float alpha, const float sigma )
+{
+    if ( ( alpha > 0.f ) && ( sigma <= 0.f ) )
+        throw network_exception( "invalid augmentation elastic sigma" );
+
+    m_elastic_alpha = alpha;
+    m_elastic_sigma = sigma;
+    return *this;
+}
+
+bool augmentation_pipeline::_geometric() const
+{
+    return ( m_max_angle != 0.f ) || ( m_max_shift != 0.f ) || ( m_max_zoom != 0.f ) || ( m_elastic_alpha != 0.f );
+}
+
+void augmentation_pipeline::apply( float* input, const std::uint64_t stream ) const
+{
+    // dedicated deterministic random stream for this sample, with no per sample seeding cost
+    random::philox_generator rng( m_seed, stream );
+
+    const int w = static_cast<int>( m_sizeX );
+    const int h = static_cast<int>( m_sizeY );
+    const size_t size = m_sizeX * m_sizeY;
+
+    if ( _geometric() )
+    {
+        augmentation_scratch& s = _scratch();
+        s.source.assign( input, input + size );
+
+        float affine[4];
+        _uniform_symmetric( rng, affine, 4 );
+
+        // compose rotation, zoom & translation in a single inverse affine mapping
+        const float angle = m_max_angle * affine[0] * boost::math::constants::pi<float>() / 180.f;
+        const float scale = 1.f + m_max_zoom * affine[1];
+        const float tx = m_max_shift * affine[2];
+        const float ty = m_max_shift * affine[3];
+
+        const float a = std::cos( angle ) / scale;
+        const float b = std::sin( angle ) / scale;
+        const float cx = 0.5f * ( w - 1 );
+        const float cy = 0.5f * ( h - 1 );
+
+        const bool elastic = ( m_elastic_alpha != 0.f );
+        if ( elastic )
+        {
+            s.dx.resize( size );
+            s.dy.resize( size );
+            _uniform_symmetric( rng, s.dx.data(), size );
+            _uniform_symmetric( rng, s.dy.data(), size );
+            _gaussian_blur( s.dx, w, h, m_elastic_sigma, s );
+            _gaussian_blur( s.dy, w, h, m_elastic_sigma, s );
+        }
+
+        for ( int y=0; y<h; y++ )
+        {
+            const float v = y - cy - ty;
+
+            for ( int x=0; x<w; x++ )
+            {
+                const float u = x - cx - tx;
+
+                float sx = a * u + b * v + cx;
+                float sy = -b * u + a * v + cy;
+
+                if ( elastic )
+                {
+                    sx += m_elastic_alpha * s.dx[y*w+x];
+                    sy += m_elastic_alpha * s.dy[y*w+x];
+                }
+
+                input[y*w+x] = _bilinear( s.source.data(), w, h, sx, sy );
+            }
+        }
+    }
+
+    if ( m_noise_sigma != 0.f )
+    {
+        augmentation_scratch& s = _scratch();
+        s.noise.resize( size );
+        rng.gaussian( s.noise.data(), size, 0.f, m_noise_sigma );
+        for ( size_t i=0; i<size; i++ )
+            input[i] += s.noise[i];
+    }
+}
+
+void augmentation_pipeline::apply_batch( float* inputs, const size_t count, const size_t isample_size, const std::uint64_t first_stream ) const
+{
+    // samples are packed with their input size, which has to be the augmented 2D size
+    if ( isample_size != ( m_sizeX * m_sizeY ) )
+        throw network_exception( "augmented sample size does not match input sample size" );
+
+    for ( size_t i=0; i<count; i++ )
+        apply( inputs + i * isample_size, first_stream + i );
+}
+
+std::shared_ptr<augmentation_pipeline> augmentation_pipeline::from_config( const size_t sizeX, const size_t sizeY )
+{
+    const network_config& nc = network_config::instance();
+
+    const auto rotate = nc.get_param<float>( "augmentation.<xmlattr>.rotate" );
+    const auto translate = nc.get_param<float>( "augmentation.<xmlattr>.translate" );
+    const auto zoom = nc.get_param<float>( "augmentation.<xmlattr>.zoom" );
+    const auto noise = nc.get_param<float>( "augmentation.<xmlattr>.noise" );
+    const auto elastic_alpha = nc.get_param<float>( "augmentation.<xmlattr>.elastic_alpha" );
+    const auto elastic_sigma = nc.get_param<float>( "augmentation.<xmlattr>.elastic_sigma" );
+
+    if ( !rotate && !translate && !zoom && !noise && !elastic_alpha )
+        return std::shared_ptr<augmentation_pipeline>();
+
+    auto pipeline = std::make_shared<augmentation_pipeline>( sizeX, sizeY, neurocl::random::seed::instance()() );
+
+    pipeline->rotate( rotate.get_value_or( 0.f ) )
+        .translate( translate.get_value_or( 0.f ) )
+        .zoom( zoom.get_value_or( 0.f ) )
+        .noise( noise.get_value_or( 0.f ) )
+        .elastic( elastic_alpha.get_value_or( 0.f ), elastic_sigma.get_value_or( 4.f ) );
+
+    LOGGER(info) << "augmentation_pipeline::from_config - training samples augmentation enabled" << std::endl;
+
+    return pipeline;
+}
+
+} //namespace neurocl
@@ -0,0 +1,92 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef AUGMENTATION_PIPELINE_H
+#define AUGMENTATION_PIPELINE_H
+
+#include "export.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace neurocl {
+
+/**
+ *  Composable random data augmentation, applied in place on (batch) input buffers.
+ *
+ *  Geometric transforms (rotate, translate, zoom, elastic) are composed into a single
+ *  (scalar) bilinear resampling pass, then gaussian noise is added. Each sample is augmented with
+ *  its own RNG stream, derived from the pipeline seed and a caller-provided stream index,
+ *  so that results do not depend on the thread the augmentation is running on.
+ *
+ *  Scratch buffers are thread local : apply() is reentrant and can run on all cores.
+ */
+class NEUROCL_PUBLIC augmentation_pipeline
+{
+public:
+
+    augmentation_pipeline( const size_t sizeX, const size_t sizeY, const std::uint32_t seed );
+    virtual ~augmentation_pipeline() {}
+
+    //! random rotation in [-max_angle;max_angle] degrees
+    augmentation_pipeline& rotate( const float max_angle );
+    //! random translation in [-max_shift;max_shift] pixels
+    augmentation_pipeline& translate( const float max_shift );
+    //! random zoom factor in [1-max_ratio;1+max_ratio]
+    augmentation_pipeline& zoom( const float max_ratio );
+    //! additive gaussian noise
+    augmentation_pipeline& noise( const float sigma );
+    //! elastic distortion (cf. Simard et al. 2003), alpha being the displacement scale and sigma the field smoothness
+    augmentation_pipeline& elastic( const float alpha, const float sigma );
+
+    //! augment a single sample input in place
+    void apply( float* input, const std::uint64_t stream ) const;
+
+    //! augment count contiguous samples inputs of isample_size values in place, sample i using stream first_stream + i
+    void apply_batch( float* inputs, const size_t count, const size_t isample_size, const std::uint64_t first_stream ) const;
+
+    //! build pipeline from the optional augmentation configuration tag, nullptr if not configured
+    static std::shared_ptr<augmentation_pipeline> from_config( const size_t sizeX, const size_t sizeY );
+
+private:
+
+    bool _geometric() const;
+
+private:
+
+    const size_t m_sizeX;
+    const size_t m_sizeY;
+    const std::uint32_t m_seed;
+
+    float m_max_angle;
+    float m_max_shift;
+    float m_max_zoom;
+    float m_noise_sigma;
+    float m_elastic_alpha;
+    float m_elastic_sigma;
+};
+
+} //namespace neurocl
+
+#endif //AUGMENTATION_PIPELINE_H
@@ -0,0 +1,249 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "backend_selector.h"
+#include "network_config.h"
+#include "network_exception.h"
+#include "network_random.h"
+#include "logger.h"
+
+#include "interfaces/network_interface.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <utility>
+
+namespace bfs = boost::filesystem;
+
+namespace neurocl {
+
+static const std::string s_backend_cache_file = "neurocl_backend.cache";
+
+static const size_t s_bench_batch_size = 16;
+static const size_t s_bench_min_batches = 2;
+static const size_t s_bench_max_batches = 20;
+static const std::chrono::milliseconds s_bench_min_duration( 200 );
+
+namespace sc = std::chrono;
+
+static void _train_batches( network_interface& net,
+                            const size_t& batches,
+                            const std::vector<float>& input,
+                            const std::vector<float>& output )
+{
+    for ( size_t b=0; b<batches; b++ )
+    {
+        net.clear_gradients();
+
+        for ( size_t i=0; i<s_bench_batch_size; i++ )
+        {
+            net.set_input( input.size(), input.data() );
+            net.set_output( output.size(), output.data() );
+            net.feed_forward();
+            net.back_propagate();
+        }
+
+        net.gradient_descent();
+    }
+}
+
+backend_selector::backend_selector( const std::string& family, const std::string& topology_path )
+    : m_cache_path( network_config::resource_path( s_backend_cache_file ) )
+{
+    // decision is only valid for a given topology file state on a given hardware
+    const bfs::path _topology_path = bfs::absolute( topology_path );
+
+    m_cache_key = family + "|" + _topology_path.string() + "|"
+        + std::to_string( bfs::exists( _topology_path ) ? bfs::last_write_time( _topology_path ) : 0 ) + "|"
+        + std::to_string( std::thread::hardware_concurrency() );
+}
+
+const std::string backend_selector::select( const std::vector<candidate>& candidates )
+{
+    if ( candidates.empty() )
+        throw network_exception( "no candidate backend to select from" );
+
+    std::string best_name;
+
+    if ( _read_cache( best_name ) )
+    {
+        for ( const auto& _candidate : candidates )
+        {
+            if ( _candidate.name == best_name )
+            {
+                LOGGER(info) << "backend_selector::select - using cached backend " << best_name << std::endl;
+                return best_name;
+            }
+        }
+
+        LOGGER(warning) << "backend_selector::select - cached backend " << best_name << " is not available anymore" << std::endl;
+    }
+
+    float best_throughput = 0.f;
+    best_name = candidates.front().name;
+
+    // benchmark networks draw seeds (weights init, dropout keys, synthetic samples) : the selected network
+    // is built at the same seeds sequence offset whether the decision was cached or not
+    random::seed& seed = random::seed::instance();
+    const unsigned int seed_offset = seed.offset();
+
+    for ( const auto& _candidate : candidates )
+    {
+        try
+        {
+            const float throughput = _candidate.bench_fct();
+
+            LOGGER(info) << "backend_selector::select - backend " << _candidate.name << " throughput is " << throughput << " samples/sec" << std::endl;
+
+            if ( throughput > best_throughput )
+            {
+                best_throughput = throughput;
+                best_name = _candidate.name;
+            }
+        }
+        catch( const network_exception& e )
+        {
+            LOGGER(warning) << "backend_selector::select - discarding backend " << _candidate.name << " (" << e.what() << ")" << std::endl;
+        }
+    }
+
+    seed.set_offset( seed_offset );
+
+    LOGGER(info) << "backend_selector::select - selected backend " << best_name << std::endl;
+
+    _write_cache( best_name );
+
+    return best_name;
+}
+
+float backend_selector::measure_training(   network_interface& net,
+                                            const size_t& input_size,
+                                            const size_t& output_size )
+{
+    std::vector<float> input( input_size );
+    std::vector<float> output( output_size, 0.f );
+
+    random::rand_gaussian_generator rgg( 0.f, 1.f );
+    std::generate( input.begin(), input.end(), std::ref( rgg ) );
+    output[0] = 1.f;
+
+    net.set_training( true );
+
+    // warmup batch is also used to calibrate the number of measured batches
+    sc::steady_clock::time_point start = sc::steady_clock::now();
+    _train_batches( net, 1, input, output );
+    const auto warmup = sc::steady_clock::now() - start;
+
+    const size_t batches = std::max( s_bench_min_batches, std::min( s_bench_max_batches,
+        static_cast<size_t>( s_bench_min_duration / std::max( warmup, sc::steady_clock::duration( 1 ) ) ) ) );
+
+    start = sc::steady_clock::now();
+    _train_batches( net, batches, input, output );
+    const float elapsed = sc::duration_cast<sc::duration<float>>( sc::steady_clock::now() - start ).count();
+
+    net.set_training( false );
+
+    return static_cast<float>( batches * s_bench_batch_size ) / std::max( elapsed, 1e-6f );
+}
+
+bool backend_selector::_read_cache( std::string& name )
+{
+    std::ifstream cache( m_cache_path );
+    if ( !cache || !cache.is_open() )
+        return false;
+
+    std::string key;
+    std::string value;
+    while ( std::getline( cache, key, '\t' ) && std::getline( cache, value ) )
+    {
+        if ( key == m_cache_key )
+        {
+            name = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// cache key is "family|topology path|topology write time|hardware concurrency"
+static bool _stale_cache_key( const std::string& key, const std::string& topology_prefix )
+{
+    const size_t path_begin = key.find( '|' );
+    const size_t hw_sep = key.rfind( '|' );
+    const size_t time_sep = ( hw_sep == std::string::npos || hw_sep == 0 ) ? std::string::npos : key.rfind( '|', hw_sep - 1 );
+
+    if ( ( path_begin == std::string::npos ) || ( time_sep == std::string::npos ) || ( time_sep <= path_begin ) )
+        return true;
+
+    // previous decisions for the same topology, or for a topology that does not exist anymore
+    return ( key.compare( 0, topology_prefix.size(), topology_prefix ) == 0 )
+        || !bfs::exists( key.substr( path_begin + 1, time_sep - path_begin - 1 ) );
+}
+
+void backend_selector::_write_cache( const std::string& name )
+{
+    const size_t time_sep = m_cache_key.rfind( '|', m_cache_key.rfind( '|' ) - 1 );
+    const std::string topology_prefix = m_cache_key.substr( 0, time_sep + 1 );
+
+    // cache file is rewritten without stale entries, so that it does not grow with each selection
+    std::vector<std::pair<std::string,std::string>> entries;
+    {
+        std::ifstream cache( m_cache_path );
+        std::string key;
+        std::string value;
+        while ( cache && std::getline( cache, key, '\t' ) && std::getline( cache, value ) )
+        {
+            if ( !_stale_cache_key( key, topology_prefix ) )
+                entries.emplace_back( key, value );
+        }
+    }
+    entries.emplace_back( m_cache_key, name );
+
+    const std::string tmp_path = m_cache_path + ".tmp";
+    {
+        std::ofstream cache( tmp_path, std::ios::out | std::ios::trunc );
+        if ( !cache || !cache.is_open() )
+        {
+            LOGGER(warning) << "backend_selector::_write_cache - cannot write backend cache file " << m_cache_path << std::endl;
+            return;
+        }
+
+        for ( const auto& entry : entries )
+            cache << entry.first << '\t' << entry.second << std::endl;
+    }
+
+    boost::system::error_code ec;
+    bfs::rename( tmp_path, m_cache_path, ec );
+    if ( ec )
+    {
+        LOGGER(warning) << "backend_selector::_write_cache - cannot replace backend cache file " << m_cache_path << " (" << ec.message() << ")" << std::endl;
+    }
+}
+
+} /*namespace neurocl*/
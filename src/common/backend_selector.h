@@ -0,0 +1,77 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef BACKEND_SELECTOR_H
+#define BACKEND_SELECTOR_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace neurocl {
+
+class network_interface;
+
+// runtime backend selection : candidate backends are microbenchmarked on the loaded
+// topology and the fastest one is kept, decision is cached on disk
+class backend_selector
+{
+public:
+
+    //! candidate benchmark function, returns throughput in samples/sec
+    using t_bench_fct = std::function<float(void)>;
+
+    struct candidate
+    {
+        std::string name;
+        t_bench_fct bench_fct;
+    };
+
+public:
+
+    backend_selector( const std::string& family, const std::string& topology_path );
+    virtual ~backend_selector() {}
+
+    //! select best candidate name (cached decision is used when available)
+    const std::string select( const std::vector<candidate>& candidates );
+
+    //! measure synthetic training throughput
+    static float measure_training(  network_interface& net,
+                                    const size_t& input_size,
+                                    const size_t& output_size );
+
+private:
+
+    bool _read_cache( std::string& name );
+    void _write_cache( const std::string& name );
+
+private:
+
+    std::string m_cache_key;
+    std::string m_cache_path;
+};
+
+} /*namespace neurocl*/
+
+#endif //BACKEND_SELECTOR_H
@@ -0,0 +1,236 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "batch_prefetcher.h"
+#include "samples_manager.h"
+#include "augmentation_pipeline.h"
+#include "network_exception.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace neurocl {
+
+batch_prefetcher::batch_prefetcher( const samples_manager& smp_manager,
+                                    const size_t batch_size,
+                                    const size_t buffers_count,
+                                    const size_t threads_count,
+                                    const std::shared_ptr<augmentation_pipeline>& augmentation,
+                                    const std::uint64_t first_stream )
+    : m_smp_manager( smp_manager ), m_batch_size( batch_size ), m_augmentation( augmentation ), m_first_stream( first_stream ),
+    m_slots( std::max<size_t>( buffers_count, 1 ) ),
+    m_fetch_sequence( 0 ), m_consume_sequence( 0 ), m_consumed( nullptr ), m_exhausted( false ), m_stop( false )
+{
+    if ( !m_batch_size )
+        throw network_exception( "invalid null mini-batch size" );
+
+    for ( size_t i=0; i<std::max<size_t>( threads_count, 1 ); i++ )
+        m_producers.emplace_back( &batch_prefetcher::_produce, this );
+}
+
+batch_prefetcher::~batch_prefetcher()
+{
+    _stop();
+}
+
+const prefetched_batch* batch_prefetcher::next_batch()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    // recycle previously consumed buffer
+    if ( m_consumed )
+    {
+        m_consumed->state = t_slot_state::FREE;
+        m_consumed = nullptr;
+        m_cond.notify_all();
+    }
+
+    slot* _slot = nullptr;
+
+    auto _ready = [this,&_slot]()
+    {
+        for ( auto& s : m_slots )
+            if ( ( s.state == t_slot_state::READY ) && ( s.sequence == m_consume_sequence ) )
+            {
+                _slot = &s;
+                return true;
+            }
+        return false;
+    };
+    auto _done = [this]()
+    {
+        return m_error || ( m_exhausted && ( m_consume_sequence == m_fetch_sequence ) );
+    };
+
+    if ( !_ready() && !_done() )
+    {
+        namespace sc = std::chrono;
+        const sc::steady_clock::time_point start = sc::steady_clock::now();
+
+        m_cond.wait( lock, [&]{ return _ready() || _done(); } );
+
+        m_stats.starved++;
+        m_stats.starved_ms += sc::duration_cast<sc::duration<double,std::milli>>( sc::steady_clock::now() - start ).count();
+    }
+
+    if ( m_error )
+        std::rethrow_exception( m_error );
+
+    if ( !_slot )
+        return nullptr;
+
+    m_consume_sequence++;
+    m_consumed = _slot;
+    m_stats.batches++;
+
+    return &_slot->batch;
+}
+
+void batch_prefetcher::_produce()
+{
+    while ( true )
+    {
+        slot* _slot = nullptr;
+
+        // scoped lock
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+
+            auto _free = [this,&_slot]()
+            {
+                for ( auto& s : m_slots )
+                    if ( s.state == t_slot_state::FREE )
+                    {
+                        _slot = &s;
+                        return true;
+                    }
+                return false;
+            };
+
+            if ( !m_stop && !m_exhausted && !_free() )
+            {
+                m_stats.stalls++;
+                m_cond.wait( lock, [&]{ return m_stop || m_exhausted || _free(); } );
+            }
+
+            if ( m_stop || m_exhausted )
+                return;
+
+            _slot->state = t_slot_state::FILLING;
+        }
+
+        bool fetched = false;
+
+        try
+        {
+            fetched = _fetch( *_slot );
+
+            // augmentation is reentrant, and runs outside of the fetch lock
+            if ( fetched && m_augmentation )
+                m_augmentation->apply_batch( _slot->batch.inputs.data(), _slot->batch.size, _slot->batch.isample_size,
+                    m_first_stream + _slot->sequence * m_batch_size );
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_error = std::current_exception();
+            m_exhausted = true;
+        }
+
+        // scoped lock
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            _slot->state = ( fetched && !m_error ) ? t_slot_state::READY : t_slot_state::FREE;
+        }
+        m_cond.notify_all();
+
+        if ( !fetched )
+            return;
+    }
+}
+
+bool batch_prefetcher::_fetch( slot& _slot )
+{
+    std::lock_guard<std::mutex> fetch_lock( m_fetch_mutex );
+
+    // scoped lock
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if ( m_stop || m_exhausted )
+            return false;
+    }
+
+    const samples_view samples = m_smp_manager.get_next_batch_view( m_batch_size );
+
+    if ( samples.empty() )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_exhausted = true;
+        return false;
+    }
+
+    // pack samples contiguously, buffers capacity is kept from one batch to the other
+    prefetched_batch& batch = _slot.batch;
+    batch.size = samples.size();
+    batch.isample_size = samples.front().isample_size;
+    batch.osample_size = samples.front().osample_size;
+    batch.inputs.resize( batch.size * batch.isample_size );
+    batch.outputs.resize( batch.size * batch.osample_size );
+
+    float* _input = batch.inputs.data();
+    float* _output = batch.outputs.data();
+
+    for( const auto& s : samples )
+    {
+        if ( ( s.isample_size != batch.isample_size ) || ( s.osample_size != batch.osample_size ) )
+            throw network_exception( "inconsistent sample sizes in batch" );
+
+        _input = std::copy( s.isample, s.isample + batch.isample_size, _input );
+        _output = std::copy( s.osample, s.osample + batch.osample_size, _output );
+    }
+
+    // scoped lock
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        _slot.sequence = m_fetch_sequence++;
+    }
+
+    return true;
+}
+
+void batch_prefetcher::_stop()
+{
+    // scoped lock
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stop = true;
+    }
+    m_cond.notify_all();
+
+    for ( auto& producer : m_producers )
+        if ( producer.joinable() )
+            producer.join();
+}
+
+} //namespace neurocl
@@ -0,0 +1,133 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef BATCH_PREFETCHER_H
+#define BATCH_PREFETCHER_H
+
+#include "export.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace neurocl {
+
+class samples_manager;
+class augmentation_pipeline;
+
+// contiguous mini-batch buffer, prepared by the prefetcher
+struct prefetched_batch
+{
+    size_t size = 0;
+    size_t isample_size = 0;
+    size_t osample_size = 0;
+    std::vector<float> inputs;
+    std::vector<float> outputs;
+};
+
+/**
+ *  Background mini-batch pipeline : producer threads fetch, pack (and optionally augment)
+ *  the upcoming mini-batches of one epoch into a bounded ring of preallocated buffers,
+ *  while the current batch is being trained. Batches are delivered in fetch order.
+ *
+ *  Augmentation runs concurrently in the producers, the k-th fetched sample using
+ *  augmentation stream first_stream + k (cf. augmentation_pipeline.h).
+ *
+ *  buffers_count = 2 gives double buffering, 3 triple buffering etc...
+ */
+class NEUROCL_PUBLIC batch_prefetcher
+{
+public:
+
+    struct stats
+    {
+        size_t batches = 0;         // delivered batches
+        size_t starved = 0;         // consumer had to wait for a batch
+        double starved_ms = 0.;     // total consumer waiting time
+        size_t stalls = 0;          // producer had to wait for a free buffer
+    };
+
+public:
+
+    batch_prefetcher(   const samples_manager& smp_manager,
+                        const size_t batch_size,
+                        const size_t buffers_count,
+                        const size_t threads_count,
+                        const std::shared_ptr<augmentation_pipeline>& augmentation = std::shared_ptr<augmentation_pipeline>(),
+                        const std::uint64_t first_stream = 0 );
+    virtual ~batch_prefetcher();
+
+    //! get next prepared batch (nullptr at end of epoch), previous batch buffer is recycled
+    const prefetched_batch* next_batch();
+
+    //! get pipeline statistics
+    const stats& get_stats() const { return m_stats; }
+
+private:
+
+    enum class t_slot_state { FREE, FILLING, READY };
+
+    struct slot
+    {
+        t_slot_state state = t_slot_state::FREE;
+        size_t sequence = 0;
+        prefetched_batch batch;
+    };
+
+    void _produce();
+    bool _fetch( slot& _slot );
+    void _stop();
+
+private:
+
+    const samples_manager& m_smp_manager;
+    const size_t m_batch_size;
+    std::shared_ptr<augmentation_pipeline> m_augmentation;
+    const std::uint64_t m_first_stream;
+
+    std::vector<slot> m_slots;
+    std::vector<std::thread> m_producers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    // samples_manager cursor is not thread safe : fetches are serialized
+    std::mutex m_fetch_mutex;
+
+    size_t m_fetch_sequence;
+    size_t m_consume_sequence;
+    slot* m_consumed;
+    bool m_exhausted;
+    bool m_stop;
+    std::exception_ptr m_error;
+
+    stats m_stats;
+};
+
+} //namespace neurocl
+
+#endif //BATCH_PREFETCHER_H
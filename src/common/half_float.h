@@ -0,0 +1,165 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef HALF_FLOAT_H
+#define HALF_FLOAT_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__F16C__)
+    #include <immintrin.h>
+#endif
+
+namespace neurocl {
+
+// Reduced precision parameters storage formats
+enum class half_format : std::uint32_t
+{
+    FP32 = 0,   // plain float32 (no reduction)
+    FP16,       // IEEE 754 binary16
+    BF16        // bfloat16 (float32 upper half)
+};
+
+inline std::uint32_t _float_bits( const float value )
+{
+    std::uint32_t bits;
+    std::memcpy( &bits, &value, sizeof( float ) );
+    return bits;
+}
+
+inline float _bits_float( const std::uint32_t bits )
+{
+    float value;
+    std::memcpy( &value, &bits, sizeof( float ) );
+    return value;
+}
+
+//! float32 to binary16, rounded to nearest even (overflows to infinity)
+inline std::uint16_t float_to_half( const float value )
+{
+    const std::uint32_t bits = _float_bits( value );
+    const std::uint16_t sign = static_cast<std::uint16_t>( ( bits >> 16 ) & 0x8000 );
+    const std::uint32_t abs_bits = bits & 0x7FFFFFFF;
+
+    if ( abs_bits >= 0x7F800000 ) // inf or nan (quiet nan is kept)
+        return sign | 0x7C00 | ( ( abs_bits > 0x7F800000 ) ? 0x0200 : 0 );
+    if ( abs_bits >= 0x477FF000 ) // rounds above max half
+        return sign | 0x7C00;
+    if ( abs_bits < 0x38800000 ) // half subnormal (or zero)
+    {
+        // scaling by 2^-24 is exact, float rounding does the job
+        const float scaled = _bits_float( abs_bits ) * _bits_float( 0x4B800000 ); // x 2^24
+        return sign | static_cast<std::uint16_t>( std::lrint( scaled ) );
+    }
+
+    // normal : rebias exponent and round mantissa to nearest even
+    const std::uint32_t rounded = abs_bits + 0xFFF + ( ( abs_bits >> 13 ) & 1 );
+    return sign | static_cast<std::uint16_t>( ( rounded - 0x38000000 ) >> 13 );
+}
+
+//! binary16 to float32 (exact)
+inline float half_to_float( const std::uint16_t value )
+{
+    const std::uint32_t sign = static_cast<std::uint32_t>( value & 0x8000 ) << 16;
+    const std::uint32_t exponent = ( value >> 10 ) & 0x1F;
+    const std::uint32_t mantissa = value & 0x3FF;
+
+    if ( exponent == 0x1F ) // inf or nan
+        return _bits_float( sign | 0x7F800000 | ( mantissa << 13 ) );
+    if ( exponent == 0 ) // subnormal (or zero) : mantissa x 2^-24 is exact
+    {
+        const float magnitude = static_cast<float>( mantissa ) * _bits_float( 0x33800000 ); // x 2^-24
+        return _bits_float( sign | _float_bits( magnitude ) );
+    }
+
+    return _bits_float( sign | ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 ) );
+}
+
+//! float32 to bfloat16, rounded to nearest even
+inline std::uint16_t float_to_bfloat16( const float value )
+{
+    const std::uint32_t bits = _float_bits( value );
+
+    if ( ( bits & 0x7FFFFFFF ) > 0x7F800000 ) // nan is kept quiet
+        return static_cast<std::uint16_t>( ( bits >> 16 ) | 0x0040 );
+
+    return static_cast<std::uint16_t>( ( bits + 0x7FFF + ( ( bits >> 16 ) & 1 ) ) >> 16 );
+}
+
+//! bfloat16 to float32 (exact)
+inline float bfloat16_to_float( const std::uint16_t value )
+{
+    return _bits_float( static_cast<std::uint32_t>( value ) << 16 );
+}
+
+//! narrow a float32 array to the given reduced format
+inline void narrow_floats( const half_format format, const float* in, const size_t count, std::uint16_t* out )
+{
+    size_t i = 0;
+
+    if ( format == half_format::FP16 )
+    {
+#if defined(__F16C__)
+        for ( ; i + 8 <= count; i += 8 )
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( out + i ),
+                _mm256_cvtps_ph( _mm256_loadu_ps( in + i ), _MM_FROUND_TO_NEAREST_INT ) );
+#endif
+        for ( ; i < count; i++ )
+            out[i] = float_to_half( in[i] );
+    }
+    else
+    {
+        for ( ; i < count; i++ )
+            out[i] = float_to_bfloat16( in[i] );
+    }
+}
+
+//! widen a reduced format array to float32
+inline void widen_floats( const half_format format, const std::uint16_t* in, const size_t count, float* out )
+{
+    size_t i = 0;
+
+    if ( format == half_format::FP16 )
+    {
+#if defined(__F16C__)
+        for ( ; i + 8 <= count; i += 8 )
+            _mm256_storeu_ps( out + i,
+                _mm256_cvtph_ps( _mm_loadu_si128( reinterpret_cast<const __m128i*>( in + i ) ) ) );
+#endif
+        for ( ; i < count; i++ )
+            out[i] = half_to_float( in[i] );
+    }
+    else
+    {
+        for ( ; i < count; i++ )
+            out[i] = bfloat16_to_float( in[i] );
+    }
+}
+
+} //namespace neurocl
+
+#endif //HALF_FLOAT_H
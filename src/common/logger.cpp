@@ -24,9 +24,13 @@ THE SOFTWARE.
 
 #include "logger.h"
 
+#include <atomic>
+#include <chrono>
+#include <ctime>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <thread>
 
 namespace std
 {
@@ -90,7 +94,123 @@ private:
     std::unique_ptr<std::ofstream> m_out_stream;
 };
 
-logger::logger( const policy_type& type, const std::string& name ) : m_name( name )
+// Bounded multiple producers single consumer ring buffer of preformatted records, written to the policy
+// by a background thread : producers never lock nor wait, records are dropped (and counted) when it is full
+// (cells sequence numbers scheme of D. Vyukov's bounded queue)
+class async_log_writer
+{
+public:
+	async_log_writer( log_policy_interface* policy )
+		: m_policy( policy ), m_cells( s_capacity ), m_enqueue_pos( 0 ), m_dequeue_pos( 0 ), m_dropped( 0 ), m_stop( false )
+	{
+		for ( size_t i=0; i<s_capacity; i++ )
+			m_cells[i].sequence.store( i, std::memory_order_relaxed );
+
+		m_thread = std::thread( &async_log_writer::_run, this );
+	}
+	virtual ~async_log_writer()
+	{
+		// pending records are written before exiting
+		m_stop.store( true, std::memory_order_release );
+		m_thread.join();
+	}
+
+	void push( std::string&& record )
+	{
+		size_t pos = m_enqueue_pos.load( std::memory_order_relaxed );
+		cell* _cell;
+
+		while ( true )
+		{
+			_cell = &m_cells[pos & ( s_capacity - 1 )];
+			const size_t sequence = _cell->sequence.load( std::memory_order_acquire );
+			const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>( sequence ) - static_cast<std::ptrdiff_t>( pos );
+
+			if ( diff == 0 )
+			{
+				if ( m_enqueue_pos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+					break;
+			}
+			else if ( diff < 0 )
+			{
+				m_dropped.fetch_add( 1, std::memory_order_relaxed );
+				return;
+			}
+			else
+				pos = m_enqueue_pos.load( std::memory_order_relaxed );
+		}
+
+		_cell->record = std::move( record );
+		_cell->sequence.store( pos + 1, std::memory_order_release );
+	}
+
+private:
+
+	bool _pop( std::string& record )
+	{
+		cell& _cell = m_cells[m_dequeue_pos & ( s_capacity - 1 )];
+		if ( _cell.sequence.load( std::memory_order_acquire ) != ( m_dequeue_pos + 1 ) )
+			return false;
+
+		record = std::move( _cell.record );
+		_cell.sequence.store( m_dequeue_pos + s_capacity, std::memory_order_release );
+		++m_dequeue_pos;
+		return true;
+	}
+
+	void _run()
+	{
+		std::string record;
+
+		while ( true )
+		{
+			// stop flag is read before draining, so that records pushed before it was set are written
+			const bool stop = m_stop.load( std::memory_order_acquire );
+
+			bool written = false;
+			while ( _pop( record ) )
+			{
+				m_policy->write( record );
+				written = true;
+			}
+
+			const size_t dropped = m_dropped.exchange( 0, std::memory_order_relaxed );
+			if ( dropped )
+				m_policy->write( " | LOGGER: " + std::to_string( dropped ) + " records dropped (queue full)\n" );
+
+			if ( stop )
+				break;
+
+			if ( !written )
+				std::this_thread::sleep_for( s_idle_wait );
+		}
+	}
+
+private:
+
+	struct cell
+	{
+		std::atomic<size_t> sequence;
+		std::string record;
+	};
+
+	// power of two
+	static const size_t s_capacity = 4096;
+	static constexpr std::chrono::milliseconds s_idle_wait{ 2 };
+
+	log_policy_interface* m_policy;
+
+	std::vector<cell> m_cells;
+	std::atomic<size_t> m_enqueue_pos;
+	size_t m_dequeue_pos;
+	std::atomic<size_t> m_dropped;
+	std::atomic<bool> m_stop;
+	std::thread m_thread;
+};
+
+constexpr std::chrono::milliseconds async_log_writer::s_idle_wait;
+
+logger::logger( const policy_type& type, const std::string& name, const bool asynchronous ) : m_name( name )
 {
 	switch( type )
 	{
@@ -113,40 +233,37 @@ logger::logger( const policy_type& type, const std::string& name ) : m_name( nam
 	if( !m_policy )
 		throw std::runtime_error("LOGGER: Unable to create the logger instance");
 	m_policy->open_ostream( name );
+
+	if ( asynchronous )
+		m_async_writer.reset( new async_log_writer( m_policy.get() ) );
 }
 
 logger::logger( logger&& l )
+	: m_name( std::move( l.m_name ) ), m_policy( std::move( l.m_policy ) ), m_async_writer( std::move( l.m_async_writer ) )
 {
-#if defined __GNUC__ && !defined __clang__
-	#include <features.h>
-	#if __GNUC_PREREQ(5,0)
-		m_log_stream = std::move( l.m_log_stream );
-	#else
-		// ugly code section :-(
-		// related to GCC bug:
-		// http://stackoverflow.com/questions/27152263/move-or-swap-a-stringstream
-		m_log_stream.clear();
-		m_log_stream.str( l.m_log_stream.str() );
-		l.m_log_stream.clear();
-	#endif
-#else // clang or gcc 5.0+
-	m_log_stream = std::move( l.m_log_stream );
-#endif
-	m_policy = std::move( l.m_policy );
-	m_name = std::move( l.m_name );
 }
 
 logger::~logger()
 {
+	// flushes pending records
+	m_async_writer.reset();
+
 	if( m_policy )
 		m_policy->close_ostream();
 }
 
-void logger::_print_impl( const std::string& msg )
+void logger::_print_impl( const char* severity_tag, const std::string& msg )
 {
-	m_log_stream << msg;
-	m_policy->write( _get_logline_header() + m_log_stream.str() );
-	m_log_stream.str( "" );
+	// record is formatted by the calling thread, without locking
+	std::string record = _get_logline_header() + severity_tag + msg;
+
+	if ( m_async_writer )
+		m_async_writer->push( std::move( record ) );
+	else
+	{
+		std::lock_guard<std::mutex> lock( m_write_mutex );
+		m_policy->write( record );
+	}
 }
 
 std::string logger::_get_time()
@@ -154,8 +271,12 @@ std::string logger::_get_time()
 	auto now = std::chrono::system_clock::now();
     auto in_time_t = std::chrono::system_clock::to_time_t( now );
 
+    // localtime is not thread safe
+    std::tm _tm;
+    localtime_r( &in_time_t, &_tm );
+
     std::stringstream ss;
-    ss << std::put_time( std::localtime( &in_time_t ), "%X" );
+    ss << std::put_time( &_tm, "%X" );
     return ss.str();
 }
 
@@ -33,6 +33,12 @@ THE SOFTWARE.
 #include <sstream>
 #include <vector>
 
+//! compile-time minimum logged severity : 0 info (default), 1 warning, 2 error, 3 none
+//! (filtered out LOGGER statements are dead code)
+#ifndef NEUROCL_LOG_LEVEL
+#define NEUROCL_LOG_LEVEL 0
+#endif
+
 enum class severity_type
 {
 	info = 1,
@@ -40,6 +46,16 @@ enum class severity_type
 	warning
 };
 
+constexpr int severity_rank( const severity_type severity )
+{
+	return ( severity == severity_type::info ) ? 0 : ( ( severity == severity_type::warning ) ? 1 : 2 );
+}
+
+constexpr bool severity_enabled( const severity_type severity )
+{
+	return severity_rank( severity ) >= NEUROCL_LOG_LEVEL;
+}
+
 enum class policy_type
 {
 	cout = 1,
@@ -54,42 +70,42 @@ public:
 	virtual void write( const std::string& msg ) = 0;
 };
 
+class async_log_writer;
+
 class NEUROCL_PUBLIC logger
 {
 public:
-	logger( const policy_type& type, const std::string& name );
+	//! asynchronous loggers only queue preformatted records, written by a background thread
+	logger( const policy_type& type, const std::string& name, const bool asynchronous = false );
 	logger( logger&& l );
     virtual ~logger();
 
 	template<severity_type severity>
 	void print( const std::string& msg )
 	{
-		m_write_mutex.lock();
 		switch( severity )
 		{
 			case severity_type::info:
-				m_log_stream << "| I | ";
+				_print_impl( "| I | ", msg );
 				break;
 			case severity_type::warning:
-				m_log_stream << "| W | ";
+				_print_impl( "| W | ", msg );
 				break;
 			case severity_type::error:
-				m_log_stream << "| E | ";
+				_print_impl( "| E | ", msg );
 				break;
 		};
-		_print_impl( msg );
-		m_write_mutex.unlock();
 	}
 
 private:
     std::string _get_time();
 	std::string _get_logline_header();
-	void _print_impl( const std::string& msg );
+	void _print_impl( const char* severity_tag, const std::string& msg );
 
 private:
 	std::string m_name;
-    std::stringstream m_log_stream;
 	std::unique_ptr<log_policy_interface> m_policy;
+	std::unique_ptr<async_log_writer> m_async_writer;
 	std::mutex m_write_mutex;
 };
 
@@ -103,9 +119,9 @@ public:
         return s;
     }
 
-	void add_logger( const policy_type& type, const std::string& name )
+	void add_logger( const policy_type& type, const std::string& name, const bool asynchronous = false )
 	{
-		m_loggers.emplace_back( logger{ type, name } );
+		m_loggers.emplace_back( logger{ type, name, asynchronous } );
 	}
 
 	bool empty_logger()
@@ -129,12 +145,12 @@ private:
 	std::vector<logger> m_loggers;
 };
 
-//! log as stream
+//! log as stream (nothing is allocated if the logger has no sink registered)
 template<severity_type severity>
 class streamlogger
 {
 public:
-	streamlogger() : m_stream( new std::ostringstream ) {};
+	streamlogger() : m_stream( logger_manager::instance().empty_logger() ? 0 : new std::ostringstream ) {};
 	streamlogger(const streamlogger& copy) : m_stream( copy.m_stream ) { copy.m_stream = 0; };
 	~streamlogger()
 	{
@@ -148,13 +164,14 @@ public:
 	std::ostringstream* stream() const
 		{ return m_stream; };
 	operator bool() const
-		{ return logger_manager::instance().empty_logger(); }
+		{ return m_stream == 0; }
 
 private:
 	mutable std::ostringstream* m_stream;
 };
 
-//! helper to log a stream with level and to do nothing if the logger has no sink registered
-#define LOGGER(level) if( streamlogger<severity_type::level> keep=streamlogger<severity_type::level>() ) ; else (*keep.stream())
+//! helper to log a stream with level and to do nothing if the level is filtered out at compile time,
+//! or if the logger has no sink registered
+#define LOGGER(level) if( !severity_enabled( severity_type::level ) ) ; else if( streamlogger<severity_type::level> keep=streamlogger<severity_type::level>() ) ; else (*keep.stream())
 
 #endif //LOGGER_H
@@ -83,14 +83,20 @@ public:
         }
     }
 
+    //! get resource file path (relative to NEUROCL_RESOURCE_PATH if defined, current directory otherwise)
+    static std::string resource_path( const std::string& file )
+    {
+        char* var = nullptr;
+        const std::string env_neurocl_resource_path( ( var = getenv( "NEUROCL_RESOURCE_PATH" ) ) == nullptr ? "" : var );
+        return env_neurocl_resource_path.empty() ? file : ( env_neurocl_resource_path + "/" + file );
+    }
+
 private:
     network_config()
     {
         try
         {
-            char* var = nullptr;
-            const std::string env_neurocl_config_file( ( var = getenv( "NEUROCL_RESOURCE_PATH" ) ) == nullptr ? "" : var );
-            const auto _neurocl_config_file = env_neurocl_config_file.empty() ? s_neurocl_config_file : ( env_neurocl_config_file + "/" + s_neurocl_config_file );
+            const auto _neurocl_config_file = resource_path( s_neurocl_config_file );
 
             LOGGER(info) << "network_config::network_config - config lookup path is : " << _neurocl_config_file << std::endl;
 
@@ -47,16 +47,43 @@ inline std::istream& operator>> ( std::istream &input, network_factory::t_neural
     return input;
 }
 
+inline std::istream& operator>> ( std::istream &input, network_factory::t_neural_backend& backend )
+{
+    std::string backend_string;
+    input >> backend_string;
+
+    if ( backend_string == "DEFAULT" )
+        backend = network_factory::t_neural_backend::NEURAL_BACKEND_DEFAULT;
+    else if ( backend_string == "BNU_REF" )
+        backend = network_factory::t_neural_backend::NEURAL_BACKEND_BNU_REF;
+    else if ( backend_string == "BNU_FAST" )
+        backend = network_factory::t_neural_backend::NEURAL_BACKEND_BNU_FAST;
+    else if ( backend_string == "VEXCL" )
+        backend = network_factory::t_neural_backend::NEURAL_BACKEND_VEXCL;
+    else if ( backend_string == "PARALLEL" )
+        backend = network_factory::t_neural_backend::NEURAL_BACKEND_PARALLEL;
+    else if ( backend_string == "AUTO" )
+        backend = network_factory::t_neural_backend::NEURAL_BACKEND_AUTO;
+    else if ( backend_string == "INT8" )
+        backend = network_factory::t_neural_backend::NEURAL_BACKEND_INT8;
+    else
+        input.setstate( std::ios_base::failbit );
+
+    return input;
+}
+
 std::shared_ptr<network_manager_interface> network_factory::build()
 {
     std::string str_impl = "undefined";
+    std::string str_backend = "DEFAULT";
 
     try
     {
         const network_config& nc = network_config::instance();
         nc.update_mandatory( "implementation", str_impl );
+        nc.update_optional( "implementation.<xmlattr>.backend", str_backend );
 
-        return build( boost::lexical_cast<t_neural_impl>( str_impl ) );
+        return build( boost::lexical_cast<t_neural_impl>( str_impl ), boost::lexical_cast<t_neural_backend>( str_backend ) );
     }
     catch( const network_exception& e )
     {
@@ -64,20 +91,48 @@ std::shared_ptr<network_manager_interface> network_factory::build()
     }
     catch(...)
     {
-        throw network_exception( "unmanaged neural implementation in configuration file : " + str_impl );
+        throw network_exception( "unmanaged neural implementation in configuration file : " + str_impl + " (backend " + str_backend + ")" );
     }
 }
 
-std::shared_ptr<network_manager_interface> network_factory::build( const t_neural_impl& impl )
+std::shared_ptr<network_manager_interface> network_factory::build( const t_neural_impl& impl, const t_neural_backend& backend, const size_t parallel_tasks )
 {
+    using t_mlp_impl = mlp::network_manager_mlp::t_mlp_impl;
+    using t_convnet_impl = convnet::network_manager_convnet::t_convnet_impl;
+
     switch( impl )
     {
     case t_neural_impl::NEURAL_IMPL_MLP:
-        return mlp::network_manager_mlp::create(
-            mlp::network_manager_mlp::t_mlp_impl::MLP_IMPL_BNU_REF );
+        switch( backend )
+        {
+        case t_neural_backend::NEURAL_BACKEND_DEFAULT:
+        case t_neural_backend::NEURAL_BACKEND_BNU_REF:
+            return mlp::network_manager_mlp::create( t_mlp_impl::MLP_IMPL_BNU_REF );
+        case t_neural_backend::NEURAL_BACKEND_BNU_FAST:
+            return mlp::network_manager_mlp::create( t_mlp_impl::MLP_IMPL_BNU_FAST );
+        case t_neural_backend::NEURAL_BACKEND_VEXCL:
+            return mlp::network_manager_mlp::create( t_mlp_impl::MLP_IMPL_VEXCL );
+        case t_neural_backend::NEURAL_BACKEND_AUTO:
+            return mlp::network_manager_mlp::create( t_mlp_impl::MLP_IMPL_AUTO );
+        default:
+            throw network_exception( "unmanaged backend for mlp implementation!" );
+        }
     case t_neural_impl::NEURAL_IMPL_CONVNET:
-        return convnet::network_manager_convnet::create(
-            convnet::network_manager_convnet::t_convnet_impl::CONVNET );
+        switch( backend )
+        {
+        case t_neural_backend::NEURAL_BACKEND_DEFAULT:
+            return convnet::network_manager_convnet::create( t_convnet_impl::CONVNET );
+        case t_neural_backend::NEURAL_BACKEND_PARALLEL:
+            return convnet::network_manager_convnet::create( t_convnet_impl::CONVNET_PARALLEL, parallel_tasks );
+        case t_neural_backend::NEURAL_BACKEND_VEXCL:
+            return convnet::network_manager_convnet::create( t_convnet_impl::CONVNET_VEXCL );
+        case t_neural_backend::NEURAL_BACKEND_AUTO:
+            return convnet::network_manager_convnet::create( t_convnet_impl::CONVNET_AUTO, parallel_tasks );
+        case t_neural_backend::NEURAL_BACKEND_INT8:
+            return convnet::network_manager_convnet::create( t_convnet_impl::CONVNET_INT8 );
+        default:
+            throw network_exception( "unmanaged backend for convnet implementation!" );
+        }
     default:
         throw network_exception( "unmanaged neural implementation!" );
     }
@@ -44,10 +44,24 @@ public:
         NEURAL_IMPL_CONVNET,
     };
 
+    enum class t_neural_backend
+    {
+        NEURAL_BACKEND_DEFAULT = 0,
+        NEURAL_BACKEND_BNU_REF,
+        NEURAL_BACKEND_BNU_FAST,
+        NEURAL_BACKEND_VEXCL,
+        NEURAL_BACKEND_PARALLEL,
+        NEURAL_BACKEND_AUTO,
+        NEURAL_BACKEND_INT8,
+    };
+
 public:
 
     static std::shared_ptr<network_manager_interface> build();
-    static std::shared_ptr<network_manager_interface> build( const t_neural_impl& impl );
+    //! parallel_tasks : concurrent networks of the convnet PARALLEL backend (0 for hardware concurrency + 1)
+    static std::shared_ptr<network_manager_interface> build(    const t_neural_impl& impl,
+                                                                const t_neural_backend& backend = t_neural_backend::NEURAL_BACKEND_DEFAULT,
+                                                                const size_t parallel_tasks = 0 );
 };
 
 } //namespace neurocl
@@ -27,14 +27,24 @@ THE SOFTWARE.
 #include "interfaces/network_interface.h"
 #include "interfaces/network_file_handler_interface.h"
 
+#include "common/network_config.h"
 #include "common/network_exception.h"
 #include "common/samples_manager.h"
+#include "common/batch_prefetcher.h"
+#include "common/augmentation_pipeline.h"
+#include "common/training_checkpoint.h"
+#include "common/network_random.h"
 #include "common/logger.h"
+#include "common/profiler.h"
+#include "common/allocation_tracker.h"
+#include "common/thread_pool.h"
 
-#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <iostream>
-
-//#define TRAIN_CHRONO
+#include <limits>
+#include <thread>
 
 namespace neurocl {
 
@@ -53,6 +63,14 @@ private:
     std::shared_ptr<network_interface> m_net;
 };
 
+network_manager::network_manager() : m_network_loaded( false ), m_tta_rotation( 5 ), m_tta_aggregation( tta_aggregation::MAX )
+{
+}
+
+network_manager::~network_manager()
+{
+}
+
 void network_manager::_assert_loaded()
 {
     if ( !m_network_loaded )
@@ -71,6 +89,38 @@ void network_manager::load_network( const std::string& topology_path, const std:
 
     m_network_loaded = true;
 
+    // optional runtime profiling, also managed by set_profiling
+    bool profiling = profiler::enabled();
+    network_config::instance().update_optional( "profiling", profiling );
+    profiler::instance().set_enabled( profiling );
+
+    // optional runtime allocations tracking, also managed by set_allocation_tracking
+    bool allocation_tracking = allocation_tracker::enabled();
+    bool allocation_check = allocation_tracker::instance().steady_state_check();
+    network_config::instance().update_optional( "allocation_tracking", allocation_tracking );
+    network_config::instance().update_optional( "allocation_steady_state_check", allocation_check );
+    set_allocation_tracking( allocation_tracking, allocation_check );
+
+    // optional test time augmentation settings
+    std::string str_aggregation = "MAX";
+    network_config::instance().update_optional( "tta_rotation", m_tta_rotation );
+    network_config::instance().update_optional( "tta_aggregation", str_aggregation );
+
+    if ( m_tta_rotation < 0 )
+        throw network_exception( "invalid test time augmentation rotation range" );
+
+    if ( str_aggregation == "MAX" )
+        m_tta_aggregation = tta_aggregation::MAX;
+    else if ( str_aggregation == "MEAN" )
+        m_tta_aggregation = tta_aggregation::MEAN;
+    else if ( str_aggregation == "VOTE" )
+        m_tta_aggregation = tta_aggregation::VOTE;
+    else
+    {
+        LOGGER(error) << "network_manager::load_network - unmanaged test time augmentation aggregation \'" << str_aggregation << "\'" << std::endl;
+        throw network_exception( "unmanaged test time augmentation aggregation" );
+    }
+
     LOGGER(info) << "network_manager::load_network - network loaded" << std::endl;
 }
 
@@ -90,33 +140,161 @@ void network_manager::batch_train(	const samples_manager& smp_manager,
 
     scoped_training _scoped_training( m_net );
 
+    // periodic asynchronous checkpointing : 0 interval disables it, training resumes from an existing checkpoint
+    std::string checkpoint_path;
+    size_t checkpoint_interval = 0;
+    network_config::instance().update_optional( "checkpoint_path", checkpoint_path );
+    network_config::instance().update_optional( "checkpoint_interval", checkpoint_interval );
+
+    training_checkpoint checkpoint;
+    const bool resume = !checkpoint_path.empty() && checkpoint.read( checkpoint_path );
+
+    if ( resume && ( checkpoint.epoch > epoch_size ) )
+    {
+        LOGGER(error) << "network_manager::batch_train - checkpoint \'" << checkpoint_path << "\' is at epoch " << checkpoint.epoch
+            << ", beyond the " << epoch_size << " requested epochs" << std::endl;
+        throw network_exception( "checkpoint is beyond the requested epochs" );
+    }
+
+    // random seeds sequence is replayed from training start
+    random::seed& seed = random::seed::instance();
+    if ( resume )
+        seed.set_offset( checkpoint.start_seed );
+    const unsigned int start_seed = seed.offset();
+
+    // optional in place augmentation, configured with the augmentation tag : its key is drawn at training start,
+    // before the seeds sequence is moved to the checkpoint one
+    const std::shared_ptr<augmentation_pipeline> augmentation =
+        augmentation_pipeline::from_config( smp_manager.sample_sizeX(), smp_manager.sample_sizeY() );
+
+    const size_t first_epoch = resume ? _resume_training( checkpoint, smp_manager ) : 0;
+
+    if ( resume && ( first_epoch == epoch_size ) )
+    {
+        LOGGER(warning) << "network_manager::batch_train - checkpoint \'" << checkpoint_path
+            << "\' training is already complete, its final state is only saved" << std::endl;
+    }
+
+    std::unique_ptr<checkpoint_writer> checkpointer;
+    if ( !checkpoint_path.empty() && checkpoint_interval )
+    {
+        if ( m_net->training_state_size() )
+            checkpointer.reset( new checkpoint_writer( checkpoint_path ) );
+        else
+            LOGGER(warning) << "network_manager::batch_train - checkpointing is not managed by current network backend" << std::endl;
+    }
+
+    _train_epochs( smp_manager, augmentation, first_epoch, epoch_size, batch_size, progress_fct,
+        checkpointer.get(), checkpoint_interval, start_seed );
+
+    if ( checkpointer )
+    {
+        checkpointer->flush();
+
+        if ( checkpointer->superseded() )
+        {
+            LOGGER(warning) << "network_manager::batch_train - " << checkpointer->superseded()
+                << " checkpoints were superseded before being written (consider increasing checkpoint_interval)" << std::endl;
+        }
+    }
+
+    save_network();
+
+    // a completed training does not leave a checkpoint to be resumed by the next one
+    if ( checkpointer || resume )
+        training_checkpoint::remove( checkpoint_path );
+}
+
+void network_manager::_train_epochs(   const samples_manager& smp_manager,
+                                        const std::shared_ptr<augmentation_pipeline>& augmentation,
+                                        const size_t first_epoch,
+                                        const size_t epoch_size,
+                                        const size_t batch_size,
+                                        t_progress_fct progress_fct,
+                                        checkpoint_writer* checkpointer,
+                                        const size_t checkpoint_interval,
+                                        const unsigned int start_seed )
+{
     std::shared_ptr<samples_augmenter> smp_augmenter;// = smp_manager.get_augmenter();
 
-    size_t progress_size = 0;
+    // background batches preparation : 0 buffers disables prefetching, 2 means double buffering...
+    size_t prefetch_buffers = 2;
+    size_t prefetch_threads = 1;
+    network_config::instance().update_optional( "prefetch_buffers", prefetch_buffers );
+    network_config::instance().update_optional( "prefetch_threads", prefetch_threads );
+
+    size_t progress_size = first_epoch * smp_manager.samples_size();
     const size_t pbm_size = epoch_size * smp_manager.samples_size();
 
-    for ( size_t i=0; i<epoch_size; i++ )
+    // allocations in tracked sections are flagged once the first mini-batch is done
+    allocation_tracker& tracker = allocation_tracker::instance();
+    const bool steady_state_check = allocation_tracker::enabled() && tracker.steady_state_check();
+    const std::uint64_t violations = tracker.violations();
+
+    auto _progress = [&]( const size_t batch_samples )
     {
-        while ( true )
+        progress_size += batch_samples;
+
+        if ( steady_state_check )
+            tracker.set_steady_state( true );
+
+        int progress = ( ( 100 * progress_size ) / pbm_size );
+
+        if ( progress_fct )
+            progress_fct( progress );
+
+        std::cout << "\rnetwork_manager::batch_train - progress: " << progress << "% loss: " << m_net->loss();
+    };
+
+    for ( size_t i=first_epoch; i<epoch_size; i++ )
+    {
+        PROFILE_SAMPLES( "training", smp_manager.samples_size() );
+
+        if ( prefetch_buffers )
         {
-            std::vector<neurocl::sample> samples = smp_manager.get_next_batch( batch_size );
+            batch_prefetcher prefetcher( smp_manager, batch_size, prefetch_buffers, prefetch_threads,
+                augmentation, i * smp_manager.samples_size() );
+
+            while ( const prefetched_batch* batch = prefetcher.next_batch() )
+            {
+                PROFILE_SCOPE( "network_manager", "train_batch" );
+                ALLOCATION_SCOPE( "network_manager", "train_batch" );
 
-            // end of training set management
-            if ( samples.empty() )
-                break;
+                prepare_training_epoch();
+                m_net->batch_feed_back( batch->size,
+                    batch->isample_size, batch->inputs.data(),
+                    batch->osample_size, batch->outputs.data() );
+                finalize_training_epoch();
 
-            prepare_training_epoch();
-            _train_batch( samples, smp_augmenter );
-            finalize_training_epoch();
+                _progress( batch->size );
+            }
 
-            progress_size += samples.size();
+            const batch_prefetcher::stats& stats = prefetcher.get_stats();
 
-			int progress = ( ( 100 * progress_size ) / pbm_size );
+            std::cout << "\r";
 
-			if ( progress_fct )
-				progress_fct( progress );
+            LOGGER(info) << "network_manager::batch_train - prefetch: " << stats.batches << " batches, starved "
+                << stats.starved << " times (" << stats.starved_ms << "ms), producers stalled " << stats.stalls << " times" << std::endl;
+        }
+        else
+        {
+            std::uint64_t stream = i * smp_manager.samples_size();
+
+            while ( true )
+            {
+                const samples_view samples = smp_manager.get_next_batch_view( batch_size );
+
+                // end of training set management
+                if ( samples.empty() )
+                    break;
+
+                prepare_training_epoch();
+                _train_batch( samples, smp_augmenter, augmentation, stream );
+                finalize_training_epoch();
 
-            std::cout << "\rnetwork_manager::batch_train - progress: " << progress << "% loss: " << m_net->loss();
+                stream += samples.size();
+                _progress( samples.size() );
+            }
         }
 
         std::cout << "\r";
@@ -125,11 +303,104 @@ void network_manager::batch_train(	const samples_manager& smp_manager,
 
         smp_manager.rewind();
         smp_manager.shuffle();
+
+        // snapshot is only a memory copy, disk writing is done in the background
+        if ( checkpointer && ( ( ( (i+1) % checkpoint_interval ) == 0 ) || ( (i+1) == epoch_size ) ) )
+        {
+            checkpointer->checkpoint( [&]( training_checkpoint& _checkpoint ) {
+                _snapshot_training( _checkpoint, smp_manager, i+1, start_seed );
+            } );
+        }
     }
 
     std::cout << std::endl;
 
-    save_network();
+    if ( steady_state_check )
+    {
+        tracker.set_steady_state( false );
+
+        if ( tracker.violations() != violations )
+        {
+            LOGGER(warning) << "network_manager::batch_train - " << ( tracker.violations() - violations )
+                << " allocations in steady state training (see allocation_report)" << std::endl;
+        }
+    }
+}
+
+void network_manager::_snapshot_training(  training_checkpoint& checkpoint,
+                                            const samples_manager& smp_manager,
+                                            const size_t epoch,
+                                            const unsigned int start_seed )
+{
+    checkpoint.epoch = epoch;
+    checkpoint.start_seed = start_seed;
+    checkpoint.seed = random::seed::instance().offset();
+
+    checkpoint.state.resize( m_net->training_state_size() );
+    m_net->get_training_state( checkpoint.state.data() );
+
+    smp_manager.get_samples_order( checkpoint.samples_order );
+}
+
+size_t network_manager::_resume_training( const training_checkpoint& checkpoint, const samples_manager& smp_manager )
+{
+    if ( checkpoint.state.size() != m_net->training_state_size() )
+        throw network_exception( "checkpoint does not match network topology and solver" );
+
+    m_net->set_training_state( checkpoint.state.data() );
+
+    // samples order layout is owned by the samples manager, which rejects mismatching orders
+    bool order_restored = false;
+    if ( !checkpoint.samples_order.empty() )
+    {
+        try
+        {
+            smp_manager.set_samples_order( checkpoint.samples_order );
+            order_restored = true;
+        }
+        catch( network_exception& e )
+        {
+            LOGGER(warning) << "network_manager::_resume_training - " << e.what() << std::endl;
+        }
+    }
+
+    if ( !order_restored )
+        LOGGER(warning) << "network_manager::_resume_training - samples order could not be restored" << std::endl;
+
+    random::seed& seed = random::seed::instance();
+    seed.set_offset( checkpoint.seed );
+
+    if ( !seed.deterministic() )
+    {
+        LOGGER(warning) << "network_manager::_resume_training - no random_seed configured, resumed training will not replay random sets" << std::endl;
+    }
+
+    LOGGER(info) << "network_manager::_resume_training - resuming training after epoch " << checkpoint.epoch
+        << ", loaded weights are replaced by the checkpoint ones" << std::endl;
+
+    return checkpoint.epoch;
+}
+
+float network_manager::train_batch(   const size_t batch_size,
+                                    const size_t isample_size, const float* inputs,
+                                    const size_t osample_size, const float* outputs )
+{
+    _assert_loaded();
+
+    if ( !batch_size )
+        return 0.f;
+
+    scoped_training _scoped_training( m_net );
+
+    PROFILE_SAMPLES( "training", batch_size );
+    PROFILE_SCOPE( "network_manager", "train_batch" );
+    ALLOCATION_SCOPE( "network_manager", "train_batch" );
+
+    prepare_training_epoch();
+    m_net->batch_feed_back( batch_size, isample_size, inputs, osample_size, outputs );
+    finalize_training_epoch();
+
+    return m_net->loss();
 }
 
 void network_manager::prepare_training_epoch()
@@ -149,38 +420,69 @@ void network_manager::train( const sample& s, key_training )
     _train_single( s );
 }
 
-void network_manager::_train_batch( const std::vector<sample>& training_set, const std::shared_ptr<samples_augmenter>& smp_augmenter )
+void network_manager::_train_batch(    const samples_view& training_set,
+                                    const std::shared_ptr<samples_augmenter>& smp_augmenter,
+                                    const std::shared_ptr<augmentation_pipeline>& augmentation,
+                                    const std::uint64_t first_stream )
 {
     _assert_loaded();
 
-    size_t index = 0;
+    if ( training_set.empty() )
+        return;
 
-    for( const auto& s : training_set )
+    if ( !smp_augmenter )
     {
-        //LOGGER(info) << "network_manager::_train_batch - training sample " << (index+1) << "/" << training_set.size() << std::endl;
+        // pack samples contiguously so that batch capable backends can transfer them at once
+        _pack_batch( training_set, true );
 
-        if ( !smp_augmenter )
-        {
-			_train_single( s );
-        }
-        else
+        if ( augmentation )
+            augmentation->apply_batch( m_batch_input.data(), training_set.size(), training_set.front().isample_size, first_stream );
+
+        PROFILE_SCOPE( "network_manager", "train_batch" );
+        ALLOCATION_SCOPE( "network_manager", "train_batch" );
+
+        m_net->batch_feed_back( training_set.size(),
+            training_set.front().isample_size, m_batch_input.data(),
+            training_set.front().osample_size, m_batch_output.data() );
+    }
+    else
+    {
+        for( const auto& s : training_set )
         {
             //sample _s = smp_augmenter->translate( s, samples_augmenter::rand_shift(), samples_augmenter::rand_shift() );
             sample _s = smp_augmenter->rotate( s, samples_augmenter::rand_shift() );
             _train_single( _s );
         }
+    }
+}
+
+void network_manager::_pack_batch( const samples_view& samples, bool with_output )
+{
+    const size_t isample_size = samples.front().isample_size;
+    const size_t osample_size = samples.front().osample_size;
 
-    ++index;
+    m_batch_input.resize( samples.size() * isample_size );
+    if ( with_output )
+        m_batch_output.resize( samples.size() * osample_size );
+
+    float* _input = m_batch_input.data();
+    float* _output = m_batch_output.data();
+
+    for( const auto& s : samples )
+    {
+        if ( ( s.isample_size != isample_size ) || ( s.osample_size != osample_size ) )
+            throw network_exception( "inconsistent sample sizes in batch" );
+
+        _input = std::copy( s.isample, s.isample + isample_size, _input );
+        if ( with_output )
+            _output = std::copy( s.osample, s.osample + osample_size, _output );
     }
 }
 
 void network_manager::_train_single( const sample& s )
 {
-#ifdef TRAIN_CHRONO
-    namespace sc = std::chrono;
-    sc::system_clock::time_point start = sc::system_clock::now();
-    sc::milliseconds duration;
-#endif
+    PROFILE_SCOPE( "network_manager", "train_single" );
+    ALLOCATION_SCOPE( "network_manager", "train_single" );
 
     // set input/output
     m_net->set_input( s.isample_size, s.isample );
@@ -189,57 +491,115 @@ void network_manager::_train_single( const sample& s )
     // forward/backward propagation
     m_net->feed_forward();
     m_net->back_propagate();
-
-#ifdef TRAIN_CHRONO
-    duration = sc::duration_cast<sc::milliseconds>( sc::system_clock::now() - start );
-    LOGGER(info) << "network_manager::_train_single - training successfull in "  << duration.count() << "ms"<< std::endl;
-#endif
 }
 
 void network_manager::compute_augmented_output( sample& s, const std::shared_ptr<samples_augmenter>& smp_augmenter )
 {
-	// ONLY ROTATION AUGMENTATION IS IMPLEMENTED YET
+    _assert_loaded();
 
-    std::vector<int> rotations{ -5, -4, -3, -2, -1, 0, 1, 2, 3, 4, 5 };
+    // ONLY ROTATION AUGMENTATION IS IMPLEMENTED YET : one variant per degree in [-tta_rotation;tta_rotation]
 
-    std::vector<output_ptr> outputs;
+    const size_t variants = 2 * m_tta_rotation + 1;
+    const size_t isample_size = s.isample_size;
+    const size_t osample_size = s.osample_size;
 
-    for ( auto& rot : rotations )
+    PROFILE_SAMPLES( "inference", variants );
+
+    m_tta_input.resize( variants * isample_size );
+    m_tta_output.resize( variants * osample_size );
+
+    if ( !m_tta_pool )
+        m_tta_pool.reset( new thread_pool( std::max( 1u, std::thread::hardware_concurrency() ) ) );
+
+    // augmenter buffers are per thread : each job copies its variants to the batch before the next augmentation
+    const size_t jobs = std::min( m_tta_pool->size(), variants );
+    std::vector<std::exception_ptr> errors( jobs );
+
+    for ( size_t j=0; j<jobs; j++ )
     {
-        sample _s = smp_augmenter->rotate( s, rot );
-        m_net->set_input( _s.isample_size, _s.isample );
-        m_net->feed_forward();
-        outputs.emplace_back( m_net->output() );
-        //output_layer += m_net->output();
+        m_tta_pool->add_job( [this,&s,&smp_augmenter,&errors,j,jobs,variants,isample_size]()
+        {
+            try
+            {
+                for ( size_t v=j; v<variants; v+=jobs )
+                {
+                    const sample _s = smp_augmenter->rotate( s, static_cast<float>( static_cast<int>( v ) - m_tta_rotation ) );
+
+                    if ( _s.isample_size != isample_size )
+                        throw network_exception( "augmented sample size mismatch" );
+
+                    std::copy( _s.isample, _s.isample + isample_size, m_tta_input.data() + v * isample_size );
+                }
+            }
+            catch(...)
+            {
+                errors[j] = std::current_exception();
+            }
+        } );
     }
 
-    // TODO-CNN : not very proud of the efficiency of this code section...
-    // still it is temporary as computing a mean image alos makes sense!
+    m_tta_pool->wait_all();
 
-    int i = 0;
-    int l = 0;
-    float max = std::numeric_limits<float>::min();
-    for ( const auto& output : outputs )
-    {
-        float _tmp_max = output.max_comp_val();
+    for ( const auto& error : errors )
+        if ( error )
+            std::rethrow_exception( error );
 
-        LOGGER(info) << "network_manager::compute_augmented_output - " << _tmp_max << " " << output.max_comp_idx() << std::endl;
+    m_net->batch_feed_forward( variants, isample_size, m_tta_input.data(), osample_size, m_tta_output.data() );
 
-        if ( _tmp_max > max )
+    _aggregate_variants( variants, osample_size, const_cast<float*>( s.osample ) );
+}
+
+void network_manager::_aggregate_variants( const size_t variants, const size_t osample_size, float* output ) const
+{
+    const float* _outputs = m_tta_output.data();
+
+    switch( m_tta_aggregation )
+    {
+    case tta_aggregation::MAX:
+    {
+        size_t best = 0;
+        float max = std::numeric_limits<float>::lowest();
+        for ( size_t v=0; v<variants; v++ )
         {
-            l = i;
-            max = _tmp_max;
+            const float _max = *std::max_element( _outputs + v * osample_size, _outputs + ( v + 1 ) * osample_size );
+            if ( _max > max )
+            {
+                best = v;
+                max = _max;
+            }
         }
-        i++;
+        std::copy( _outputs + best * osample_size, _outputs + ( best + 1 ) * osample_size, output );
+        break;
+    }
+    case tta_aggregation::MEAN:
+    {
+        std::fill( output, output + osample_size, 0.f );
+        for ( size_t v=0; v<variants; v++ )
+            for ( size_t o=0; o<osample_size; o++ )
+                output[o] += _outputs[v * osample_size + o];
+        for ( size_t o=0; o<osample_size; o++ )
+            output[o] /= static_cast<float>( variants );
+        break;
+    }
+    case tta_aggregation::VOTE:
+    {
+        std::fill( output, output + osample_size, 0.f );
+        for ( size_t v=0; v<variants; v++ )
+        {
+            const float* _output = _outputs + v * osample_size;
+            output[ std::max_element( _output, _output + osample_size ) - _output ] += 1.f / static_cast<float>( variants );
+        }
+        break;
+    }
     }
-
-    std::copy( outputs[l].outputs.get(), outputs[l].outputs.get() + outputs[l].num_outputs, const_cast<float*>( s.osample ) );
 }
 
 void network_manager::compute_output( sample& s )
 {
     _assert_loaded();
 
+    PROFILE_SAMPLES( "inference", 1 );
+
     m_net->set_input( s.isample_size, s.isample );
     m_net->feed_forward();
     output_ptr output_layer = m_net->output();
@@ -250,8 +610,86 @@ void network_manager::compute_output( std::vector<sample>& s )
 {
     _assert_loaded();
 
-    // NOT IMPLEMENTED YET
-    //m_net->batch_feed_forward( std::vector<input_ptr>&, std::vector<output_ptr>& );
+    if ( s.empty() )
+        return;
+
+    PROFILE_SAMPLES( "inference", s.size() );
+
+    _pack_batch( s, false );
+
+    const size_t osample_size = s.front().osample_size;
+    m_batch_output.resize( s.size() * osample_size );
+
+    m_net->batch_feed_forward( s.size(), s.front().isample_size, m_batch_input.data(), osample_size, m_batch_output.data() );
+
+    const float* _output = m_batch_output.data();
+    for ( auto& _s : s )
+    {
+        std::copy( _output, _output + osample_size, const_cast<float*>( _s.osample ) );
+        _output += osample_size;
+    }
+}
+
+void network_manager::compute_output( const size_t batch_size,
+                                      const size_t isample_size, const float* inputs,
+                                      const size_t osample_size, float* outputs )
+{
+    _assert_loaded();
+
+    if ( !batch_size )
+        return;
+
+    PROFILE_SAMPLES( "inference", batch_size );
+
+    m_net->batch_feed_forward( batch_size, isample_size, inputs, osample_size, outputs );
+}
+
+void network_manager::calibrate( const samples_manager& smp_manager )
+{
+    _assert_loaded();
+
+    const std::vector<sample>& samples = smp_manager.get_samples();
+
+    if ( samples.empty() )
+        throw network_exception( "empty calibration samples set" );
+
+    _pack_batch( samples, false );
+
+    m_net->calibrate( samples.size(), samples.front().isample_size, m_batch_input.data() );
+}
+
+void network_manager::prune(   const samples_manager& smp_manager,
+                                const float sparsity,
+                                const size_t& steps,
+                                const size_t& epoch_size,
+                                const size_t& batch_size )
+{
+    _assert_loaded();
+
+    if ( ( sparsity < 0.f ) || ( sparsity >= 1.f ) || !steps )
+        throw network_exception( "invalid pruning schedule" );
+
+    for ( size_t step=1; step<=steps; step++ )
+    {
+        // gradual schedule : larger pruning steps first, while the network is still redundant
+        const float progress = static_cast<float>( step ) / static_cast<float>( steps );
+        const float step_sparsity = sparsity * ( 1.f - std::pow( 1.f - progress, 3.f ) );
+
+        if ( !m_net->prune( step_sparsity ) )
+            throw network_exception( "pruning is not managed by current network backend" );
+
+        LOGGER(info) << "network_manager::prune - step " << step << "/" << steps << " : " << ( 100.f * step_sparsity ) << "% sparsity" << std::endl;
+
+        // fine-tuning with pruned weights kept null, without checkpointing (a previous training checkpoint must not be resumed)
+        if ( epoch_size )
+        {
+            scoped_training _scoped_training( m_net );
+            _train_epochs( smp_manager, augmentation_pipeline::from_config( smp_manager.sample_sizeX(), smp_manager.sample_sizeY() ),
+                0, epoch_size, batch_size, t_progress_fct(), nullptr, 0, 0 );
+        }
+    }
+
+    save_network();
 }
 
 void network_manager::gradient_check( const sample& s )
@@ -288,4 +726,35 @@ void network_manager::dump_activations()
     std::cout << m_net->dump_activations();
 }
 
+void network_manager::set_profiling( const bool enable )
+{
+    profiler::instance().set_enabled( enable );
+}
+
+void network_manager::reset_profiling()
+{
+    profiler::instance().reset();
+}
+
+const std::string network_manager::profiling_report()
+{
+    return profiler::instance().report();
+}
+
+void network_manager::dump_profiling_trace( const std::string& filename )
+{
+    profiler::instance().dump_trace( filename );
+}
+
+void network_manager::set_allocation_tracking( const bool enable, const bool steady_state_check )
+{
+    allocation_tracker::instance().set_enabled( enable );
+    allocation_tracker::instance().set_steady_state_check( steady_state_check );
+}
+
+const std::string network_manager::allocation_report()
+{
+    return allocation_tracker::instance().report();
+}
+
 } /*namespace neurocl*/
@@ -29,12 +29,18 @@ THE SOFTWARE.
 
 #include "common/network_sample.h"
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace neurocl {
 
 class samples_manager;
 class samples_augmenter;
+class augmentation_pipeline;
+struct training_checkpoint;
+class checkpoint_writer;
+class thread_pool;
 
 class network_interface;
 class network_file_handler_interface;
@@ -43,8 +49,8 @@ class network_manager : public network_manager_interface
 {
 public:
 
-	network_manager() : m_network_loaded( false ) {}
-	virtual ~network_manager() {}
+	network_manager();
+	virtual ~network_manager();
 
 	//! load network topology & weights
     void load_network( const std::string& topology_path, const std::string& weights_path ) override;
@@ -62,20 +68,50 @@ public:
 								const size_t& batch_size,
 								t_progress_fct progress_fct = t_progress_fct() ) override;
 
+	//! train a mini-batch of contiguously stored samples
+    float train_batch(  const size_t batch_size,
+                        const size_t isample_size, const float* inputs,
+                        const size_t osample_size, const float* outputs ) override;
+
     //! prepare training epoch
     void prepare_training_epoch() override;
     //! finalize training epoch
     void finalize_training_epoch() override;
 	//! compute network output
     void compute_output( sample& s ) override;
-	//! compute network output using augmented sample
+	//! compute network output using augmented sample : variants are generated in parallel,
+	//! inferred as a single mini-batch, then aggregated (tta_aggregation configuration key)
 	void compute_augmented_output( sample& s, const std::shared_ptr<samples_augmenter>& smp_augmenter ) override;
 	//! compute network outputs for multiple samples
     void compute_output( std::vector<sample>& s ) override;
+	//! compute network outputs for contiguously stored samples (no intermediate copies)
+    void compute_output( const size_t batch_size,
+                         const size_t isample_size, const float* inputs,
+                         const size_t osample_size, float* outputs ) override;
+
+	//! calibrate reduced precision inference on a samples set
+	void calibrate( const samples_manager& smp_manager ) override;
+
+	//! iterative magnitude pruning
+	void prune( const samples_manager& smp_manager,
+				const float sparsity,
+				const size_t& steps,
+				const size_t& epoch_size,
+				const size_t& batch_size ) override;
 
 	//! gradient check
 	void gradient_check( const sample& s ) override;
 
+	//! runtime profiling
+	void set_profiling( const bool enable ) override;
+	void reset_profiling() override;
+	const std::string profiling_report() override;
+	void dump_profiling_trace( const std::string& filename ) override;
+
+	//! runtime allocations tracking
+	void set_allocation_tracking( const bool enable, const bool steady_state_check = false ) override;
+	const std::string allocation_report() override;
+
 	//! dump network parameters
 	void dump_weights() override;
     void dump_bias() override;
@@ -88,12 +124,53 @@ protected:
 private:
 
     void _train_single( const sample& s );
-    void _train_batch( const std::vector<sample>& training_set, const std::shared_ptr<samples_augmenter>& smp_augmenter );
+    void _train_epochs( const samples_manager& smp_manager,
+                        const std::shared_ptr<augmentation_pipeline>& augmentation,
+                        const size_t first_epoch,
+                        const size_t epoch_size,
+                        const size_t batch_size,
+                        t_progress_fct progress_fct,
+                        checkpoint_writer* checkpointer,
+                        const size_t checkpoint_interval,
+                        const unsigned int start_seed );
+    void _train_batch(  const samples_view& training_set,
+                        const std::shared_ptr<samples_augmenter>& smp_augmenter,
+                        const std::shared_ptr<augmentation_pipeline>& augmentation,
+                        const std::uint64_t first_stream );
+    void _pack_batch( const samples_view& samples, bool with_output );
+    void _aggregate_variants( const size_t variants, const size_t osample_size, float* output ) const;
+
+    void _snapshot_training(    training_checkpoint& checkpoint,
+                                const samples_manager& smp_manager,
+                                const size_t epoch,
+                                const unsigned int start_seed );
+    size_t _resume_training( const training_checkpoint& checkpoint, const samples_manager& smp_manager );
+
+private:
+
+    // test time augmentation variants aggregation
+    enum class tta_aggregation
+    {
+        MAX,    // most confident variant output
+        MEAN,   // variants outputs mean
+        VOTE    // variants argmax votes ratios
+    };
 
 private:
 
 	bool m_network_loaded;
 
+    // test time augmentation : rotations range (degrees), aggregation, variants generation threads & batch buffers
+    int m_tta_rotation;
+    tta_aggregation m_tta_aggregation;
+    std::unique_ptr<thread_pool> m_tta_pool;
+    std::vector<float> m_tta_input;
+    std::vector<float> m_tta_output;
+
+    // contiguous mini-batch buffers
+    std::vector<float> m_batch_input;
+    std::vector<float> m_batch_output;
+
 protected:
 
     std::shared_ptr<network_interface> m_net;
@@ -25,15 +25,21 @@ THE SOFTWARE.
 #ifndef NETWORK_RANDOM_H
 #define NETWORK_RANDOM_H
 
-#include <common/network_config.h>
+#include "common/export.h"
+#include "common/network_config.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <random>
 
 namespace neurocl {
 
 namespace random {
 
-class seed
+// exported so that client applications share the library seeds sequence
+class NEUROCL_PUBLIC seed
 {
 public:
     static seed& instance()
@@ -43,15 +49,20 @@ public:
     }
     unsigned int operator()()
     {
-        static unsigned int _offset = 0;
-
         if ( m_seed )
-            return m_seed.get() + _offset++;
+            return m_seed.get() + m_offset.fetch_add( 1, std::memory_order_relaxed );
         else
 			return m_rd();
     }
+
+    //! seeds sequence position, allows to replay random sets when resuming a training session
+    unsigned int offset() const { return m_offset; }
+    void set_offset( const unsigned int offset ) { m_offset = offset; }
+    //! seeded random sets are reproducible
+    bool deterministic() const { return static_cast<bool>( m_seed ); }
+
 private:
-    seed()
+    seed() : m_offset( 0 )
     {
         m_seed = network_config::instance().get_param<unsigned int>( "random_seed" );
     }
@@ -60,41 +71,208 @@ private:
 
 	// optional seed
     boost::optional<unsigned int> m_seed;
+    std::atomic<unsigned int> m_offset;
 
     // using random_device allows to have different random sets at each runtime
     std::random_device m_rd;
 };
 
+//! Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3") :
+//! outputs are a pure function of (key, stream, counter), so that each thread or replica can own a reproducible
+//! stream without shared state, and blocks are generated in lanes the compiler can vectorize
+class philox_generator
+{
+public:
+    //! the key high word is a fixed constant unless given
+    philox_generator( const std::uint32_t key, const std::uint64_t stream = 0, const std::uint32_t key_hi = s_key1 )
+        : m_key( key ), m_key_hi( key_hi ), m_stream( stream ), m_counter( 0 ) {}
+    virtual ~philox_generator() {}
+
+    //! blocks generated at once
+    static constexpr size_t s_lanes = 8;
+
+    //! next block counter (low counter words, the high ones being the stream)
+    void set_counter( const std::uint64_t counter ) { m_counter = counter; }
+
+    //! raw 32 bits words, by groups of s_lanes consecutive blocks stored lane-contiguous :
+    //! word w of block (counter + l) is out[w * s_lanes + l]
+    void bits( std::uint32_t* out, const size_t size )
+    {
+        std::uint32_t bits[s_batch];
+        for ( size_t i=0; i<size; i+=s_batch )
+        {
+            _generate( bits );
+            std::copy( bits, bits + std::min( size_t( s_batch ), size - i ), out + i );
+        }
+    }
+
+    //! uniform values in [0,1)
+    void uniform( float* out, const size_t size )
+    {
+        std::uint32_t bits[s_batch];
+        for ( size_t i=0; i<size; i+=s_batch )
+        {
+            _generate( bits );
+            const size_t n = std::min( size_t( s_batch ), size - i );
+            for ( size_t j=0; j<n; j++ )
+                out[i+j] = static_cast<float>( bits[j] >> 8 ) * s_inv_24;
+        }
+    }
+
+    //! 1 with probability p, 0 otherwise
+    void bernoulli( float* out, const size_t size, const float p )
+    {
+        // comparison on 24 bits integers is exact
+        const std::uint32_t threshold = static_cast<std::uint32_t>( std::max( 0.f, std::min( 1.f, p ) ) * 16777216.f );
+
+        std::uint32_t bits[s_batch];
+        for ( size_t i=0; i<size; i+=s_batch )
+        {
+            _generate( bits );
+            const size_t n = std::min( size_t( s_batch ), size - i );
+            for ( size_t j=0; j<n; j++ )
+                out[i+j] = ( ( bits[j] >> 8 ) < threshold ) ? 1.f : 0.f;
+        }
+    }
+
+    //! normal distribution values (Box-Muller transform)
+    void gaussian( float* out, const size_t size, const float mean, const float stddev )
+    {
+        const size_t half = s_batch / 2;
+
+        std::uint32_t bits[s_batch];
+        float values[s_batch];
+        for ( size_t i=0; i<size; i+=s_batch )
+        {
+            _generate( bits );
+            for ( size_t j=0; j<half; j++ )
+            {
+                const float u1 = static_cast<float>( ( bits[j] >> 8 ) + 1 ) * s_inv_24; // ]0,1]
+                const float u2 = static_cast<float>( bits[j+half] >> 8 ) * s_inv_24;
+                const float r = stddev * std::sqrt( -2.f * std::log( u1 ) );
+                values[j] = mean + r * std::cos( s_two_pi * u2 );
+                values[j+half] = mean + r * std::sin( s_two_pi * u2 );
+            }
+            std::copy( values, values + std::min( size_t( s_batch ), size - i ), out + i );
+        }
+    }
+
+private:
+
+    //! generates s_lanes blocks of 4 words, stored lane-contiguous
+    void _generate( std::uint32_t* out )
+    {
+        std::uint32_t c0[s_lanes], c1[s_lanes], c2[s_lanes], c3[s_lanes];
+
+        for ( size_t l=0; l<s_lanes; l++ )
+        {
+            const std::uint64_t counter = m_counter + l;
+            c0[l] = static_cast<std::uint32_t>( counter );
+            c1[l] = static_cast<std::uint32_t>( counter >> 32 );
+            c2[l] = static_cast<std::uint32_t>( m_stream );
+            c3[l] = static_cast<std::uint32_t>( m_stream >> 32 );
+        }
+        m_counter += s_lanes;
+
+        std::uint32_t k0 = m_key;
+        std::uint32_t k1 = m_key_hi;
+
+        for ( size_t r=0; r<10; r++ )
+        {
+            for ( size_t l=0; l<s_lanes; l++ )
+            {
+                const std::uint64_t p0 = static_cast<std::uint64_t>( s_m0 ) * c0[l];
+                const std::uint64_t p1 = static_cast<std::uint64_t>( s_m1 ) * c2[l];
+                const std::uint32_t _c0 = static_cast<std::uint32_t>( p1 >> 32 ) ^ c1[l] ^ k0;
+                const std::uint32_t _c2 = static_cast<std::uint32_t>( p0 >> 32 ) ^ c3[l] ^ k1;
+                c1[l] = static_cast<std::uint32_t>( p1 );
+                c3[l] = static_cast<std::uint32_t>( p0 );
+                c0[l] = _c0;
+                c2[l] = _c2;
+            }
+            k0 += s_w0;
+            k1 += s_w1;
+        }
+
+        std::copy( c0, c0 + s_lanes, out );
+        std::copy( c1, c1 + s_lanes, out + s_lanes );
+        std::copy( c2, c2 + s_lanes, out + 2 * s_lanes );
+        std::copy( c3, c3 + s_lanes, out + 3 * s_lanes );
+    }
+
+private:
+
+    static constexpr size_t s_batch = 4 * s_lanes;
+
+    static constexpr std::uint32_t s_m0 = 0xD2511F53;
+    static constexpr std::uint32_t s_m1 = 0xCD9E8D57;
+    static constexpr std::uint32_t s_w0 = 0x9E3779B9;
+    static constexpr std::uint32_t s_w1 = 0xBB67AE85;
+    static constexpr std::uint32_t s_key1 = 0x6A09E667;
+
+    static constexpr float s_inv_24 = 1.f / 16777216.f;
+    static constexpr float s_two_pi = 6.28318530718f;
+
+    const std::uint32_t m_key;
+    const std::uint32_t m_key_hi;
+    const std::uint64_t m_stream;
+    std::uint64_t m_counter;
+};
+
 class rand_bernoulli_generator
 {
 public:
     rand_bernoulli_generator( const float p )
-        : m_rng{ seed::instance()() }, m_bernoulli{ p } {}
+        : m_rng{ seed::instance()() }, m_p( p ), m_index( s_buffer_size ) {}
     virtual ~rand_bernoulli_generator() {}
 
     template <typename T = bool>
-    T gen() { return static_cast<T>( m_bernoulli( m_rng ) ); }
+    T gen()
+    {
+        if ( m_index == s_buffer_size )
+        {
+            m_rng.bernoulli( m_buffer, s_buffer_size, m_p );
+            m_index = 0;
+        }
+        return static_cast<T>( m_buffer[m_index++] );
+    }
 
 private:
-    std::mt19937 m_rng;
-    std::bernoulli_distribution m_bernoulli;
+    static const size_t s_buffer_size = 32;
+
+    philox_generator m_rng;
+    const float m_p;
+    float m_buffer[s_buffer_size];
+    size_t m_index;
 };
 
 class rand_gaussian_generator
 {
 public:
     rand_gaussian_generator( const float mean, const float stddev )
-        : m_rng{ seed::instance()() }, m_normal{ mean, stddev }
+        : m_rng{ seed::instance()() }, m_mean( mean ), m_stddev( stddev ), m_index( s_buffer_size ) {}
+
+    float operator()()
     {
-        //m_rng.seed(...);
+        if ( m_index == s_buffer_size )
+        {
+            m_rng.gaussian( m_buffer, s_buffer_size, m_mean, m_stddev );
+            m_index = 0;
+        }
+        return m_buffer[m_index++];
     }
 
-    float operator()() { return m_normal( m_rng ); }
+    //! batch generation
+    void fill( float* out, const size_t size ) { m_rng.gaussian( out, size, m_mean, m_stddev ); }
 
 private:
+    static const size_t s_buffer_size = 32;
 
-    std::mt19937 m_rng;
-    std::normal_distribution<> m_normal;
+    philox_generator m_rng;
+    const float m_mean;
+    const float m_stddev;
+    float m_buffer[s_buffer_size];
+    size_t m_index;
 };
 
 } //namespace random
@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace neurocl {
 
@@ -107,6 +108,27 @@ struct test_sample : sample
     boost::shared_array<float> osample_ref;  // reference output sample buffer
 };
 
+// Lightweight non-owning view over contiguous samples (e.g. a mini-batch)
+class samples_view
+{
+public:
+    samples_view() : m_data( nullptr ), m_size( 0 ) {}
+    samples_view( const sample* data, const size_t size ) : m_data( data ), m_size( size ) {}
+    samples_view( const std::vector<sample>& samples ) : m_data( samples.data() ), m_size( samples.size() ) {}
+
+    const sample* begin() const { return m_data; }
+    const sample* end() const { return m_data + m_size; }
+    const sample& front() const { return *m_data; }
+    const sample& operator[]( const size_t i ) const { return m_data[i]; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+private:
+    const sample* m_data;
+    size_t m_size;
+};
+
 } //namespace neurocl
 
 #endif //NETWORK_SAMPLE_H
@@ -0,0 +1,233 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "profiler.h"
+#include "network_exception.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace neurocl {
+
+std::atomic<bool> profiler::s_enabled( false );
+
+namespace {
+
+double _microseconds( const profiler::t_clock::duration& d )
+{
+    return std::chrono::duration<double,std::micro>( d ).count();
+}
+
+std::string _json_escaped( const std::string& str )
+{
+    std::string escaped;
+    for ( const char c : str )
+    {
+        if ( ( c == '"' ) || ( c == '\\' ) )
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // anonymous namespace
+
+profiler& profiler::instance()
+{
+    static profiler s;
+    return s;
+}
+
+void profiler::set_enabled( const bool enabled )
+{
+#ifndef PROFILING_ENABLED
+    if ( enabled )
+    {
+        LOGGER(warning) << "profiler::set_enabled - profiling instrumentation is not built in (PROFILING_ENABLED is not defined)" << std::endl;
+    }
+#endif
+    s_enabled.store( enabled, std::memory_order_relaxed );
+}
+
+void profiler::reset()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    m_start = t_clock::now();
+    m_sections.clear();
+    m_sections_index.clear();
+    m_events.clear();
+    m_dropped_events = 0;
+    m_samples.clear();
+
+    // counters are referenced by instrumented code, only zero them
+    for ( auto& _counter : m_counters )
+        _counter.second->store( 0, std::memory_order_relaxed );
+
+    m_allocations = 0;
+    m_allocated_bytes = 0;
+}
+
+size_t profiler::_thread_index( const std::thread::id& id )
+{
+    auto it = m_threads.find( id );
+    if ( it == m_threads.end() )
+        it = m_threads.emplace( id, m_threads.size() ).first;
+    return it->second;
+}
+
+void profiler::add_section( const std::string& name, const char* phase, const t_clock::time_point& start, const t_clock::time_point& end )
+{
+    const t_clock::duration duration = end - start;
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    auto it = m_sections_index.find( std::make_pair( name, std::string( phase ) ) );
+    if ( it == m_sections_index.end() )
+    {
+        it = m_sections_index.emplace( std::make_pair( name, std::string( phase ) ), m_sections.size() ).first;
+        m_sections.push_back( section_stats{ name, phase, 0, t_clock::duration::zero(), duration, duration } );
+    }
+
+    section_stats& stats = m_sections[it->second];
+    ++stats.calls;
+    stats.total += duration;
+    stats.min = std::min( stats.min, duration );
+    stats.max = std::max( stats.max, duration );
+
+    if ( m_events.size() < s_max_trace_events )
+        m_events.push_back( trace_event{ it->second, _thread_index( std::this_thread::get_id() ), start, duration } );
+    else
+        ++m_dropped_events;
+}
+
+std::atomic<std::uint64_t>& profiler::counter( const char* name )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    std::unique_ptr<std::atomic<std::uint64_t>>& _counter = m_counters[name];
+    if ( !_counter )
+        _counter.reset( new std::atomic<std::uint64_t>( 0 ) );
+
+    return *_counter;
+}
+
+void profiler::add_allocation( const size_t bytes )
+{
+    m_allocations.fetch_add( 1, std::memory_order_relaxed );
+    m_allocated_bytes.fetch_add( bytes, std::memory_order_relaxed );
+}
+
+void profiler::add_samples( const char* name, const size_t samples, const t_clock::duration& duration )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    samples_stats& stats = m_samples[name];
+    stats.samples += samples;
+    stats.total += duration;
+}
+
+const std::string profiler::report() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision( 3 );
+
+    ss << "profiling report over " << _microseconds( t_clock::now() - m_start ) / 1000.0 << "ms";
+#ifndef PROFILING_ENABLED
+    ss << " (instrumentation is not built in, define PROFILING_ENABLED)";
+#endif
+    ss << std::endl << std::endl;
+
+    ss << std::left << std::setw( 32 ) << "section" << std::setw( 20 ) << "phase" << std::right
+        << std::setw( 10 ) << "calls" << std::setw( 14 ) << "total (ms)" << std::setw( 12 ) << "mean (us)"
+        << std::setw( 12 ) << "min (us)" << std::setw( 12 ) << "max (us)" << std::endl;
+
+    for ( const auto& _section : m_sections )
+    {
+        ss << std::left << std::setw( 32 ) << _section.name << std::setw( 20 ) << _section.phase << std::right
+            << std::setw( 10 ) << _section.calls
+            << std::setw( 14 ) << _microseconds( _section.total ) / 1000.0
+            << std::setw( 12 ) << _microseconds( _section.total ) / static_cast<double>( _section.calls )
+            << std::setw( 12 ) << _microseconds( _section.min )
+            << std::setw( 12 ) << _microseconds( _section.max ) << std::endl;
+    }
+
+    if ( m_dropped_events )
+        ss << "(" << m_dropped_events << " trace events dropped)" << std::endl;
+
+    ss << std::endl << std::left << std::setw( 32 ) << "tensor operation" << std::right << std::setw( 10 ) << "calls" << std::endl;
+
+    for ( const auto& _counter : m_counters )
+    {
+        const std::uint64_t calls = _counter.second->load( std::memory_order_relaxed );
+        if ( calls )
+            ss << std::left << std::setw( 32 ) << _counter.first << std::right << std::setw( 10 ) << calls << std::endl;
+    }
+
+    ss << std::endl << "allocated: " << m_allocated_bytes.load() << " bytes in " << m_allocations.load() << " allocations" << std::endl;
+
+    for ( const auto& _samples : m_samples )
+    {
+        const double seconds = _microseconds( _samples.second.total ) / 1e6;
+        ss << _samples.first << ": " << _samples.second.samples << " samples, "
+            << ( ( seconds > 0.0 ) ? static_cast<double>( _samples.second.samples ) / seconds : 0.0 ) << " samples/sec" << std::endl;
+    }
+
+    return ss.str();
+}
+
+void profiler::dump_trace( const std::string& filename ) const
+{
+    std::ofstream trace_out( filename, std::ios::out | std::ios::trunc );
+    if ( !trace_out || !trace_out.is_open() )
+        throw network_exception( "unable to open trace file " + filename );
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    trace_out << std::fixed << std::setprecision( 3 );
+    trace_out << "{\"traceEvents\":[";
+
+    for ( size_t i=0; i<m_events.size(); i++ )
+    {
+        const trace_event& _event = m_events[i];
+        const section_stats& _section = m_sections[_event.section];
+
+        trace_out << ( i ? ",\n" : "\n" )
+            << "{\"name\":\"" << _json_escaped( _section.name + " " + _section.phase ) << "\",\"cat\":\"" << _json_escaped( _section.phase )
+            << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << _event.thread
+            << ",\"ts\":" << _microseconds( _event.start - m_start )
+            << ",\"dur\":" << _microseconds( _event.duration ) << "}";
+    }
+
+    trace_out << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+    LOGGER(info) << "profiler::dump_trace - " << m_events.size() << " events written to \'" << filename << "\'" << std::endl;
+}
+
+} //namespace neurocl
@@ -0,0 +1,197 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "export.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace neurocl {
+
+//! built-in profiler : sections wall times, calls counters, allocated bytes and samples throughputs
+//! NOTE : instrumentation macros below are compiled out unless PROFILING_ENABLED is defined,
+//! and only cost a relaxed atomic load when profiling is disabled at runtime
+class NEUROCL_PUBLIC profiler
+{
+public:
+
+    using t_clock = std::chrono::steady_clock;
+
+    static profiler& instance();
+
+    //! runtime profiling flag
+    static bool enabled() { return s_enabled.load( std::memory_order_relaxed ); }
+    void set_enabled( const bool enabled );
+    //! clear all results
+    void reset();
+
+    //! record a timed section phase (e.g. a layer feed forward)
+    void add_section( const std::string& name, const char* phase, const t_clock::time_point& start, const t_clock::time_point& end );
+    //! get a named calls counter (reference stays valid, reset only zeroes it)
+    std::atomic<std::uint64_t>& counter( const char* name );
+    //! record allocated bytes
+    void add_allocation( const size_t bytes );
+    //! record samples processed in a given duration
+    void add_samples( const char* name, const size_t samples, const t_clock::duration& duration );
+
+    //! results as a text table
+    const std::string report() const;
+    //! dump recorded sections as a Chrome trace JSON file (chrome://tracing)
+    void dump_trace( const std::string& filename ) const;
+
+private:
+
+    profiler() : m_start( t_clock::now() ), m_dropped_events( 0 ), m_allocations( 0 ), m_allocated_bytes( 0 ) {}
+    virtual ~profiler() {}
+
+    size_t _thread_index( const std::thread::id& id );
+
+private:
+
+    struct section_stats
+    {
+        std::string name;
+        std::string phase;
+        std::uint64_t calls;
+        t_clock::duration total;
+        t_clock::duration min;
+        t_clock::duration max;
+    };
+
+    struct trace_event
+    {
+        size_t section;
+        size_t thread;
+        t_clock::time_point start;
+        t_clock::duration duration;
+    };
+
+    struct samples_stats
+    {
+        std::uint64_t samples;
+        t_clock::duration total;
+    };
+
+    static std::atomic<bool> s_enabled;
+    // bounds trace memory, sections statistics are still updated past it
+    static const size_t s_max_trace_events = 1 << 20;
+
+    t_clock::time_point m_start;
+
+    mutable std::mutex m_mutex;
+    std::vector<section_stats> m_sections;
+    std::map<std::pair<std::string,std::string>,size_t> m_sections_index;
+    std::vector<trace_event> m_events;
+    std::map<std::thread::id,size_t> m_threads;
+    size_t m_dropped_events;
+    std::map<std::string,std::unique_ptr<std::atomic<std::uint64_t>>> m_counters;
+    std::map<std::string,samples_stats> m_samples;
+
+    std::atomic<std::uint64_t> m_allocations;
+    std::atomic<std::uint64_t> m_allocated_bytes;
+};
+
+//! scoped section phase timer
+class profiler_scope
+{
+public:
+    profiler_scope( std::string&& name, const char* phase )
+        : m_name( std::move( name ) ), m_phase( phase ), m_enabled( profiler::enabled() )
+    {
+        if ( m_enabled )
+            m_start = profiler::t_clock::now();
+    }
+    ~profiler_scope()
+    {
+        if ( m_enabled )
+            profiler::instance().add_section( m_name, m_phase, m_start, profiler::t_clock::now() );
+    }
+
+private:
+    const std::string m_name;
+    const char* m_phase;
+    const bool m_enabled;
+    profiler::t_clock::time_point m_start;
+};
+
+//! scoped samples throughput timer
+class profiler_samples_scope
+{
+public:
+    profiler_samples_scope( const char* name, const size_t samples )
+        : m_name( name ), m_samples( samples ), m_enabled( profiler::enabled() )
+    {
+        if ( m_enabled )
+            m_start = profiler::t_clock::now();
+    }
+    ~profiler_samples_scope()
+    {
+        if ( m_enabled )
+            profiler::instance().add_samples( m_name, m_samples, profiler::t_clock::now() - m_start );
+    }
+
+private:
+    const char* m_name;
+    const size_t m_samples;
+    const bool m_enabled;
+    profiler::t_clock::time_point m_start;
+};
+
+} //namespace neurocl
+
+#ifdef PROFILING_ENABLED
+// section name expression is only evaluated when profiling is enabled at runtime
+#define PROFILE_SCOPE(name,phase) neurocl::profiler_scope _profiler_scope( neurocl::profiler::enabled() ? std::string( name ) : std::string(), phase )
+#define PROFILE_SAMPLES(name,samples) neurocl::profiler_samples_scope _profiler_samples_scope( name, samples )
+#define PROFILE_COUNT(name) \
+    do { \
+        if ( neurocl::profiler::enabled() ) \
+        { \
+            static std::atomic<std::uint64_t>& _profiler_counter = neurocl::profiler::instance().counter( name ); \
+            _profiler_counter.fetch_add( 1, std::memory_order_relaxed ); \
+        } \
+    } while ( false )
+#define PROFILE_ALLOCATION(bytes) \
+    do { \
+        if ( neurocl::profiler::enabled() ) \
+            neurocl::profiler::instance().add_allocation( bytes ); \
+    } while ( false )
+#else
+#define PROFILE_SCOPE(name,phase)
+#define PROFILE_SAMPLES(name,samples)
+#define PROFILE_COUNT(name)
+#define PROFILE_ALLOCATION(bytes)
+#endif
+
+#endif //PROFILER_H
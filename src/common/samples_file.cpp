@@ -0,0 +1,217 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "samples_file.h"
+#include "network_exception.h"
+#include "logger.h"
+
+#include <boost/filesystem.hpp>
+namespace bfs = boost::filesystem;
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace neurocl {
+
+static const char s_samples_file_magic[8] = { 'N', 'E', 'U', 'R', 'O', 'C', 'L', 'S' };
+
+samples_file::samples_file( const std::string& filename )
+{
+    namespace bip = boost::interprocess;
+
+    m_header = read_header( filename );
+
+    // copy on write mapping : pages are shared between processes,
+    // and samples can still be modified in place without altering the file
+    m_file = bip::file_mapping( filename.c_str(), bip::read_only );
+    m_region = bip::mapped_region( m_file, bip::copy_on_write );
+
+    const char* data = static_cast<const char*>( m_region.get_address() );
+    const t_input_type input_type = static_cast<t_input_type>( m_header.input_type );
+
+    if ( input_type == t_input_type::UINT8 )
+    {
+        const std::uint8_t* inputs = reinterpret_cast<const std::uint8_t*>( data + m_header.inputs_offset );
+
+        m_decoded_inputs.resize( m_header.samples_count * m_header.input_size );
+        std::transform( inputs, inputs + m_decoded_inputs.size(), m_decoded_inputs.begin(),
+            []( const std::uint8_t& v ){ return static_cast<float>( v ) / 255.f; } );
+    }
+
+    LOGGER(info) << "samples_file::samples_file - mapped " << m_header.samples_count << " samples from \'" << filename << "\'" << std::endl;
+}
+
+samples_file_header samples_file::read_header( const std::string& filename )
+{
+    if ( !bfs::exists( filename ) )
+    {
+        LOGGER(error) << "samples_file::read_header - error reading binary samples file \'" << filename << "\'" << std::endl;
+        throw network_exception( "error reading binary samples file" );
+    }
+
+    const std::uint64_t file_size = bfs::file_size( filename );
+
+    if ( file_size < sizeof( samples_file_header ) )
+        throw network_exception( "invalid binary samples file (truncated header)" );
+
+    std::ifstream data_in( filename, std::ios::in | std::ios::binary );
+    if ( !data_in || !data_in.is_open() )
+    {
+        LOGGER(error) << "samples_file::read_header - error opening binary samples file \'" << filename << "\'" << std::endl;
+        throw network_exception( "error reading binary samples file" );
+    }
+
+    samples_file_header header;
+    data_in.read( reinterpret_cast<char*>( &header ), sizeof( samples_file_header ) );
+
+    if ( std::memcmp( header.magic, s_samples_file_magic, sizeof( s_samples_file_magic ) ) != 0 )
+        throw network_exception( "invalid binary samples file (bad magic)" );
+    if ( header.version != s_version )
+        throw network_exception( "unmanaged binary samples file version" );
+    if ( header.endian_tag != s_endian_tag )
+        throw network_exception( "binary samples file was written with a different byte order" );
+    if ( ( header.input_type != static_cast<std::uint32_t>( t_input_type::FLOAT32 ) ) &&
+        ( header.input_type != static_cast<std::uint32_t>( t_input_type::UINT8 ) ) )
+        throw network_exception( "unmanaged binary samples file input type" );
+
+    const std::uint64_t inputs_bytes = header.samples_count * header.input_size * _input_value_size( static_cast<t_input_type>( header.input_type ) );
+    const std::uint64_t outputs_bytes = header.samples_count * header.output_size * sizeof( float );
+
+    if ( ( header.inputs_offset + inputs_bytes > file_size ) ||
+        ( header.outputs_offset + outputs_bytes > file_size ) ||
+        ( header.inputs_offset % s_alignment ) || ( header.outputs_offset % s_alignment ) )
+        throw network_exception( "invalid binary samples file (inconsistent blocks)" );
+
+    return header;
+}
+
+void samples_file::read_inputs( std::istream& stream, const samples_file_header& header, const size_t count, float* inputs )
+{
+    const size_t values = count * header.input_size;
+
+    if ( static_cast<t_input_type>( header.input_type ) == t_input_type::UINT8 )
+    {
+        std::vector<std::uint8_t> buffer( values );
+        stream.read( reinterpret_cast<char*>( buffer.data() ), values );
+        std::transform( buffer.begin(), buffer.end(), inputs,
+            []( const std::uint8_t& v ){ return static_cast<float>( v ) / 255.f; } );
+    }
+    else
+        stream.read( reinterpret_cast<char*>( inputs ), values * sizeof( float ) );
+
+    if ( !stream )
+        throw network_exception( "error reading binary samples file inputs" );
+}
+
+std::vector<neurocl::sample> samples_file::samples( const size_t max_size ) const
+{
+    const char* data = static_cast<const char*>( m_region.get_address() );
+
+    const float* inputs = m_decoded_inputs.empty() ?
+        reinterpret_cast<const float*>( data + m_header.inputs_offset ) : m_decoded_inputs.data();
+    const float* outputs = reinterpret_cast<const float*>( data + m_header.outputs_offset );
+
+    const size_t count = max_size ? std::min<size_t>( max_size, m_header.samples_count ) : m_header.samples_count;
+
+    std::vector<neurocl::sample> samples;
+    samples.reserve( count );
+
+    for ( size_t i=0; i<count; i++ )
+        samples.emplace_back(   m_header.input_size, inputs + i * m_header.input_size,
+                                m_header.output_size, outputs + i * m_header.output_size );
+
+    return samples;
+}
+
+void samples_file::write(   const std::string& filename,
+                            const std::vector<neurocl::sample>& samples,
+                            const size_t size_x,
+                            const size_t size_y,
+                            const t_input_type& input_type )
+{
+    if ( samples.empty() )
+        throw network_exception( "cannot write empty samples set" );
+
+    const size_t input_size = samples.front().isample_size;
+    const size_t output_size = samples.front().osample_size;
+
+    for ( const auto& _sample : samples )
+        if ( ( _sample.isample_size != input_size ) || ( _sample.osample_size != output_size ) )
+            throw network_exception( "non uniform sample size in input sample set" );
+
+    samples_file_header header;
+    std::memset( &header, 0, sizeof( samples_file_header ) );
+    std::memcpy( header.magic, s_samples_file_magic, sizeof( s_samples_file_magic ) );
+    header.version = s_version;
+    header.endian_tag = s_endian_tag;
+    header.input_type = static_cast<std::uint32_t>( input_type );
+    header.size_x = static_cast<std::uint32_t>( size_x );
+    header.size_y = static_cast<std::uint32_t>( size_y );
+    header.input_size = static_cast<std::uint32_t>( input_size );
+    header.output_size = static_cast<std::uint32_t>( output_size );
+    header.samples_count = samples.size();
+    header.inputs_offset = _align( sizeof( samples_file_header ) );
+    header.outputs_offset = _align( header.inputs_offset + samples.size() * input_size * _input_value_size( input_type ) );
+
+    std::ofstream data_out( filename, std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !data_out || !data_out.is_open() )
+    {
+        LOGGER(error) << "samples_file::write - error opening binary samples file \'" << filename << "\'" << std::endl;
+        throw network_exception( "error writing binary samples file" );
+    }
+
+    auto _pad_to = [&data_out]( const std::uint64_t offset ) {
+        while ( static_cast<std::uint64_t>( data_out.tellp() ) < offset )
+            data_out.put( 0 );
+    };
+
+    data_out.write( reinterpret_cast<const char*>( &header ), sizeof( samples_file_header ) );
+
+    _pad_to( header.inputs_offset );
+    std::vector<std::uint8_t> buffer( input_size );
+    for ( const auto& _sample : samples )
+    {
+        if ( input_type == t_input_type::UINT8 )
+        {
+            std::transform( _sample.isample, _sample.isample + input_size, buffer.begin(),
+                []( const float& v ){ return static_cast<std::uint8_t>( std::lround( 255.f * std::min( std::max( v, 0.f ), 1.f ) ) ); } );
+            data_out.write( reinterpret_cast<const char*>( buffer.data() ), input_size );
+        }
+        else
+            data_out.write( reinterpret_cast<const char*>( _sample.isample ), input_size * sizeof( float ) );
+    }
+
+    _pad_to( header.outputs_offset );
+    for ( const auto& _sample : samples )
+        data_out.write( reinterpret_cast<const char*>( _sample.osample ), output_size * sizeof( float ) );
+
+    if ( !data_out )
+        throw network_exception( "error writing binary samples file" );
+
+    LOGGER(info) << "samples_file::write - wrote " << samples.size() << " samples to \'" << filename << "\'" << std::endl;
+}
+
+} //namespace neurocl
@@ -0,0 +1,126 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef SAMPLES_FILE_H
+#define SAMPLES_FILE_H
+
+#include "export.h"
+
+#include "network_sample.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace neurocl {
+
+// Binary samples container layout (native byte order, blocks aligned on 64 bytes):
+// header | inputs block (samples_count x input_size) | outputs block (samples_count x output_size, float32)
+// Inputs are stored either as float32 or as uint8 (scaled by 1/255 when loaded).
+struct samples_file_header
+{
+    char magic[8];              // "NEUROCLS"
+    std::uint32_t version;
+    std::uint32_t endian_tag;   // 0x01020304 written in native byte order
+    std::uint32_t input_type;   // t_input_type
+    std::uint32_t size_x;       // sample 2D size
+    std::uint32_t size_y;
+    std::uint32_t input_size;   // values per input sample
+    std::uint32_t output_size;  // values per output sample
+    std::uint32_t reserved;
+    std::uint64_t samples_count;
+    std::uint64_t inputs_offset;
+    std::uint64_t outputs_offset;
+};
+
+class NEUROCL_PUBLIC samples_file
+{
+public:
+
+    enum class t_input_type : std::uint32_t
+    {
+        FLOAT32 = 0,
+        UINT8
+    };
+
+public:
+
+    //! memory map a binary samples file
+    samples_file( const std::string& filename );
+    virtual ~samples_file() {}
+
+    //! write samples to a binary samples file
+    static void write(  const std::string& filename,
+                        const std::vector<neurocl::sample>& samples,
+                        const size_t size_x,
+                        const size_t size_y,
+                        const t_input_type& input_type = t_input_type::FLOAT32 );
+
+    //! build samples pointing into the mapping (restricted to max_size if not null)
+    std::vector<neurocl::sample> samples( const size_t max_size = 0 ) const;
+
+    //! read and validate a binary samples file header
+    static samples_file_header read_header( const std::string& filename );
+
+    //! read count input samples at current stream position (inputs block), decoded to float
+    static void read_inputs( std::istream& stream, const samples_file_header& header, const size_t count, float* inputs );
+
+    size_t samples_count() const { return m_header.samples_count; }
+    size_t size_x() const { return m_header.size_x; }
+    size_t size_y() const { return m_header.size_y; }
+
+private:
+
+    static const std::uint32_t s_version = 1;
+    static const std::uint32_t s_endian_tag = 0x01020304;
+    static const std::uint64_t s_alignment = 64;
+
+    static std::uint64_t _align( const std::uint64_t offset )
+    {
+        return ( ( offset + s_alignment - 1 ) / s_alignment ) * s_alignment;
+    }
+
+    static size_t _input_value_size( const t_input_type& input_type )
+    {
+        return ( input_type == t_input_type::UINT8 ) ? sizeof( std::uint8_t ) : sizeof( float );
+    }
+
+private:
+
+    samples_file_header m_header;
+
+    boost::interprocess::file_mapping m_file;
+    boost::interprocess::mapped_region m_region;
+
+    // uint8 inputs have to be decoded once to float
+    std::vector<float> m_decoded_inputs;
+};
+
+} //namespace neurocl
+
+#endif //SAMPLES_FILE_H
@@ -23,8 +23,10 @@ THE SOFTWARE.
 */
 
 #include "samples_manager.h"
+#include "samples_file.h"
 #include "network_random.h"
 #include "network_exception.h"
+#include "thread_pool.h"
 #include "logger.h"
 
 #include "CImg.h"
@@ -32,8 +34,13 @@ THE SOFTWARE.
 #include <boost/filesystem.hpp>
 namespace bfs = boost::filesystem;
 
+#include <algorithm>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <fstream>
+#include <numeric>
 #include <sstream>
 
 namespace neurocl {
@@ -59,6 +66,57 @@ cimg_library::CImg<float> _get_preprocessed_image( const std::string& file )
     return img;
 }
 
+// process [0;count[ items in chunks on a thread pool, first worker exception being rethrown
+void _parallel_chunks( const size_t count, const std::function<void(const size_t,const size_t)>& process )
+{
+    if ( !count )
+        return;
+
+    const size_t threads = std::max( 1u, std::thread::hardware_concurrency() );
+    const size_t chunk_size = std::max<size_t>( 1, ( count + 4 * threads - 1 ) / ( 4 * threads ) );
+    const size_t chunks = ( count + chunk_size - 1 ) / chunk_size;
+
+    std::vector<std::exception_ptr> errors( chunks );
+
+    thread_pool pool( std::min( threads, chunks ) );
+
+    for ( size_t c=0; c<chunks; c++ )
+    {
+        pool.add_job( [&process,&errors,c,chunk_size,count]()
+        {
+            try
+            {
+                process( c * chunk_size, std::min( ( c + 1 ) * chunk_size, count ) );
+            }
+            catch(...)
+            {
+                errors[c] = std::current_exception();
+            }
+        } );
+    }
+
+    pool.wait_all();
+
+    for ( const auto& error : errors )
+        if ( error )
+            std::rethrow_exception( error );
+}
+
+// parse next unsigned integer in [begin;end[, skipping separators
+const char* _parse_uint( const char* begin, const char* end, std::uint32_t& value, bool& parsed )
+{
+    while ( ( begin != end ) && ( ( *begin < '0' ) || ( *begin > '9' ) ) )
+        ++begin;
+
+    parsed = ( begin != end );
+
+    value = 0;
+    while ( ( begin != end ) && ( *begin >= '0' ) && ( *begin <= '9' ) )
+        value = 10 * value + static_cast<std::uint32_t>( *begin++ - '0' );
+
+    return begin;
+}
+
 void samples_manager::load_samples( const std::string& input_filename, bool shuffle, t_preproc extra_preproc )
 {
     m_sample_sizeX = m_sample_sizeY = 0;
@@ -77,9 +135,12 @@ void samples_manager::load_samples( const std::string& input_filename, bool shuf
     }
 
     // clear previous samples
-    m_input_samples.clear();
-    m_output_samples.clear();
-    m_samples_set.clear();
+    _clear_samples();
+
+    // first pass : parse samples list
+    std::vector<std::string> image_filenames;
+    std::vector<size_t> output_offsets{ 0 };
+    std::vector<float> outputs;
 
     std::string line;
 
@@ -95,90 +156,259 @@ void samples_manager::load_samples( const std::string& input_filename, bool shuf
         if ( image_filename.size() == 0 || image_filename[0] == '#')
             continue;
 
-        // preprocess and save input image
-        cimg_library::CImg<float> img = _get_preprocessed_image( image_filename );
+        image_filenames.push_back( image_filename );
 
-        if ( !m_sample_sizeX && !m_sample_sizeY )
-        {
-            m_sample_sizeX = static_cast<size_t>( img.width() );
-            m_sample_sizeY = static_cast<size_t>( img.height() );
-
-            m_augmenter = std::make_shared<samples_augmenter>( m_sample_sizeX, m_sample_sizeY );
-        }
-        else
+        // If they exist, read the target values from the rest of the line:
+        while ( !ss.eof() )
         {
-            if ( ( m_sample_sizeX != static_cast<size_t>( img.width() ) ) ||
-                ( m_sample_sizeY != static_cast<size_t>( img.height() ) ) )
-                throw network_exception( "non uniform sample size in input sample set" );
+            float val;
+            if ( !(ss >> val).fail() )
+                outputs.push_back( val );
         }
+        output_offsets.push_back( outputs.size() );
 
-        // manage custom preprocessing if needed
-        if ( extra_preproc )
+        // samples are packed with a uniform output size (cf. _physical_reorder)
+        const size_t output_size = output_offsets.back() - output_offsets[output_offsets.size()-2];
+        if ( output_size != output_offsets[1] )
         {
-            extra_preproc( img.data(), img.width(), img.height() );
+            LOGGER(error) << "samples_manager::load_samples - sample \'" << image_filename << "\' has " << output_size
+                << " output values, expecting " << output_offsets[1] << std::endl;
+            throw network_exception( "non uniform output size in input sample set" );
         }
 
-        // store input sample in list
-        size_t input_size = img.size();
-        boost::shared_array<float> input_sample( new float[input_size] );
-        std::copy( img.data(), img.data()+input_size, input_sample.get() );
-        m_input_samples.push_back( input_sample );
+        // manage restricted size
+        if ( m_restrict_size == image_filenames.size() )
+            break;
+    }
+
+    if ( image_filenames.empty() )
+        return;
 
-        // If they exist, read the target values from the rest of the line:
-        std::vector<float> _vals;
-        while ( !ss.eof() )
+    // first image gives samples size
+    cimg_library::CImg<float> img = _get_preprocessed_image( image_filenames.front() );
+
+    m_sample_sizeX = static_cast<size_t>( img.width() );
+    m_sample_sizeY = static_cast<size_t>( img.height() );
+    m_augmenter = std::make_shared<samples_augmenter>( m_sample_sizeX, m_sample_sizeY );
+
+    const size_t input_size = img.size();
+
+    // second pass : decode images in parallel, directly in the contiguous samples storage
+    m_packed_inputs.resize( image_filenames.size() * input_size );
+    m_packed_outputs = std::move( outputs );
+
+    _parallel_chunks( image_filenames.size(), [&]( const size_t begin, const size_t end )
+    {
+        for ( size_t i=begin; i<end; i++ )
         {
-            float val;
-            if ( !(ss >> val).fail() )
-                _vals.push_back( val );
+            cimg_library::CImg<float> _img = ( i == 0 ) ? img : _get_preprocessed_image( image_filenames[i] );
+
+            if ( ( m_sample_sizeX != static_cast<size_t>( _img.width() ) ) ||
+                ( m_sample_sizeY != static_cast<size_t>( _img.height() ) ) )
+                throw network_exception( "non uniform sample size in input sample set" );
+
+            // manage custom preprocessing if needed (must be reentrant)
+            if ( extra_preproc )
+            {
+                extra_preproc( _img.data(), _img.width(), _img.height() );
+            }
+
+            std::copy( _img.data(), _img.data() + input_size, m_packed_inputs.data() + i * input_size );
         }
+    } );
 
-        // store output sample in list
-        size_t output_size = _vals.size();
-        boost::shared_array<float> output_sample{ new float[output_size] };
-        std::copy( _vals.begin(), _vals.end(), output_sample.get() );
-        m_output_samples.push_back( output_sample );
+    for ( size_t i=0; i<image_filenames.size(); i++ )
+        m_samples_set.push_back( neurocl::sample(   input_size, m_packed_inputs.data() + i * input_size,
+                                                    output_offsets[i+1] - output_offsets[i], m_packed_outputs.data() + output_offsets[i] ) );
 
-        // store new sample
-        m_samples_set.push_back( neurocl::sample( input_size, m_input_samples.back().get(), output_size, m_output_samples.back().get() ) );
+    LOGGER(info) << "samples_manager::load_samples - successfully loaded " << m_samples_set.size() << " samples" << std::endl;
 
-        // manage restricted size
-        if ( m_restrict_size == m_samples_set.size() )
-            break;
-    }
+    _reset_samples_order();
+
+    if ( m_physical_shuffle )
+        _pack_samples();
 
     if ( shuffle )
         this->shuffle();
 }
 
-const std::vector<neurocl::sample> samples_manager::get_next_batch( const size_t size ) const noexcept
+void samples_manager::load_binary_samples( const std::string& input_filename, bool shuffle )
+{
+    // clear previous samples
+    _clear_samples();
+
+    m_samples_file = std::make_shared<samples_file>( input_filename );
+
+    m_sample_sizeX = m_samples_file->size_x();
+    m_sample_sizeY = m_samples_file->size_y();
+
+    if ( m_sample_sizeX && m_sample_sizeY )
+        m_augmenter = std::make_shared<samples_augmenter>( m_sample_sizeX, m_sample_sizeY );
+
+    // samples directly point into the mapping
+    m_samples_set = m_samples_file->samples( m_restrict_size );
+
+    LOGGER(info) << "samples_manager::load_binary_samples - successfully loaded " << m_samples_set.size() << " samples" << std::endl;
+
+    _reset_samples_order();
+
+    if ( m_physical_shuffle )
+        _pack_samples();
+
+    if ( shuffle )
+        this->shuffle();
+}
+
+void samples_manager::save_binary_samples( const std::string& output_filename, bool uint8_inputs ) const
+{
+    samples_file::write( output_filename, m_samples_set, m_sample_sizeX, m_sample_sizeY,
+        uint8_inputs ? samples_file::t_input_type::UINT8 : samples_file::t_input_type::FLOAT32 );
+}
+
+void samples_manager::_clear_samples()
+{
+    m_samples_set.clear();
+    m_samples_order.clear();
+    m_samples_file.reset();
+    m_packed_inputs.clear();
+    m_packed_outputs.clear();
+
+    rewind();
+}
+
+const std::vector<neurocl::sample> samples_manager::get_next_batch( const size_t size ) const
+{
+    const samples_view view = get_next_batch_view( size );
+
+    return std::vector<neurocl::sample>( view.begin(), view.end() );
+}
+
+const samples_view samples_manager::get_next_batch_view( const size_t size ) const
 {
     if ( m_end )
-        return std::vector<neurocl::sample>();
+        return samples_view();
 
-    auto begin = m_samples_set.cbegin() + m_batch_index;
-    auto end = begin + size;
+    size_t count = size;
+    const size_t remaining = m_samples_set.size() - m_batch_index;
 
-    if ( end >= m_samples_set.cend() )
+    if ( count >= remaining )
     {
-        end = m_samples_set.cend();
+        count = remaining;
         m_end = true;
     }
-    else
-        m_batch_index += size;
 
-    return std::vector<neurocl::sample>( begin, end );
+    const samples_view view( m_samples_set.data() + m_batch_index, count );
+
+    m_batch_index += count;
+
+    return view;
 }
 
-void samples_manager::rewind() const noexcept
+void samples_manager::rewind() const
 {
     m_end = false;
     m_batch_index = 0;
 }
 
-void samples_manager::shuffle() const noexcept
+void samples_manager::shuffle() const
+{
+    // same engine state and sequence size give the same permutation : samples order follows samples set
+    std::default_random_engine engine( neurocl::random::seed::instance()() );
+    std::default_random_engine order_engine( engine );
+    std::shuffle( std::begin(m_samples_set), std::end(m_samples_set), engine );
+    std::shuffle( std::begin(m_samples_order), std::end(m_samples_order), order_engine );
+
+    if ( m_physical_shuffle )
+        _physical_reorder();
+}
+
+void samples_manager::get_samples_order( std::vector<std::uint32_t>& order ) const
+{
+    order.assign( m_samples_order.begin(), m_samples_order.end() );
+}
+
+void samples_manager::set_samples_order( const std::vector<std::uint32_t>& order ) const
+{
+    if ( order.size() != m_samples_set.size() )
+        throw network_exception( "samples order does not match loaded samples set" );
+
+    // current position of each loaded sample
+    std::vector<std::uint32_t> positions( m_samples_order.size() );
+    for ( size_t i=0; i<m_samples_order.size(); i++ )
+        positions[m_samples_order[i]] = static_cast<std::uint32_t>( i );
+
+    std::vector<neurocl::sample> samples_set;
+    samples_set.reserve( m_samples_set.size() );
+    for ( const auto& index : order )
+    {
+        if ( index >= positions.size() )
+            throw network_exception( "invalid samples order" );
+
+        samples_set.push_back( m_samples_set[positions[index]] );
+    }
+
+    m_samples_set.swap( samples_set );
+    m_samples_order = order;
+
+    if ( m_physical_shuffle )
+        _physical_reorder();
+
+    rewind();
+}
+
+void samples_manager::_reset_samples_order()
+{
+    m_samples_order.resize( m_samples_set.size() );
+    std::iota( m_samples_order.begin(), m_samples_order.end(), 0 );
+}
+
+void samples_manager::set_physical_shuffle( bool physical_shuffle )
+{
+    m_physical_shuffle = physical_shuffle;
+
+    if ( m_physical_shuffle )
+        _pack_samples();
+}
+
+void samples_manager::_pack_samples()
+{
+    if ( m_samples_set.empty() )
+        return;
+
+    _physical_reorder();
+
+    // samples now only point into the packed storage
+    m_samples_file.reset();
+}
+
+void samples_manager::_physical_reorder() const
 {
-    std::shuffle( std::begin(m_samples_set), std::end(m_samples_set), std::default_random_engine( neurocl::random::seed::instance()() ) );
+    if ( m_samples_set.empty() )
+        return;
+
+    // uniform samples sizes are guaranteed by the loaders (load_samples checks output sizes, binary files headers give them)
+    const size_t isample_size = m_samples_set.front().isample_size;
+    const size_t osample_size = m_samples_set.front().osample_size;
+
+    m_reorder_inputs.resize( m_samples_set.size() * isample_size );
+    m_reorder_outputs.resize( m_samples_set.size() * osample_size );
+
+    float* _input = m_reorder_inputs.data();
+    float* _output = m_reorder_outputs.data();
+
+    for ( auto& s : m_samples_set )
+    {
+        std::copy( s.isample, s.isample + isample_size, _input );
+        std::copy( s.osample, s.osample + osample_size, _output );
+        s.isample = _input;
+        s.osample = _output;
+        _input += isample_size;
+        _output += osample_size;
+    }
+
+    // swapping keeps buffers addresses : samples now point into the packed storage
+    m_packed_inputs.swap( m_reorder_inputs );
+    m_packed_outputs.swap( m_reorder_outputs );
 }
 
 void samples_manager::_assert_sample_size() const
@@ -194,7 +424,8 @@ std::shared_ptr<samples_augmenter> samples_manager::get_augmenter() const
     return m_augmenter;
 }
 
-cimg_library::CImg<float> g_buf_img{}; // TODO : not very clean :-(
+// per thread augmentation buffer : augmented samples are valid until next augmentation in the same thread
+static thread_local cimg_library::CImg<float> t_buf_img{};
 
 samples_augmenter::samples_augmenter( const int sizeX, const int sizeY ) : m_sizeX( sizeX ), m_sizeY( sizeY )
 {
@@ -212,19 +443,19 @@ int samples_augmenter::rand_shift()
 
 neurocl::sample samples_augmenter::noise( const neurocl::sample& s, const float sigma ) const
 {
-	g_buf_img.assign( s.isample, m_sizeX, m_sizeY, 1, 1, false );
-	g_buf_img.noise( sigma, 0 ); // gaussian
+	t_buf_img.assign( s.isample, m_sizeX, m_sizeY, 1, 1, false );
+	t_buf_img.noise( sigma, 0 ); // gaussian
 
-	return neurocl::sample( m_sizeX * m_sizeY, g_buf_img.data(), s.osample_size, s.osample );
+	return neurocl::sample( m_sizeX * m_sizeY, t_buf_img.data(), s.osample_size, s.osample );
 }
 
 neurocl::sample samples_augmenter::rotate( const neurocl::sample& s, const float angle ) const
 {
-	g_buf_img.assign( s.isample, m_sizeX, m_sizeY, 1, 1, false );
-	g_buf_img.rotate( angle );
-	g_buf_img.resize( m_sizeX, m_sizeY ); // rotate does not guarantee size conservation, cf. CImg documentation
+	t_buf_img.assign( s.isample, m_sizeX, m_sizeY, 1, 1, false );
+	t_buf_img.rotate( angle );
+	t_buf_img.resize( m_sizeX, m_sizeY ); // rotate does not guarantee size conservation, cf. CImg documentation
 
-	return neurocl::sample( m_sizeX * m_sizeY, g_buf_img.data(), s.osample_size, s.osample );
+	return neurocl::sample( m_sizeX * m_sizeY, t_buf_img.data(), s.osample_size, s.osample );
 }
 
 neurocl::sample samples_augmenter::translate( const neurocl::sample& s, const int sx, const int sy ) const
@@ -232,23 +463,23 @@ neurocl::sample samples_augmenter::translate( const neurocl::sample& s, const in
     if ( ( sx > 2 ) || ( sy > 2 ) )
         throw network_exception( "no translation over 2px manageed yet" );
 
-	g_buf_img.assign( s.isample, m_sizeX, m_sizeY, 1, 1, false );
-    g_buf_img.resize( m_sizeX+4, m_sizeY+4, -100, -100, 0, 0, 0.5f, 0.5f );
+	t_buf_img.assign( s.isample, m_sizeX, m_sizeY, 1, 1, false );
+    t_buf_img.resize( m_sizeX+4, m_sizeY+4, -100, -100, 0, 0, 0.5f, 0.5f );
     int startX = 2 + sx;
     int startY = 2 + sy;
-    g_buf_img.crop( startX, startY, startX + m_sizeX, startY + m_sizeY );
+    t_buf_img.crop( startX, startY, startX + m_sizeX, startY + m_sizeY );
 
-	return neurocl::sample( m_sizeX * m_sizeY, g_buf_img.data(), s.osample_size, s.osample );
+	return neurocl::sample( m_sizeX * m_sizeY, t_buf_img.data(), s.osample_size, s.osample );
 }
 
 neurocl::sample samples_augmenter::zoom( const neurocl::sample& s, const int zx ) const
 {
     // NOT VALIDATED YET!!
 
-    g_buf_img.assign( s.isample, m_sizeX, m_sizeY, 1, 1, false );
-    g_buf_img.crop( zx, zx, m_sizeX-zx, m_sizeY-zx ).resize( m_sizeX, m_sizeY );
+    t_buf_img.assign( s.isample, m_sizeX, m_sizeY, 1, 1, false );
+    t_buf_img.crop( zx, zx, m_sizeX-zx, m_sizeY-zx ).resize( m_sizeX, m_sizeY );
 
-    return neurocl::sample( m_sizeX * m_sizeY, g_buf_img.data(), s.osample_size, s.osample );
+    return neurocl::sample( m_sizeX * m_sizeY, t_buf_img.data(), s.osample_size, s.osample );
 }
 
 /******************************************************/
@@ -273,73 +504,97 @@ void samples_manager::load_kaggle_digit_recognizer( const std::string &input_fil
     }
 
     // clear previous samples
-    m_input_samples.clear();
-    m_output_samples.clear();
-    m_samples_set.clear();
+    _clear_samples();
 
-    std::string line;
+    // read whole file, and index lines
+    const std::string data{ std::istreambuf_iterator<char>( data_in ), std::istreambuf_iterator<char>() };
+
+    std::vector<std::pair<const char*,const char*>> lines;
+
+    const char* _end = data.data() + data.size();
+    const char* _line = data.data();
 
     // get first ignored line : labels etc...
-    std::getline( data_in, line ); // comment this for emnist!!
+    _line = std::find( _line, _end, '\n' ); // comment this for emnist!!
 
-    while ( std::getline( data_in, line ) )
+    while ( ( _line != _end ) && ( ( m_restrict_size == 0 ) || ( lines.size() < m_restrict_size ) ) )
     {
-        std::stringstream ss{ line };
+        const char* _begin = ( *_line == '\n' ) ? _line + 1 : _line;
+        _line = std::find( _begin, _end, '\n' );
 
-        // Read the target values from the line:
-        std::vector<std::uint8_t> _vals;
-        while ( !ss.eof() )
-        {
-            std::uint16_t val;
-            if ( !(ss >> val).fail() )
-                _vals.push_back( static_cast<std::uint8_t>( val ) );
-        }
+        // skip blank lines
+        if ( std::find_if( _begin, _line, []( const char c ){ return ( c >= '0' ) && ( c <= '9' ); } ) != _line )
+            lines.emplace_back( _begin, _line );
+    }
 
-        int digit = _vals.at(0);
-        size_t input_size = _vals.size()-1;
-        size_t square_size = std::sqrt( input_size );
+    if ( lines.empty() )
+        return;
 
-        // preprocess and save input image
-        cimg_library::CImg<unsigned char> img_uchar( _vals.data(), square_size, square_size, 1, 1, true /*shared*/ );
-        cimg_library::CImg<float> img( img_uchar );
-        img.normalize( 0.f, 1.f );
+    // first line gives samples size : label followed by square image pixels
+    size_t input_size = 0;
+    {
+        std::uint32_t val;
+        bool parsed;
+        for ( const char* p = _parse_uint( lines.front().first, lines.front().second, val, parsed );
+            parsed; p = _parse_uint( p, lines.front().second, val, parsed ) )
+            input_size++;
+        input_size--;
+    }
 
-        // TODO-CNN : lot of this method's blocks could be factorized...
-        if ( !m_sample_sizeX && !m_sample_sizeY )
-        {
-            m_sample_sizeX = static_cast<std::size_t>( img.width() );
-            m_sample_sizeY = static_cast<std::size_t>( img.height() );
+    const size_t square_size = std::sqrt( input_size );
+    if ( !input_size || ( square_size * square_size != input_size ) )
+        throw network_exception( "non square kaggle digit recognizer samples" );
 
-            m_augmenter = std::make_shared<samples_augmenter>( m_sample_sizeX, m_sample_sizeY );
-        }
-        else
+    m_sample_sizeX = m_sample_sizeY = square_size;
+    m_augmenter = std::make_shared<samples_augmenter>( m_sample_sizeX, m_sample_sizeY );
+
+    const size_t output_size = 10; // 62 for emnist!!
+
+    // parse and preprocess rows in parallel, directly in the contiguous samples storage
+    m_packed_inputs.resize( lines.size() * input_size );
+    m_packed_outputs.assign( lines.size() * output_size, 0.f );
+
+    _parallel_chunks( lines.size(), [&]( const size_t begin, const size_t end )
+    {
+        for ( size_t i=begin; i<end; i++ )
         {
-            if ( ( m_sample_sizeX != static_cast<std::size_t>( img.width() ) ) ||
-                ( m_sample_sizeY != static_cast<std::size_t>( img.height() ) ) )
+            float* input = m_packed_inputs.data() + i * input_size;
+
+            std::uint32_t val;
+            bool parsed;
+            const char* p = _parse_uint( lines[i].first, lines[i].second, val, parsed );
+
+            const std::uint32_t digit = val;
+            if ( digit >= output_size )
+                throw network_exception( "invalid kaggle digit recognizer label" );
+
+            size_t n = 0;
+            for ( p = _parse_uint( p, lines[i].second, val, parsed ); parsed; p = _parse_uint( p, lines[i].second, val, parsed ) )
+            {
+                if ( n == input_size )
+                    throw network_exception( "non uniform sample size in input sample set" );
+                input[n++] = static_cast<float>( static_cast<std::uint8_t>( val ) );
+            }
+            if ( n != input_size )
                 throw network_exception( "non uniform sample size in input sample set" );
-        }
-
-        // store input sample in list
-        boost::shared_array<float> input_sample( new float[input_size] );
-        std::copy( img.data(), img.data()+input_size, input_sample.get() );
-        m_input_samples.push_back( input_sample );
 
-        // store output sample in list
-        int i = 0;
-        size_t output_size = 10; // 62 for emnist!!
-        boost::shared_array<float> output_sample{ new float[output_size] };
-        std::for_each( output_sample.get(), output_sample.get()+output_size, [&i,&digit](float& a){ a = ( i++ == digit ) ? 1.f : 0.f; } );
-        m_output_samples.push_back( output_sample );
+            cimg_library::CImg<float> img( input, square_size, square_size, 1, 1, true /*shared*/ );
+            img.normalize( 0.f, 1.f );
 
-        // store new sample
-        m_samples_set.push_back( neurocl::sample( input_size, m_input_samples.back().get(), output_size, m_output_samples.back().get() ) );
+            m_packed_outputs[i * output_size + digit] = 1.f;
+        }
+    } );
 
-        // manage restricted size
-        if ( m_restrict_size == m_samples_set.size() )
-            break;
-    }
+    for ( size_t i=0; i<lines.size(); i++ )
+        m_samples_set.push_back( neurocl::sample(   input_size, m_packed_inputs.data() + i * input_size,
+                                                    output_size, m_packed_outputs.data() + i * output_size ) );
 
     LOGGER(info) << "samples_manager::load_kaggle_digit_recognizer - successfully loaded " << m_samples_set.size() << " samples" << std::endl;
+
+    _reset_samples_order();
+
+    if ( m_physical_shuffle )
+        _pack_samples();
 }
 
 } //namespace neurocl
@@ -29,15 +29,18 @@ THE SOFTWARE.
 
 #include "network_sample.h"
 
-#include <boost/shared_array.hpp>
-
+#include <cstdint>
 #include <functional>
 #include <vector>
 
 namespace neurocl {
 
+class samples_file;
+
 using t_preproc = std::function<void (float*,const size_t,const size_t)>;
 
+// NOTE : augmented samples point into a per thread buffer, valid until next augmentation
+// in the same thread (cf. augmentation_pipeline.h for in place batch augmentation)
 class NEUROCL_PUBLIC samples_augmenter
 {
 public:
@@ -64,7 +67,7 @@ class NEUROCL_PUBLIC samples_manager
 {
 public:
 
-    samples_manager() : m_end( false ), m_batch_index( 0 ), m_restrict_size( 0 ), m_sample_sizeX( 0 ), m_sample_sizeY( 0 ) {}
+    samples_manager() : m_end( false ), m_batch_index( 0 ), m_restrict_size( 0 ), m_physical_shuffle( false ), m_sample_sizeX( 0 ), m_sample_sizeY( 0 ) {}
     virtual ~samples_manager() {}
 
     void restrict_dataset( const size_t size )
@@ -72,11 +75,17 @@ public:
         m_restrict_size = size;
     }
 
-    //! load all training samples
+    //! load all training samples (images are decoded in parallel, extra_preproc must be reentrant)
     void load_samples( const std::string& input_filename, bool shuffle = false, t_preproc extra_preproc = t_preproc() );
 
+    //! load all training samples from a memory mapped binary samples file (cf. samples_file.h)
+    void load_binary_samples( const std::string& input_filename, bool shuffle = false );
+
+    //! save loaded samples to a binary samples file, inputs being optionally quantized to 8 bits
+    void save_binary_samples( const std::string& output_filename, bool uint8_inputs = false ) const;
+
     //! get number of loaded samples
-    const size_t samples_size() const
+    virtual const size_t samples_size() const
     {
         return m_samples_set.size();
     }
@@ -87,14 +96,30 @@ public:
         return m_samples_set;
     }
 
+    //! enable shuffling by physical reorder : samples data is packed, and rewritten in shuffled order at
+    //! each shuffle so that mini-batches read contiguous memory (NOTE : invalidates previous samples pointers)
+    void set_physical_shuffle( bool physical_shuffle );
+
     //! get samples mini-batch
-    const std::vector<neurocl::sample> get_next_batch( const size_t size ) const noexcept;
+    const std::vector<neurocl::sample> get_next_batch( const size_t size ) const;
+
+    //! get samples mini-batch view, without copy (valid until next batch, shuffle or load)
+    virtual const samples_view get_next_batch_view( const size_t size ) const;
 
     //! rewind sample "cursor"
-    void rewind() const noexcept;
+    virtual void rewind() const;
 
     //! shuffle samples list
-    void shuffle() const noexcept;
+    virtual void shuffle() const;
+
+    //! get current samples order, as indices in loading order (training checkpoints)
+    virtual void get_samples_order( std::vector<std::uint32_t>& order ) const;
+    //! restore samples order returned by get_samples_order, and rewind
+    virtual void set_samples_order( const std::vector<std::uint32_t>& order ) const;
+
+    //! get samples 2D size (null if no sample set loaded)
+    size_t sample_sizeX() const { return m_sample_sizeX; }
+    size_t sample_sizeY() const { return m_sample_sizeY; }
 
 	//! get data augmenter
     std::shared_ptr<samples_augmenter> get_augmenter() const;
@@ -106,22 +131,36 @@ public:
     //! load all kaggle digit recognizer formatted training samples (https://www.kaggle.com/c/digit-recognizer)
     void load_kaggle_digit_recognizer( const std::string& input_filename );
 
-private:
+protected:
 
 	void _assert_sample_size() const;
+	void _clear_samples();
+	void _pack_samples();
+	void _physical_reorder() const;
+	void _reset_samples_order();
 
-private:
+protected:
 
     mutable bool m_end;
     mutable size_t m_batch_index;
     size_t m_restrict_size;
+    bool m_physical_shuffle;
 
     size_t m_sample_sizeX;
     size_t m_sample_sizeY;
 
-    std::vector< boost::shared_array<float> > m_input_samples;
-    std::vector< boost::shared_array<float> > m_output_samples;
     mutable std::vector<neurocl::sample> m_samples_set;
+    // loading index of each sample in current samples set order
+    mutable std::vector<std::uint32_t> m_samples_order;
+
+    // memory mapped samples storage, if loaded from binary samples file
+    std::shared_ptr<samples_file> m_samples_file;
+
+    // contiguous samples storage (double buffered for physical shuffle reordering)
+    mutable std::vector<float> m_packed_inputs;
+    mutable std::vector<float> m_packed_outputs;
+    mutable std::vector<float> m_reorder_inputs;
+    mutable std::vector<float> m_reorder_outputs;
 
 	std::shared_ptr<samples_augmenter> m_augmenter;
 };
@@ -0,0 +1,320 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "samples_streamer.h"
+#include "network_random.h"
+#include "network_exception.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace neurocl {
+
+// number of samples read from disk at once
+static const size_t s_read_chunk = 256;
+
+samples_streamer::samples_streamer( const std::vector<std::string>& shard_filenames,
+                                    const size_t shuffle_window,
+                                    const size_t read_ahead )
+    : m_shard_filenames( shard_filenames ), m_input_size( 0 ), m_output_size( 0 ), m_total_size( 0 ),
+    m_shuffle_window( std::max<size_t>( shuffle_window, 1 ) ), m_read_ahead( std::max<size_t>( read_ahead, 1 ) ),
+    m_reader_done( true ), m_reader_stop( false ), m_rng( neurocl::random::seed::instance()() )
+{
+    if ( m_shard_filenames.empty() )
+        throw network_exception( "no samples shard to stream" );
+
+    for ( const auto& filename : m_shard_filenames )
+    {
+        const samples_file_header header = samples_file::read_header( filename );
+
+        if ( m_shard_headers.empty() )
+        {
+            m_sample_sizeX = header.size_x;
+            m_sample_sizeY = header.size_y;
+            m_input_size = header.input_size;
+            m_output_size = header.output_size;
+        }
+        else if ( ( header.size_x != m_sample_sizeX ) || ( header.size_y != m_sample_sizeY ) ||
+            ( header.input_size != m_input_size ) || ( header.output_size != m_output_size ) )
+        {
+            LOGGER(error) << "samples_streamer::samples_streamer - shard \'" << filename << "\' samples size does not match previous shards" << std::endl;
+            throw network_exception( "non uniform sample size in streamed shards" );
+        }
+
+        m_shard_headers.push_back( header );
+        m_total_size += header.samples_count;
+    }
+
+    m_shards_order.resize( m_shard_headers.size() );
+    std::iota( m_shards_order.begin(), m_shards_order.end(), 0 );
+
+    if ( m_sample_sizeX && m_sample_sizeY )
+        m_augmenter = std::make_shared<samples_augmenter>( m_sample_sizeX, m_sample_sizeY );
+
+    LOGGER(info) << "samples_streamer::samples_streamer - streaming " << m_total_size << " samples from " << m_shard_headers.size() << " shard(s)" << std::endl;
+}
+
+samples_streamer::~samples_streamer()
+{
+    _stop_reader();
+}
+
+const size_t samples_streamer::samples_size() const
+{
+    return m_restrict_size ? std::min( m_restrict_size, m_total_size ) : m_total_size;
+}
+
+const samples_view samples_streamer::get_next_batch_view( const size_t size ) const
+{
+    if ( m_end )
+        return samples_view();
+
+    if ( !m_reader.joinable() )
+        _start_reader();
+
+    // previous batch samples are released here
+    m_batch.clear();
+    m_batch_samples.clear();
+
+    t_record record;
+    while ( m_batch.size() < size )
+    {
+        // keep shuffle window full while stream is not exhausted
+        while ( ( m_window.size() < m_shuffle_window ) && _pop_record( record ) )
+            m_window.push_back( std::move( record ) );
+
+        if ( m_window.empty() )
+        {
+            m_end = true;
+            break;
+        }
+
+        std::uniform_int_distribution<size_t> pick( 0, m_window.size() - 1 );
+        const size_t index = pick( m_rng );
+
+        m_batch.push_back( std::move( m_window[index] ) );
+        m_window[index] = std::move( m_window.back() );
+        m_window.pop_back();
+    }
+
+    for ( const auto& _record : m_batch )
+        m_batch_samples.emplace_back( m_input_size, _record.data(), m_output_size, _record.data() + m_input_size );
+
+    return samples_view( m_batch_samples );
+}
+
+void samples_streamer::rewind() const
+{
+    _stop_reader();
+
+    m_queue.clear();
+    m_window.clear();
+    m_end = false;
+
+    // reader failure not yet reported to the consumer
+    if ( m_reader_error )
+    {
+        std::exception_ptr error = m_reader_error;
+        m_reader_error = nullptr;
+        std::rethrow_exception( error );
+    }
+}
+
+void samples_streamer::shuffle() const
+{
+    std::shuffle( m_shards_order.begin(), m_shards_order.end(), m_rng );
+}
+
+void samples_streamer::get_samples_order( std::vector<std::uint32_t>& order ) const
+{
+    std::stringstream rng_state;
+    rng_state << m_rng;
+
+    std::uint32_t state = 0;
+    rng_state >> state;
+
+    // shards order followed by shuffling engine state
+    order.assign( m_shards_order.begin(), m_shards_order.end() );
+    order.push_back( state );
+}
+
+void samples_streamer::set_samples_order( const std::vector<std::uint32_t>& order ) const
+{
+    if ( order.size() != ( m_shard_headers.size() + 1 ) )
+        throw network_exception( "samples order does not match streamed shards" );
+
+    std::vector<size_t> shards_order( order.begin(), order.end() - 1 );
+
+    std::vector<bool> found( m_shard_headers.size(), false );
+    for ( const auto& shard : shards_order )
+    {
+        if ( ( shard >= found.size() ) || found[shard] )
+            throw network_exception( "invalid samples order" );
+
+        found[shard] = true;
+    }
+
+    std::stringstream rng_state;
+    rng_state << order.back();
+
+    std::minstd_rand rng;
+    rng_state >> rng;
+    if ( !rng_state )
+        throw network_exception( "invalid samples order" );
+
+    rewind();
+
+    m_shards_order.swap( shards_order );
+    m_rng = rng;
+}
+
+void samples_streamer::_start_reader() const
+{
+    m_reader_done = false;
+    m_reader_stop = false;
+    m_reader_error = nullptr;
+
+    m_reader = std::thread( &samples_streamer::_read_shards, this, m_shards_order, samples_size() );
+}
+
+void samples_streamer::_stop_reader() const noexcept
+{
+    if ( !m_reader.joinable() )
+        return;
+
+    // scoped lock
+    {
+        std::lock_guard<std::mutex> lock( m_queue_mutex );
+        m_reader_stop = true;
+    }
+    m_queue_cond.notify_all();
+
+    m_reader.join();
+}
+
+void samples_streamer::_read_shards( const std::vector<size_t> shards_order, const size_t max_records ) const
+{
+    size_t records = 0;
+
+    try
+    {
+        std::vector<float> inputs( s_read_chunk * m_input_size );
+        std::vector<float> outputs( s_read_chunk * m_output_size );
+
+        for ( const auto& shard : shards_order )
+        {
+            const samples_file_header& header = m_shard_headers[shard];
+
+            // inputs and outputs blocks are read sequentially through separate streams
+            std::ifstream inputs_in( m_shard_filenames[shard], std::ios::in | std::ios::binary );
+            std::ifstream outputs_in( m_shard_filenames[shard], std::ios::in | std::ios::binary );
+            if ( !inputs_in.is_open() || !outputs_in.is_open() )
+                throw network_exception( "error opening streamed samples shard" );
+
+            inputs_in.seekg( header.inputs_offset );
+            outputs_in.seekg( header.outputs_offset );
+
+            size_t shard_remaining = header.samples_count;
+            while ( shard_remaining && ( records < max_records ) )
+            {
+                const size_t chunk = std::min( { s_read_chunk, shard_remaining, max_records - records } );
+
+                samples_file::read_inputs( inputs_in, header, chunk, inputs.data() );
+                outputs_in.read( reinterpret_cast<char*>( outputs.data() ), chunk * m_output_size * sizeof( float ) );
+                if ( !outputs_in )
+                    throw network_exception( "error reading binary samples file outputs" );
+
+                for ( size_t i=0; i<chunk; i++ )
+                {
+                    t_record record( m_input_size + m_output_size );
+                    std::copy( inputs.begin() + i * m_input_size, inputs.begin() + ( i + 1 ) * m_input_size, record.begin() );
+                    std::copy( outputs.begin() + i * m_output_size, outputs.begin() + ( i + 1 ) * m_output_size, record.begin() + m_input_size );
+
+                    std::unique_lock<std::mutex> lock( m_queue_mutex );
+                    m_queue_cond.wait( lock, [this]{ return ( m_queue.size() < m_read_ahead ) || m_reader_stop; } );
+
+                    if ( m_reader_stop )
+                        return;
+
+                    m_queue.push_back( std::move( record ) );
+                    lock.unlock();
+                    m_queue_cond.notify_all();
+                }
+
+                shard_remaining -= chunk;
+                records += chunk;
+            }
+        }
+    }
+    catch( network_exception& e )
+    {
+        LOGGER(error) << "samples_streamer::_read_shards - streaming aborted after " << records << " samples : " << e.what() << std::endl;
+
+        std::lock_guard<std::mutex> lock( m_queue_mutex );
+        m_reader_error = std::current_exception();
+    }
+    catch(...)
+    {
+        std::lock_guard<std::mutex> lock( m_queue_mutex );
+        m_reader_error = std::current_exception();
+    }
+
+    // scoped lock
+    {
+        std::lock_guard<std::mutex> lock( m_queue_mutex );
+        m_reader_done = true;
+    }
+    m_queue_cond.notify_all();
+}
+
+bool samples_streamer::_pop_record( t_record& record ) const
+{
+    std::unique_lock<std::mutex> lock( m_queue_mutex );
+    m_queue_cond.wait( lock, [this]{ return !m_queue.empty() || m_reader_done; } );
+
+    if ( m_queue.empty() )
+    {
+        // reader failure is reported once all previously read samples are consumed
+        if ( m_reader_error )
+        {
+            std::exception_ptr error = m_reader_error;
+            m_reader_error = nullptr;
+            std::rethrow_exception( error );
+        }
+
+        return false;
+    }
+
+    record = std::move( m_queue.front() );
+    m_queue.pop_front();
+    lock.unlock();
+    m_queue_cond.notify_all();
+
+    return true;
+}
+
+} //namespace neurocl
@@ -0,0 +1,120 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef SAMPLES_STREAMER_H
+#define SAMPLES_STREAMER_H
+
+#include "samples_manager.h"
+#include "samples_file.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace neurocl {
+
+/**
+ *  Out-of-core samples manager : streams binary samples files shards (cf. samples_file.h)
+ *  sequentially from disk through a bounded read-ahead queue, instead of loading the whole
+ *  dataset in memory. Samples are shuffled inside a bounded window (spanning shards
+ *  boundaries), and shards order is reshuffled at each epoch.
+ *
+ *  Memory usage is bounded by ( read_ahead + shuffle_window + batch size ) samples.
+ *
+ *  Shards reading errors are reported by get_next_batch_view() or rewind().
+ *
+ *  NOTE : no random access is available, get_samples() returns an empty list.
+ */
+class NEUROCL_PUBLIC samples_streamer final : public samples_manager
+{
+public:
+
+    samples_streamer(   const std::vector<std::string>& shard_filenames,
+                        const size_t shuffle_window = 1024,
+                        const size_t read_ahead = 4096 );
+    virtual ~samples_streamer();
+
+    //! get total number of streamed samples per epoch
+    const size_t samples_size() const override;
+
+    //! get next samples mini-batch view, valid until next call
+    const samples_view get_next_batch_view( const size_t size ) const override;
+
+    //! rewind streaming to first shard
+    void rewind() const override;
+
+    //! shuffle shards order for next epoch
+    void shuffle() const override;
+
+    //! get shards order and shuffling state
+    void get_samples_order( std::vector<std::uint32_t>& order ) const override;
+    //! restore shards order and shuffling state returned by get_samples_order, and rewind
+    void set_samples_order( const std::vector<std::uint32_t>& order ) const override;
+
+private:
+
+    // sample storage : input values followed by output values
+    using t_record = std::vector<float>;
+
+    void _start_reader() const;
+    void _stop_reader() const noexcept;
+    void _read_shards( const std::vector<size_t> shards_order, const size_t max_records ) const;
+    bool _pop_record( t_record& record ) const;
+
+private:
+
+    std::vector<std::string> m_shard_filenames;
+    std::vector<samples_file_header> m_shard_headers;
+    mutable std::vector<size_t> m_shards_order;
+
+    size_t m_input_size;
+    size_t m_output_size;
+    size_t m_total_size;
+
+    const size_t m_shuffle_window;
+    const size_t m_read_ahead;
+
+    // read-ahead queue, filled by the reader thread
+    mutable std::thread m_reader;
+    mutable std::mutex m_queue_mutex;
+    mutable std::condition_variable m_queue_cond;
+    mutable std::deque<t_record> m_queue;
+    mutable bool m_reader_done;
+    mutable bool m_reader_stop;
+    mutable std::exception_ptr m_reader_error;
+
+    // shuffle window and current batch storage, only accessed by the consumer
+    mutable std::vector<t_record> m_window;
+    mutable std::vector<t_record> m_batch;
+    mutable std::vector<neurocl::sample> m_batch_samples;
+    // minimal standard engine : its whole state is a single value, stored in checkpoints
+    mutable std::minstd_rand m_rng;
+};
+
+} //namespace neurocl
+
+#endif //SAMPLES_STREAMER_H
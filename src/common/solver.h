@@ -60,6 +60,13 @@ public:
     //! set learning rate (scheduled learning)
     virtual void set_learning_rate( const float new_rate ) = 0;
 
+    //! get training state scalars size (checkpointing)
+    virtual size_t get_state_size() { return 1; }
+    //! get training state scalars, only the learning rate evolves by default
+    virtual void get_state( float* state ) { state[0] = get_learning_rate(); }
+    //! restore training state scalars
+    virtual void set_state( const float* state ) { set_learning_rate( state[0] ); }
+
     //! get parameters parsing map
     using t_parameters_map = std::map<const std::string,std::reference_wrapper<float>>;
     t_parameters_map& get_parameters_map()
@@ -376,6 +383,10 @@ public:
     void set_learning_rate( const float new_rate ) override { m_alpha = new_rate; }
     size_t get_cache_size() override { return 2; }
 
+    size_t get_state_size() override { return 3; }
+    void get_state( float* state ) override { state[0] = m_alpha; state[1] = m_mu1_exp; state[2] = m_mu2_exp; }
+    void set_state( const float* state ) override { m_alpha = state[0]; m_mu1_exp = state[1]; m_mu2_exp = state[2]; }
+
 private:
 
     float m_mu1;        // decay term1
@@ -430,8 +441,7 @@ public:
         T _ngrad = m_normalize_grad * gradient;
 
         input_momentum1 = m_mu1 * input_momentum1 + ( 1.f - m_mu1 ) * _ngrad;
-        input_momentum2 = operatorF::binary_operator( input_momentum2, _ngrad,
-            [this](const float& a,const float& b){ return std::max( m_mu2 * a, std::abs( b ) ); } );
+        input_momentum2 = operatorF::decayed_max_abs( input_momentum2, _ngrad, m_mu2 );
 
         float _alpha = m_alpha / ( 1.f - m_mu1_exp );
 
@@ -450,6 +460,10 @@ public:
     void set_learning_rate( const float new_rate ) override { m_alpha = new_rate; }
     size_t get_cache_size() override { return 2; }
 
+    size_t get_state_size() override { return 2; }
+    void get_state( float* state ) override { state[0] = m_alpha; state[1] = m_mu1_exp; }
+    void set_state( const float* state ) override { m_alpha = state[0]; m_mu1_exp = state[1]; }
+
 private:
 
     float m_mu1;        // decay term1
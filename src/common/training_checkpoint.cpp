@@ -0,0 +1,329 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "training_checkpoint.h"
+#include "network_exception.h"
+#include "logger.h"
+
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem.hpp>
+namespace bfs = boost::filesystem;
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace neurocl {
+
+static const char s_checkpoint_file_magic[8] = { 'N', 'E', 'U', 'R', 'O', 'C', 'L', 'C' };
+static const std::uint32_t s_checkpoint_file_version = 1;
+
+namespace be = boost::endian;
+
+static const bool s_little_endian_host = ( be::order::native == be::order::little );
+
+// 32 bits values arrays (float32 or uint32) little endian serialization
+template<typename T>
+static void _write_values( std::ostream& data_out, const T* values, const size_t count )
+{
+    static_assert( sizeof( T ) == sizeof( std::uint32_t ), "32 bits values expected" );
+
+    if ( s_little_endian_host )
+        data_out.write( reinterpret_cast<const char*>( values ), count * sizeof( T ) );
+    else
+        for ( size_t i=0; i<count; i++ )
+        {
+            std::uint32_t value;
+            std::memcpy( &value, values + i, sizeof( T ) );
+            be::native_to_little_inplace( value );
+            data_out.write( reinterpret_cast<const char*>( &value ), sizeof( value ) );
+        }
+}
+
+// flush file (or directory entries) to storage, so that renaming can not expose a partially written file after a crash
+static void _sync_path( const std::string& path, const bool directory )
+{
+#ifdef _WIN32
+    // NTFS directory entries are journaled, only the file content has to be committed
+    if ( directory )
+        return;
+
+    const int fd = _open( path.c_str(), _O_RDONLY | _O_BINARY );
+    const bool synced = ( fd >= 0 ) && ( _commit( fd ) == 0 );
+    if ( fd >= 0 )
+        _close( fd );
+#else
+    const int fd = ::open( path.c_str(), directory ? ( O_RDONLY | O_DIRECTORY ) : O_RDONLY );
+    const bool synced = ( fd >= 0 ) && ( ::fsync( fd ) == 0 );
+    if ( fd >= 0 )
+        ::close( fd );
+#endif
+
+    if ( !synced )
+    {
+        LOGGER(error) << "training_checkpoint::write - error syncing \'" << path << "\'" << std::endl;
+        throw network_exception( "error writing checkpoint file" );
+    }
+}
+
+template<typename T>
+static void _read_values( std::istream& data_in, T* values, const size_t count )
+{
+    static_assert( sizeof( T ) == sizeof( std::uint32_t ), "32 bits values expected" );
+
+    data_in.read( reinterpret_cast<char*>( values ), count * sizeof( T ) );
+
+    if ( !s_little_endian_host )
+        for ( size_t i=0; i<count; i++ )
+            be::endian_reverse_inplace( reinterpret_cast<std::uint32_t&>( values[i] ) );
+}
+
+void training_checkpoint::write( const std::string& filename ) const
+{
+    checkpoint_file_header header;
+    std::memset( &header, 0, sizeof( checkpoint_file_header ) );
+    std::memcpy( header.magic, s_checkpoint_file_magic, sizeof( s_checkpoint_file_magic ) );
+    header.version = be::native_to_little( s_checkpoint_file_version );
+    header.start_seed = be::native_to_little( start_seed );
+    header.epoch = be::native_to_little( epoch );
+    header.seed = be::native_to_little( seed );
+    header.state_size = be::native_to_little( static_cast<std::uint64_t>( state.size() ) );
+    header.order_size = be::native_to_little( static_cast<std::uint64_t>( samples_order.size() ) );
+
+    // written aside and renamed : a crash while writing keeps the previous checkpoint intact
+    const std::string tmp_filename = filename + ".tmp";
+
+    std::ofstream data_out( tmp_filename, std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !data_out || !data_out.is_open() )
+    {
+        LOGGER(error) << "training_checkpoint::write - error opening checkpoint file \'" << tmp_filename << "\'" << std::endl;
+        throw network_exception( "unable to open checkpoint file for saving" );
+    }
+
+    data_out.write( reinterpret_cast<const char*>( &header ), sizeof( checkpoint_file_header ) );
+    _write_values( data_out, state.data(), state.size() );
+    _write_values( data_out, samples_order.data(), samples_order.size() );
+
+    data_out.flush();
+    data_out.close();
+    if ( !data_out )
+        throw network_exception( "error writing checkpoint file" );
+
+    // content has to be on disk before the rename replaces the previous checkpoint
+    _sync_path( tmp_filename, false );
+
+    bfs::rename( tmp_filename, filename );
+
+    // makes the rename itself durable
+    const bfs::path directory = bfs::path( filename ).parent_path();
+    _sync_path( directory.empty() ? std::string( "." ) : directory.string(), true );
+}
+
+bool training_checkpoint::read( const std::string& filename )
+{
+    if ( !bfs::exists( filename ) )
+        return false;
+
+    std::ifstream data_in( filename, std::ios::in | std::ios::binary );
+    if ( !data_in || !data_in.is_open() )
+    {
+        LOGGER(error) << "training_checkpoint::read - error opening checkpoint file \'" << filename << "\'" << std::endl;
+        throw network_exception( "unable to open checkpoint file" );
+    }
+
+    checkpoint_file_header header;
+    data_in.read( reinterpret_cast<char*>( &header ), sizeof( checkpoint_file_header ) );
+
+    if ( !data_in || ( std::memcmp( header.magic, s_checkpoint_file_magic, sizeof( s_checkpoint_file_magic ) ) != 0 ) )
+        throw network_exception( "invalid checkpoint file" );
+    if ( be::little_to_native( header.version ) != s_checkpoint_file_version )
+        throw network_exception( "unmanaged checkpoint file version" );
+
+    const std::uint64_t state_size = be::little_to_native( header.state_size );
+    const std::uint64_t order_size = be::little_to_native( header.order_size );
+
+    if ( bfs::file_size( filename ) != sizeof( checkpoint_file_header ) + ( state_size + order_size ) * sizeof( std::uint32_t ) )
+        throw network_exception( "invalid checkpoint file (inconsistent size)" );
+
+    start_seed = be::little_to_native( header.start_seed );
+    epoch = be::little_to_native( header.epoch );
+    seed = be::little_to_native( header.seed );
+
+    state.resize( state_size );
+    samples_order.resize( order_size );
+    _read_values( data_in, state.data(), state.size() );
+    _read_values( data_in, samples_order.data(), samples_order.size() );
+
+    if ( !data_in )
+        throw network_exception( "error reading checkpoint file" );
+
+    return true;
+}
+
+void training_checkpoint::remove( const std::string& filename )
+{
+    if ( bfs::remove( filename ) )
+        LOGGER(info) << "training_checkpoint::remove - completed training checkpoint \'" << filename << "\' removed" << std::endl;
+}
+
+checkpoint_writer::checkpoint_writer( const std::string& filename )
+    : m_filename( filename ), m_stop( false ), m_superseded( 0 )
+{
+    m_writer = std::thread( &checkpoint_writer::_write, this );
+}
+
+checkpoint_writer::~checkpoint_writer()
+{
+    {
+        std::unique_lock<std::mutex> lock( m_mutex ); // scoped lock
+        m_stop = true;
+    }
+    m_cond.notify_all();
+
+    // writer thread drains pending checkpoint before leaving
+    m_writer.join();
+
+    if ( m_error )
+    {
+        LOGGER(error) << "checkpoint_writer::~checkpoint_writer - last checkpoint could not be written" << std::endl;
+    }
+}
+
+void checkpoint_writer::checkpoint( const t_snapshot_fct& snapshot )
+{
+    arena* _arena = nullptr;
+    arena* _other = nullptr;
+
+    {
+        std::unique_lock<std::mutex> lock( m_mutex ); // scoped lock
+
+        _rethrow();
+
+        // a single writer : at least one arena is never being written
+        _arena = ( m_arenas[0].state == t_arena_state::WRITING ) ? &m_arenas[1] : &m_arenas[0];
+        _other = ( _arena == &m_arenas[0] ) ? &m_arenas[1] : &m_arenas[0];
+
+        // older pending snapshot is superseded
+        if ( ( _arena->state == t_arena_state::PENDING ) || ( _other->state == t_arena_state::PENDING ) )
+            ++m_superseded;
+        if ( _other->state == t_arena_state::PENDING )
+            _other->state = t_arena_state::FREE;
+
+        _arena->state = t_arena_state::FILLING;
+    }
+
+    // arena buffers keep their capacity : no allocation in steady state
+    try
+    {
+        snapshot( _arena->checkpoint );
+    }
+    catch(...)
+    {
+        std::unique_lock<std::mutex> lock( m_mutex ); // scoped lock
+        _arena->state = t_arena_state::FREE;
+        throw;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock( m_mutex ); // scoped lock
+        _arena->state = t_arena_state::PENDING;
+    }
+    m_cond.notify_all();
+}
+
+void checkpoint_writer::flush()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    m_cond.wait( lock, [this]() {
+        return ( m_arenas[0].state == t_arena_state::FREE ) && ( m_arenas[1].state == t_arena_state::FREE );
+    } );
+
+    _rethrow();
+}
+
+void checkpoint_writer::_rethrow()
+{
+    if ( m_error )
+    {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception( error );
+    }
+}
+
+void checkpoint_writer::_write()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    while ( true )
+    {
+        arena* _arena = nullptr;
+
+        m_cond.wait( lock, [this,&_arena]() {
+            for ( auto& a : m_arenas )
+                if ( a.state == t_arena_state::PENDING )
+                    _arena = &a;
+            return ( _arena != nullptr ) || m_stop;
+        } );
+
+        if ( !_arena )
+            break; // stopped and drained
+
+        _arena->state = t_arena_state::WRITING;
+
+        lock.unlock();
+
+        std::exception_ptr error;
+        try
+        {
+            _arena->checkpoint.write( m_filename );
+
+            LOGGER(info) << "checkpoint_writer::_write - epoch " << _arena->checkpoint.epoch << " checkpoint written to \'" << m_filename << "\'" << std::endl;
+        }
+        catch(...)
+        {
+            LOGGER(error) << "checkpoint_writer::_write - error writing checkpoint file \'" << m_filename << "\'" << std::endl;
+            error = std::current_exception();
+        }
+
+        lock.lock();
+
+        if ( error )
+            m_error = error;
+
+        _arena->state = t_arena_state::FREE;
+
+        m_cond.notify_all();
+    }
+}
+
+} //namespace neurocl
@@ -0,0 +1,130 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef TRAINING_CHECKPOINT_H
+#define TRAINING_CHECKPOINT_H
+
+#include "export.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace neurocl {
+
+// Checkpoint file layout (little endian) :
+// header | training state (state_size float32) | samples order (order_size uint32)
+struct checkpoint_file_header
+{
+    char magic[8];              // "NEUROCLC"
+    std::uint32_t version;
+    std::uint32_t start_seed;
+    std::uint64_t epoch;
+    std::uint32_t seed;
+    std::uint32_t reserved;
+    std::uint64_t state_size;
+    std::uint64_t order_size;
+};
+
+// training session snapshot, taken between two epochs
+struct NEUROCL_PUBLIC training_checkpoint
+{
+    std::uint64_t epoch = 0;                    // completed epochs
+    std::uint32_t start_seed = 0;               // random seeds sequence offset at training start
+    std::uint32_t seed = 0;                     // random seeds sequence offset after last epoch
+    std::vector<float> state;                   // network training state (cf. network_interface)
+    std::vector<std::uint32_t> samples_order;   // next epoch samples order (empty if not managed)
+
+    //! write checkpoint aside and rename it : an existing checkpoint file is replaced atomically
+    void write( const std::string& filename ) const;
+    //! read checkpoint file, returns false if it does not exist
+    bool read( const std::string& filename );
+    //! remove checkpoint file of a completed training, if any
+    static void remove( const std::string& filename );
+};
+
+/**
+ *  Asynchronous checkpoints writer : training state is snapshotted in memory into one of two
+ *  preallocated arenas, and written to disk by a background thread while training goes on.
+ *  A pending snapshot not written yet is superseded by a newer one, so that checkpointing
+ *  never waits for the disk.
+ */
+class NEUROCL_PUBLIC checkpoint_writer
+{
+public:
+
+    using t_snapshot_fct = std::function<void(training_checkpoint&)>;
+
+public:
+
+    checkpoint_writer( const std::string& filename );
+    //! pending checkpoint is written before returning
+    virtual ~checkpoint_writer();
+
+    //! fill a free arena with given snapshot function, and queue it for writing
+    void checkpoint( const t_snapshot_fct& snapshot );
+
+    //! wait for queued checkpoints to be written, rethrows writing errors
+    void flush();
+
+    //! number of snapshots superseded before being written
+    size_t superseded() const { return m_superseded; }
+
+private:
+
+    enum class t_arena_state { FREE, FILLING, PENDING, WRITING };
+
+    struct arena
+    {
+        t_arena_state state = t_arena_state::FREE;
+        training_checkpoint checkpoint;
+    };
+
+    void _write();
+    void _rethrow();
+
+private:
+
+    const std::string m_filename;
+
+    std::array<arena,2> m_arenas;
+
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+
+    bool m_stop;
+    size_t m_superseded;
+    std::exception_ptr m_error;
+};
+
+} //namespace neurocl
+
+#endif //TRAINING_CHECKPOINT_H
@@ -0,0 +1,74 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef VEXCL_CONTEXT_H
+#define VEXCL_CONTEXT_H
+
+#include "network_config.h"
+#include "logger.h"
+
+#include <vexcl/vexcl.hpp>
+
+#include <functional>
+
+namespace neurocl {
+
+// VexCL context shared by all vexcl backends
+class my_vex_ctx
+{
+public:
+    static my_vex_ctx& instance() { static my_vex_ctx _ctx; return _ctx; }
+    vex::Context& get() { return m_ctx; }
+protected:
+	my_vex_ctx() : m_ctx( _device_filter() ) {}
+    virtual ~my_vex_ctx() {}
+private:
+    using t_device_filter = std::function<bool(const vex::backend::device&)>;
+    // configured device type (GPU/CPU/ANY), GPU being preferred and falling back
+    // to a CPU OpenCL runtime (such as POCL) if no GPU device is available
+    static t_device_filter _device_filter()
+    {
+        std::string device = "GPU";
+        network_config::instance().update_optional( "vexcl_device", device );
+
+#ifndef VEXCL_BACKEND_CUDA
+        if ( device == "CPU" )
+            return vex::Filter::CPU && vex::Filter::Count(1);
+        else if ( device == "ANY" )
+            return vex::Filter::Any && vex::Filter::Count(1);
+        else if ( vex::backend::device_list( vex::Filter::GPU ).empty() )
+        {
+            LOGGER(warning) << "my_vex_ctx::_device_filter - no GPU device available, falling back to CPU device" << std::endl;
+            return vex::Filter::CPU && vex::Filter::Count(1);
+        }
+#endif
+        return vex::Filter::GPU && vex::Filter::Count(1);
+    }
+private:
+    vex::Context m_ctx;
+};
+
+} /*namespace neurocl*/
+
+#endif //VEXCL_CONTEXT_H
@@ -0,0 +1,455 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "weights_file.h"
+#include "network_config.h"
+#include "network_exception.h"
+#include "logger.h"
+
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem.hpp>
+namespace bfs = boost::filesystem;
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace neurocl {
+
+static const char s_weights_file_magic[8] = { 'N', 'E', 'U', 'R', 'O', 'C', 'L', 'W' };
+
+namespace be = boost::endian;
+
+static const bool s_little_endian_host = ( be::order::native == be::order::little );
+
+weights_file::weights_file( const std::string& filename )
+{
+    namespace bip = boost::interprocess;
+
+    if ( !is_weights_file( filename ) )
+    {
+        LOGGER(error) << "weights_file::weights_file - \'" << filename << "\' is not a versioned weights file" << std::endl;
+        throw network_exception( "invalid weights file" );
+    }
+
+    // read only mapping : pages are shared between processes
+    m_file = bip::file_mapping( filename.c_str(), bip::read_only );
+    m_region = bip::mapped_region( m_file, bip::read_only );
+
+    const char* data = static_cast<const char*>( m_region.get_address() );
+    const std::uint64_t file_size = m_region.get_size();
+
+    weights_file_header header;
+    std::memcpy( &header, data, sizeof( weights_file_header ) );
+    be::little_to_native_inplace( header.version );
+    be::little_to_native_inplace( header.layers_count );
+    be::little_to_native_inplace( header.table_offset );
+
+    // version 1 files have a zeroed (float32) weights format
+    if ( ( header.version == 0 ) || ( header.version > s_version ) )
+        throw network_exception( "unmanaged weights file version" );
+    if ( header.table_offset + header.layers_count * sizeof( weights_file_entry ) > file_size )
+        throw network_exception( "invalid weights file (truncated layers table)" );
+
+    m_entries.resize( header.layers_count );
+    std::memcpy( m_entries.data(), data + header.table_offset, header.layers_count * sizeof( weights_file_entry ) );
+
+    for ( auto& entry : m_entries )
+    {
+        be::little_to_native_inplace( entry.layer_index );
+        be::little_to_native_inplace( entry.format );
+        be::little_to_native_inplace( entry.num_weights );
+        be::little_to_native_inplace( entry.weights_offset );
+        be::little_to_native_inplace( entry.num_bias );
+        be::little_to_native_inplace( entry.bias_offset );
+
+        if ( ( ( entry.format & ~s_sparse_flag ) > static_cast<std::uint32_t>( half_format::BF16 ) ) && ( entry.format != s_int8_format ) )
+            throw network_exception( "invalid weights file (unknown weights format)" );
+
+        const size_t weights_size = _element_size( entry.format );
+
+        // int8 weights are preceded by their quantization parameters, sparse weights by their bitmap
+        std::uint64_t weights_header = 0;
+        std::uint64_t weights_count = entry.num_weights;
+        if ( entry.format == s_int8_format )
+        {
+            if ( entry.weights_offset + _quantization_header_size( 0 ) > file_size )
+                throw network_exception( "invalid weights file (inconsistent blocks)" );
+
+            std::uint32_t channels;
+            std::memcpy( &channels, data + entry.weights_offset, sizeof( std::uint32_t ) );
+            weights_header = _quantization_header_size( be::little_to_native( channels ) );
+        }
+        else if ( entry.format & s_sparse_flag )
+        {
+            if ( entry.weights_offset + _sparse_header_size( entry.num_weights ) > file_size )
+                throw network_exception( "invalid weights file (inconsistent blocks)" );
+
+            std::memcpy( &weights_count, data + entry.weights_offset, sizeof( std::uint64_t ) );
+            be::little_to_native_inplace( weights_count );
+            weights_header = _sparse_header_size( entry.num_weights );
+
+            if ( weights_count > entry.num_weights )
+                throw network_exception( "invalid weights file (inconsistent sparse weights)" );
+        }
+
+        if ( ( entry.weights_offset + weights_header + weights_count * weights_size > file_size ) ||
+            ( entry.bias_offset + entry.num_bias * sizeof( float ) > file_size ) ||
+            ( entry.weights_offset % weights_size ) || ( entry.bias_offset % sizeof( float ) ) )
+            throw network_exception( "invalid weights file (inconsistent blocks)" );
+    }
+
+    // parameters cannot be used in place on big endian hosts
+    if ( !s_little_endian_host )
+    {
+        m_swapped.resize( file_size / sizeof( float ) );
+        std::memcpy( m_swapped.data(), data, m_swapped.size() * sizeof( float ) );
+        for ( auto& value : m_swapped )
+            be::endian_reverse_inplace( reinterpret_cast<std::uint32_t&>( value ) );
+    }
+
+    LOGGER(info) << "weights_file::weights_file - mapped " << m_entries.size() << " layers from \'" << filename << "\'" << std::endl;
+}
+
+bool weights_file::is_weights_file( const std::string& filename )
+{
+    if ( !bfs::exists( filename ) || ( bfs::file_size( filename ) < sizeof( weights_file_header ) ) )
+        return false;
+
+    std::ifstream data_in( filename, std::ios::in | std::ios::binary );
+
+    char magic[sizeof( s_weights_file_magic )];
+    data_in.read( magic, sizeof( magic ) );
+
+    return data_in && ( std::memcmp( magic, s_weights_file_magic, sizeof( magic ) ) == 0 );
+}
+
+half_format weights_file::configured_format()
+{
+    std::string str_format = "FP32";
+    network_config::instance().update_optional( "weights_format", str_format );
+
+    if ( str_format == "FP32" )
+        return half_format::FP32;
+    else if ( str_format == "FP16" )
+        return half_format::FP16;
+    else if ( str_format == "BF16" )
+        return half_format::BF16;
+
+    LOGGER(error) << "weights_file::configured_format - unmanaged weights format \'" << str_format << "\'" << std::endl;
+    throw network_exception( "unmanaged weights format" );
+}
+
+boost::shared_array<float> weights_file::weights( const size_t i ) const
+{
+    const weights_file_entry& _entry = entry( i );
+    const half_format format = static_cast<half_format>( _entry.format );
+
+    if ( _entry.format == s_int8_format )
+    {
+        const weights_file_quantization q = quantization( i );
+
+        boost::shared_array<float> array( new float[_entry.num_weights] );
+        for ( size_t k=0; k<_entry.num_weights; k++ )
+            array[k] = q.scales[( k / q.channel_stride ) % q.channels] * static_cast<float>( q.weights[k] );
+
+        return array;
+    }
+
+    if ( _entry.format & s_sparse_flag )
+        return _sparse_array( _entry );
+
+    if ( format != half_format::FP32 )
+        return _widened_array( format, _entry.weights_offset, _entry.num_weights );
+
+    return _mapped_array( _entry.weights_offset, _entry.num_weights );
+}
+
+weights_file_quantization weights_file::quantization( const size_t i ) const
+{
+    const weights_file_entry& _entry = entry( i );
+
+    if ( _entry.format != s_int8_format )
+        throw network_exception( "layer weights are not quantized" );
+
+    const char* data = static_cast<const char*>( m_region.get_address() ) + _entry.weights_offset;
+
+    std::uint32_t header[2];
+    std::memcpy( header, data, sizeof( header ) );
+    be::little_to_native_inplace( header[0] );
+    be::little_to_native_inplace( header[1] );
+
+    if ( ( header[0] == 0 ) || ( header[1] == 0 ) )
+        throw network_exception( "invalid weights file (inconsistent quantization)" );
+
+    std::vector<float> scales( header[0] + 1 );
+    std::memcpy( scales.data(), data + sizeof( header ), scales.size() * sizeof( float ) );
+    if ( !s_little_endian_host )
+        for ( auto& value : scales )
+            be::endian_reverse_inplace( reinterpret_cast<std::uint32_t&>( value ) );
+
+    weights_file_quantization q;
+    q.channels = header[0];
+    q.channel_stride = header[1];
+    q.input_scale = scales.front();
+    q.scales.assign( scales.begin() + 1, scales.end() );
+    q.weights = reinterpret_cast<const std::int8_t*>( data + _quantization_header_size( q.channels ) );
+
+    return q;
+}
+
+boost::shared_array<float> weights_file::bias( const size_t i ) const
+{
+    const weights_file_entry& _entry = entry( i );
+    return _mapped_array( _entry.bias_offset, _entry.num_bias );
+}
+
+boost::shared_array<float> weights_file::_mapped_array( const std::uint64_t offset, const std::uint64_t size ) const
+{
+    const char* base = s_little_endian_host ? static_cast<const char*>( m_region.get_address() )
+        : reinterpret_cast<const char*>( m_swapped.data() );
+
+    // NOTE : mapping is read only, parameters must not be modified through returned arrays
+    float* data = const_cast<float*>( reinterpret_cast<const float*>( base + offset ) );
+
+    // array keeps the mapping alive
+    std::shared_ptr<const weights_file> self = shared_from_this();
+    return boost::shared_array<float>( data, [self]( float* ){} );
+}
+
+boost::shared_array<float> weights_file::_widened_array( const half_format format, const std::uint64_t offset, const std::uint64_t size ) const
+{
+    // reduced precision blocks are always read from the little endian mapping
+    const std::uint16_t* data = reinterpret_cast<const std::uint16_t*>( static_cast<const char*>( m_region.get_address() ) + offset );
+
+    boost::shared_array<float> array( new float[size] );
+
+    if ( s_little_endian_host )
+        widen_floats( format, data, size, array.get() );
+    else
+    {
+        std::vector<std::uint16_t> swapped( data, data + size );
+        for ( auto& value : swapped )
+            be::little_to_native_inplace( value );
+        widen_floats( format, swapped.data(), size, array.get() );
+    }
+
+    return array;
+}
+
+boost::shared_array<float> weights_file::_sparse_array( const weights_file_entry& entry ) const
+{
+    const half_format format = static_cast<half_format>( entry.format & ~s_sparse_flag );
+    const char* data = static_cast<const char*>( m_region.get_address() ) + entry.weights_offset;
+
+    std::uint64_t count;
+    std::memcpy( &count, data, sizeof( std::uint64_t ) );
+    be::little_to_native_inplace( count );
+
+    const std::uint64_t values_offset = entry.weights_offset + _sparse_header_size( entry.num_weights );
+    const boost::shared_array<float> values = ( format == half_format::FP32 ) ?
+        _mapped_array( values_offset, count ) : _widened_array( format, values_offset, count );
+
+    // non null weights are scattered according to the bitmap
+    boost::shared_array<float> array( new float[entry.num_weights] );
+    std::uint64_t v = 0;
+    for ( std::uint64_t k=0; k<entry.num_weights; k+=32 )
+    {
+        std::uint32_t word;
+        std::memcpy( &word, data + sizeof( std::uint64_t ) + ( k / 32 ) * sizeof( std::uint32_t ), sizeof( std::uint32_t ) );
+        be::little_to_native_inplace( word );
+
+        for ( std::uint64_t b=0; ( b < 32 ) && ( k + b < entry.num_weights ); b++ )
+        {
+            const bool non_null = ( ( word >> b ) & 1u ) != 0;
+            if ( non_null && ( v == count ) )
+                throw network_exception( "invalid weights file (inconsistent sparse weights)" );
+
+            array[k + b] = non_null ? values[v++] : 0.f;
+        }
+    }
+
+    if ( v != count )
+        throw network_exception( "invalid weights file (inconsistent sparse weights)" );
+
+    return array;
+}
+
+void weights_file::write( const std::string& filename, const std::vector<weights_file_layer>& layers, const half_format format )
+{
+    weights_file_header header;
+    std::memset( &header, 0, sizeof( weights_file_header ) );
+    std::memcpy( header.magic, s_weights_file_magic, sizeof( s_weights_file_magic ) );
+    header.version = s_version;
+    header.layers_count = static_cast<std::uint32_t>( layers.size() );
+    header.table_offset = _align( sizeof( weights_file_header ) );
+
+    // layout blocks
+    std::vector<weights_file_entry> entries( layers.size() );
+    std::vector<std::uint64_t> non_null( layers.size() );
+    std::uint64_t offset = _align( header.table_offset + layers.size() * sizeof( weights_file_entry ) );
+    for ( size_t i=0; i<layers.size(); i++ )
+    {
+        std::memset( &entries[i], 0, sizeof( weights_file_entry ) );
+        const weights_file_quantization* q = layers[i].quantization;
+        entries[i].layer_index = static_cast<std::uint32_t>( layers[i].layer_index );
+        entries[i].format = q ? s_int8_format : static_cast<std::uint32_t>( format );
+        entries[i].num_weights = layers[i].num_weights;
+        entries[i].weights_offset = offset;
+
+        // mostly null (pruned) float weights are stored sparse when it is smaller
+        const size_t weights_size = _element_size( entries[i].format );
+        non_null[i] = q ? layers[i].num_weights : std::count_if( layers[i].weights, layers[i].weights + layers[i].num_weights,
+            []( const float w ) { return w != 0.f; } );
+        if ( !q && ( _sparse_header_size( layers[i].num_weights ) + non_null[i] * weights_size < layers[i].num_weights * weights_size ) )
+            entries[i].format |= s_sparse_flag;
+
+        if ( q )
+            offset = _align( offset + _quantization_header_size( q->channels ) + layers[i].num_weights * weights_size );
+        else if ( entries[i].format & s_sparse_flag )
+            offset = _align( offset + _sparse_header_size( layers[i].num_weights ) + non_null[i] * weights_size );
+        else
+            offset = _align( offset + layers[i].num_weights * weights_size );
+        entries[i].num_bias = layers[i].num_bias;
+        entries[i].bias_offset = offset;
+        offset = _align( offset + layers[i].num_bias * sizeof( float ) );
+    }
+
+    // written aside and renamed : processes still mapping the previous file are not affected
+    const std::string tmp_filename = filename + ".tmp";
+
+    std::ofstream data_out( tmp_filename, std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !data_out || !data_out.is_open() )
+    {
+        LOGGER(error) << "weights_file::write - error opening weights file \'" << tmp_filename << "\'" << std::endl;
+        throw network_exception( "unable to open weights file for saving" );
+    }
+
+    auto _pad_to = [&data_out]( const std::uint64_t offset ) {
+        while ( static_cast<std::uint64_t>( data_out.tellp() ) < offset )
+            data_out.put( 0 );
+    };
+
+    auto _write_floats = [&data_out]( const float* values, const size_t count ) {
+        if ( s_little_endian_host )
+            data_out.write( reinterpret_cast<const char*>( values ), count * sizeof( float ) );
+        else
+            for ( size_t i=0; i<count; i++ )
+            {
+                std::uint32_t value;
+                std::memcpy( &value, values + i, sizeof( float ) );
+                be::native_to_little_inplace( value );
+                data_out.write( reinterpret_cast<const char*>( &value ), sizeof( value ) );
+            }
+    };
+
+    // bias are kept in float32 : they are few and sensitive to rounding
+    auto _write_halves = [&data_out,format]( const float* values, const size_t count ) {
+        std::vector<std::uint16_t> halves( count );
+        narrow_floats( format, values, count, halves.data() );
+        if ( !s_little_endian_host )
+            for ( auto& value : halves )
+                be::native_to_little_inplace( value );
+        data_out.write( reinterpret_cast<const char*>( halves.data() ), count * sizeof( std::uint16_t ) );
+    };
+
+    weights_file_header _header = header;
+    be::native_to_little_inplace( _header.version );
+    be::native_to_little_inplace( _header.layers_count );
+    be::native_to_little_inplace( _header.table_offset );
+    data_out.write( reinterpret_cast<const char*>( &_header ), sizeof( weights_file_header ) );
+
+    _pad_to( header.table_offset );
+    for ( auto entry : entries )
+    {
+        be::native_to_little_inplace( entry.layer_index );
+        be::native_to_little_inplace( entry.format );
+        be::native_to_little_inplace( entry.num_weights );
+        be::native_to_little_inplace( entry.weights_offset );
+        be::native_to_little_inplace( entry.num_bias );
+        be::native_to_little_inplace( entry.bias_offset );
+        data_out.write( reinterpret_cast<const char*>( &entry ), sizeof( weights_file_entry ) );
+    }
+
+    for ( size_t i=0; i<layers.size(); i++ )
+    {
+        _pad_to( entries[i].weights_offset );
+        if ( const weights_file_quantization* q = layers[i].quantization )
+        {
+            if ( ( q->channels == 0 ) || ( q->channel_stride == 0 ) || ( q->scales.size() != q->channels ) )
+                throw network_exception( "inconsistent layer quantization" );
+
+            std::uint32_t header[2] = { static_cast<std::uint32_t>( q->channels ), static_cast<std::uint32_t>( q->channel_stride ) };
+            be::native_to_little_inplace( header[0] );
+            be::native_to_little_inplace( header[1] );
+            data_out.write( reinterpret_cast<const char*>( header ), sizeof( header ) );
+            _write_floats( &q->input_scale, 1 );
+            _write_floats( q->scales.data(), q->channels );
+            data_out.write( reinterpret_cast<const char*>( q->weights ), layers[i].num_weights );
+        }
+        else if ( entries[i].format & s_sparse_flag )
+        {
+            std::uint64_t count = non_null[i];
+            be::native_to_little_inplace( count );
+            data_out.write( reinterpret_cast<const char*>( &count ), sizeof( count ) );
+
+            std::vector<float> values;
+            values.reserve( non_null[i] );
+            for ( size_t k=0; k<layers[i].num_weights; k+=32 )
+            {
+                std::uint32_t word = 0;
+                for ( size_t b=0; ( b < 32 ) && ( k + b < layers[i].num_weights ); b++ )
+                {
+                    if ( layers[i].weights[k + b] != 0.f )
+                    {
+                        word |= ( 1u << b );
+                        values.push_back( layers[i].weights[k + b] );
+                    }
+                }
+                be::native_to_little_inplace( word );
+                data_out.write( reinterpret_cast<const char*>( &word ), sizeof( word ) );
+            }
+
+            if ( format == half_format::FP32 )
+                _write_floats( values.data(), values.size() );
+            else
+                _write_halves( values.data(), values.size() );
+        }
+        else if ( format == half_format::FP32 )
+            _write_floats( layers[i].weights, layers[i].num_weights );
+        else
+            _write_halves( layers[i].weights, layers[i].num_weights );
+        _pad_to( entries[i].bias_offset );
+        _write_floats( layers[i].bias, layers[i].num_bias );
+    }
+    _pad_to( offset );
+
+    data_out.close();
+    if ( !data_out )
+        throw network_exception( "error writing weights file" );
+
+    bfs::rename( tmp_filename, filename );
+}
+
+} //namespace neurocl
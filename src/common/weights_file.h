@@ -0,0 +1,172 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef WEIGHTS_FILE_H
+#define WEIGHTS_FILE_H
+
+#include "export.h"
+#include "half_float.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/shared_array.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace neurocl {
+
+// Versioned weights container layout (little endian, blocks aligned on 64 bytes):
+// header | layers table (layers_count entries) | per layer weights (float32/float16/bfloat16/int8) & bias (float32) blocks
+// int8 weights block : channels (uint32) | channel stride (uint32) | input scale (float32) | channels scales (float32) | weights
+// sparse weights block : non null weights count (uint64) | non null weights bitmap (uint32 words) | non null weights
+struct weights_file_header
+{
+    char magic[8];              // "NEUROCLW"
+    std::uint32_t version;
+    std::uint32_t layers_count;
+    std::uint64_t table_offset;
+};
+
+struct weights_file_entry
+{
+    std::uint32_t layer_index;  // network layer index
+    std::uint32_t format;       // weights block storage format (half_format or int8, half_format may be flagged sparse), always float32 in version 1 files
+    std::uint64_t num_weights;
+    std::uint64_t weights_offset;
+    std::uint64_t num_bias;
+    std::uint64_t bias_offset;
+};
+
+// int8 symmetric quantization of a layer (real value = scale x int8 value)
+struct weights_file_quantization
+{
+    size_t channels;            // number of weights scales
+    size_t channel_stride;      // weight i is scaled by scales[ ( i / channel_stride ) % channels ]
+    float input_scale;          // input activations scale
+    std::vector<float> scales;
+    const std::int8_t* weights;
+};
+
+// layer parameters to be written
+struct weights_file_layer
+{
+    size_t layer_index;
+    size_t num_weights;
+    const float* weights;
+    size_t num_bias;
+    const float* bias;
+    const weights_file_quantization* quantization; // int8 weights written instead of float ones if set
+};
+
+/**
+ *  Read-only memory mapped weights file : pages are shared in the system page cache between
+ *  processes, and layers parameters are read in place (no deserialization).
+ */
+class NEUROCL_PUBLIC weights_file : public std::enable_shared_from_this<weights_file>
+{
+public:
+
+    //! memory map a weights file
+    weights_file( const std::string& filename );
+    virtual ~weights_file() {}
+
+    //! write layers parameters to a weights file, weights being optionally stored in reduced precision
+    static void write( const std::string& filename, const std::vector<weights_file_layer>& layers,
+        const half_format format = half_format::FP32 );
+
+    //! weights storage format given by the weights_format configuration key (FP32/FP16/BF16)
+    static half_format configured_format();
+
+    //! check if given file is a versioned weights file (legacy archive otherwise)
+    static bool is_weights_file( const std::string& filename );
+
+    size_t layers_count() const { return m_entries.size(); }
+    const weights_file_entry& entry( const size_t i ) const { return m_entries.at( i ); }
+
+    //! layer parameters arrays, pointing into the read-only mapping (which they keep alive)
+    //! NOTE : reduced precision weights are widened to a float32 copy, int8 weights are dequantized
+    boost::shared_array<float> weights( const size_t i ) const;
+    boost::shared_array<float> bias( const size_t i ) const;
+
+    //! check if layer weights are int8 quantized
+    bool quantized( const size_t i ) const { return entry( i ).format == s_int8_format; }
+    //! layer quantization, weights pointing into the read-only mapping (valid as long as the file is)
+    weights_file_quantization quantization( const size_t i ) const;
+
+    //! check if layer weights are stored sparse (mostly null weights, e.g. pruned layer)
+    bool sparse( const size_t i ) const { return ( entry( i ).format & s_sparse_flag ) != 0; }
+
+    //! int8 weights block format, following half_format values
+    static const std::uint32_t s_int8_format = 3;
+    //! sparse weights block flag, combined with half_format values
+    static const std::uint32_t s_sparse_flag = 0x100;
+
+private:
+
+    static const std::uint32_t s_version = 2;
+    static const std::uint64_t s_alignment = 64;
+
+    static std::uint64_t _align( const std::uint64_t offset )
+    {
+        return ( ( offset + s_alignment - 1 ) / s_alignment ) * s_alignment;
+    }
+
+    static size_t _element_size( const std::uint32_t format )
+    {
+        if ( format == s_int8_format )
+            return sizeof( std::int8_t );
+        return ( ( format & ~s_sparse_flag ) == static_cast<std::uint32_t>( half_format::FP32 ) ) ? sizeof( float ) : sizeof( std::uint16_t );
+    }
+
+    static std::uint64_t _sparse_header_size( const std::uint64_t num_weights )
+    {
+        return sizeof( std::uint64_t ) + ( ( num_weights + 31 ) / 32 ) * sizeof( std::uint32_t );
+    }
+
+    static std::uint64_t _quantization_header_size( const std::uint64_t channels )
+    {
+        return 2 * sizeof( std::uint32_t ) + ( channels + 1 ) * sizeof( float );
+    }
+
+    boost::shared_array<float> _mapped_array( const std::uint64_t offset, const std::uint64_t size ) const;
+    boost::shared_array<float> _widened_array( const half_format format, const std::uint64_t offset, const std::uint64_t size ) const;
+    boost::shared_array<float> _sparse_array( const weights_file_entry& entry ) const;
+
+private:
+
+    std::vector<weights_file_entry> m_entries;
+
+    boost::interprocess::file_mapping m_file;
+    boost::interprocess::mapped_region m_region;
+
+    // byte swapped parameters copy, on big endian hosts only
+    std::vector<float> m_swapped;
+};
+
+} //namespace neurocl
+
+#endif //WEIGHTS_FILE_H
@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include "layer.h"
 #include "tensor_tank.h"
+#include "tensor_fake_quantizer.h"
 
 #include "common/logger.h"
 
@@ -123,6 +124,11 @@ public:
             for ( auto& _filters : m_filters_cache )
                 _filters = tensor_tank::instance().get_standard( "filters_cache" + std::to_string(j++), m_filter_size, m_filter_size, prev_layer->depth(), depth );
         }
+
+        // filters are quantized per output feature map
+        if ( m_quantization_aware )
+            m_quantizer.reset( new tensor_fake_quantizer(
+                m_quantization_per_channel ? nto::quantize_mode::maps : nto::quantize_mode::layer ) );
     }
 
     size_t width() const override { return m_feature_maps.w(); }
@@ -137,9 +143,13 @@ public:
 
     void feed_forward() override
     {
+        // quantization aware training : input & filters are fake quantized
+        if ( m_quantizer )
+            m_quantizer->quantize( m_prev_layer->feature_maps(), *m_filters, m_training );
+
         m_feature_maps = nto::convolve_add_forward<nto::kernel_mode::flip,nto::pad_mode::valid>(
-            m_prev_layer->feature_maps(),
-            *m_filters,
+            _input(),
+            _filters(),
         	m_filter_stride ) + *m_bias;
 
 		// could be computed in next pooling layer if present for reduced computation
@@ -166,7 +176,7 @@ public:
 
         prev_error_maps = nto::convolve_add_backward<nto::kernel_mode::std,nto::pad_mode::full>(
             m_error_maps,
-            *m_filters,
+            _filters(),
             m_filter_stride );
 
         // multiply by sigma derivative
@@ -174,6 +184,10 @@ public:
             m_prev_layer->d_activation( prev_feature_maps ),
             prev_error_maps
         );
+
+        // straight-through input quantization
+        if ( m_quantizer )
+            m_quantizer->mask_errors( prev_feature_maps, prev_error_maps );
     }
 
     void update_gradients() override
@@ -181,7 +195,7 @@ public:
         // Compute gradients
 
         auto&& grad = nto::convolve_update<nto::kernel_mode::std,nto::pad_mode::valid>(
-            m_prev_layer->feature_maps(),
+            _input(),
             m_error_maps,
             m_filter_stride);
 
@@ -223,14 +237,38 @@ public:
          m_bias->grouped_fill( data );
     }
 
+    // Get training state tensors
+    void training_tensors( std::vector<tensor*>& tensors ) override
+    {
+        tensors.push_back( m_filters );
+        tensors.insert( tensors.end(), m_filters_cache.begin(), m_filters_cache.end() );
+        tensors.push_back( m_bias );
+        tensors.insert( tensors.end(), m_bias_cache.begin(), m_bias_cache.end() );
+
+        if ( m_quantizer )
+            tensors.push_back( m_quantizer->training_tensor() );
+    }
+
+    // Get/Set learned input quantization scale
+    float input_scale() const override
+    {
+        return m_quantizer ? m_quantizer->input_scale() : 0.f;
+    }
+    void set_input_scale( const float scale ) override
+    {
+        if ( m_quantizer )
+            m_quantizer->set_input_scale( scale );
+    }
+
     tensor& error_maps( key_errors ) override
         { return m_error_maps; }
 
     //! get gradient checker
     std::unique_ptr<tensor_gradient_checker> get_gradient_checker() override
     {
+        // filters deltas are averaged over the output feature maps
         return std::unique_ptr<tensor_gradient_checker>(
-            new tensor_gradient_checker( *m_filters, *m_deltas_filters ) );
+            new tensor_gradient_checker( *m_filters, *m_deltas_filters, static_cast<float>( m_deltas_filters->d2() ) ) );
     }
 
 	// copy accessor, not made for performance but rather for network introspection
@@ -245,6 +283,10 @@ protected:
 
 private:
 
+    // feed forward input & filters, fake quantized if quantization aware training
+    const tensor& _input() const { return m_quantizer ? m_quantizer->input() : m_prev_layer->feature_maps(); }
+    const tensor& _filters() const { return m_quantizer ? m_quantizer->weights() : *m_filters; }
+
     const std::string m_name;
 
     std::shared_ptr<layer> m_prev_layer;
@@ -262,6 +304,8 @@ private:
 
     tensor m_feature_maps;
     tensor m_error_maps;
+
+    std::unique_ptr<tensor_fake_quantizer> m_quantizer;
 };
 
 } /*namespace neurocl*/ } /*namespace convnet*/
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "layer.h"
 
 #include "common/logger.h"
+#include "common/network_random.h"
 
 namespace neurocl { namespace convnet {
 
@@ -37,7 +38,8 @@ class dropout_layer final : public layer
 {
 public:
 
-    dropout_layer( const std::string& name ) : m_name( name ), m_dropout( 0.5f ) {}
+    // each layer (and network_parallel replica) owns its random stream
+    dropout_layer( const std::string& name ) : m_name( name ), m_dropout( 0.5f ), m_rng_key( random::seed::instance()() ) {}
 	virtual ~dropout_layer() {}
 
 	const std::string type() const override { return "dropout " + m_name; }
@@ -62,9 +64,11 @@ public:
         m_feature_maps.resize( width, height, 1, depth );
         m_error_maps.resize( width, height, 1, depth );
         m_mask.resize( width, height, 1, depth );
+        m_mask_counter.resize( 2, 1, 1, 1 );
+        m_mask_counter.uniform_fill( 0.f );
 
 		// generate initial mask
-        nto::bernoulli( m_mask, 1.f - m_dropout );
+        _next_mask();
     }
 
     size_t width() const override { return m_feature_maps.w(); }
@@ -87,11 +91,12 @@ public:
 
     void back_propagate() override
     {
-        m_prev_layer->error_maps({}) = nto::elemul( m_mask, m_error_maps );
+        // same inverted dropout scaling as the forward pass
+        m_prev_layer->error_maps({}) = ( 1.f / ( 1.f - m_dropout ) ) * nto::elemul( m_mask, m_error_maps );
 
         // dropout layer has to generate new mask after each backprop
         // cf. https://www.quora.com/How-is-dropout-applied-to-mini-batches-in-dropout-neural-networks-with-stochastic-gradient-descent
-        nto::bernoulli( m_mask, 1.f - m_dropout );
+        _next_mask();
     }
 
     void update_gradients() override
@@ -117,6 +122,13 @@ public:
     void fill_b( const size_t data_size, const float* data ) override { /* NOTHING TO DO */ }
     void fill_b( float* data ) override { /* NOTHING TO DO */ }
 
+    // Get training state tensors : next training sample mask is drawn at backprop
+    void training_tensors( std::vector<tensor*>& tensors ) override
+    {
+        tensors.push_back( &m_mask );
+        tensors.push_back( &m_mask_counter );
+    }
+
     tensor& error_maps( key_errors ) override
         { return m_error_maps; }
 
@@ -127,6 +139,24 @@ protected:
         return m_prev_layer->width() * m_prev_layer->height();
     }
 
+private:
+
+    // masks are indexed streams of the layer random key, the index being part of the training state
+    // so that resumed trainings replay the same masks (stored as two exact 24 bits floats)
+    void _next_mask()
+    {
+        float state[2];
+        m_mask_counter.grouped_fill( state );
+        std::uint64_t counter = static_cast<std::uint64_t>( state[0] ) | ( static_cast<std::uint64_t>( state[1] ) << 24 );
+
+        random::philox_generator rng( m_rng_key, counter++ );
+        nto::bernoulli( m_mask, 1.f - m_dropout, rng );
+
+        state[0] = static_cast<float>( counter & 0xFFFFFF );
+        state[1] = static_cast<float>( counter >> 24 );
+        m_mask_counter.grouped_fill( 2, state );
+    }
+
 private:
 
     const std::string m_name;
@@ -138,6 +168,9 @@ private:
     tensor m_feature_maps;
     tensor m_error_maps;
     tensor m_mask;
+
+    const std::uint32_t m_rng_key;
+    tensor m_mask_counter;
 };
 
 } /*namespace neurocl*/ } /*namespace convnet*/
@@ -27,6 +27,8 @@ THE SOFTWARE.
 
 #include "layer.h"
 #include "tensor_tank.h"
+#include "tensor_fake_quantizer.h"
+#include "tensor_sparse.h"
 
 #include "common/logger.h"
 
@@ -53,7 +55,7 @@ public:
 
     full_layer( const std::string& name ) : m_name( name ),
     	m_weights( nullptr ), m_deltas_weights( nullptr ),
-    	m_bias( nullptr ), m_deltas_bias( nullptr ), m_prev_group_features( false ) {}
+    	m_bias( nullptr ), m_deltas_bias( nullptr ), m_prev_group_features( false ), m_sparse_dirty( true ) {}
 
     virtual ~full_layer() {}
 
@@ -116,6 +118,11 @@ public:
             for ( auto& _weights : m_weights_cache )
                 _weights = tensor_tank::instance().get_standard( "weights_cache" + std::to_string(j++), width * height, fan_in(), 1, depth );
         }
+
+        // weights are quantized per output neuron (matrix row)
+        if ( m_quantization_aware )
+            m_quantizer.reset( new tensor_fake_quantizer(
+                m_quantization_per_channel ? nto::quantize_mode::rows : nto::quantize_mode::layer ) );
     }
 
     size_t width() const override { return m_feature_maps.w(); }
@@ -132,7 +139,26 @@ public:
     {
         const auto& prev_feature_maps = m_prev_layer->feature_maps();
 
-        if ( m_prev_group_features )
+        if ( m_quantizer )
+        {
+            // quantization aware training : input & weights are fake quantized
+            if ( m_prev_group_features )
+                m_quantizer->quantize( nto::group( prev_feature_maps ), *m_weights, m_training );
+            else
+                m_quantizer->quantize( prev_feature_maps, *m_weights, m_training );
+
+            // apply weights and bias
+            m_feature_maps = nto::muladd( m_quantizer->weights(), m_quantizer->input(), *m_bias );
+        }
+        else if ( !m_training && _sparse_weights() )
+        {
+            // pruned weights inference : apply sparse weights and bias
+            if ( m_prev_group_features )
+                m_feature_maps = m_sparse_weights.muladd( nto::group( prev_feature_maps ), *m_bias );
+            else
+                m_feature_maps = m_sparse_weights.muladd( prev_feature_maps, *m_bias );
+        }
+        else if ( m_prev_group_features )
         {
             const tensor grouped_feature_maps = nto::group( prev_feature_maps );
 
@@ -166,7 +192,7 @@ public:
 
             const tensor grouped_error_maps = nto::elemul(
                 m_prev_layer->d_activation( grouped_feature_maps ),
-                nto::multrans1( *m_weights, m_error_maps )
+                nto::multrans1( _weights(), m_error_maps )
             );
 
             nto::ungroup( grouped_error_maps, prev_error_maps );
@@ -175,16 +201,25 @@ public:
         {
         	prev_error_maps = nto::elemul(
             	m_prev_layer->d_activation( prev_feature_maps ),
-            	nto::multrans1( *m_weights, m_error_maps )
+            	nto::multrans1( _weights(), m_error_maps )
         	);
         }
+
+        // straight-through input quantization
+        if ( m_quantizer )
+            m_quantizer->mask_errors( prev_feature_maps, prev_error_maps );
     }
 
     void update_gradients() override
     {
         // Compute gradients
 
-        if ( m_prev_group_features )
+        if ( m_quantizer )
+        {
+            *m_deltas_weights += nto::multrans2( m_error_maps, m_quantizer->input() );
+            *m_deltas_bias += m_error_maps;
+        }
+        else if ( m_prev_group_features )
         {
             const auto&& grouped_feature_maps = nto::group( m_prev_layer->feature_maps() );
 
@@ -210,12 +245,34 @@ public:
 
         nto::optimize<nto::optimize_mode::std>( solver, m_weights, m_weights_cache.data(), m_deltas_weights );
         nto::optimize<nto::optimize_mode::redux>( solver, m_bias, m_bias_cache.data(), m_deltas_bias );
+
+        // pruned weights stay null
+        if ( !m_prune_mask.empty() )
+            *m_weights = nto::elemul( *m_weights, m_prune_mask );
+
+        m_sparse_dirty = true;
+    }
+
+    bool prune( const float sparsity ) override
+    {
+        nto::prune( *m_weights, sparsity, m_prune_mask );
+        m_sparse_dirty = true;
+
+        LOGGER(info) << "full_layer::prune - layer " << m_name << " pruned to " << ( 100.f * sparsity ) << "% sparsity" << std::endl;
+
+        return true;
+    }
+
+    void parameters_changed() override
+    {
+        m_sparse_dirty = true;
     }
 
     // Fill weights
     void fill_w( const size_t data_size, const float* data ) override
     {
          m_weights->grouped_fill( data_size, data );
+         m_sparse_dirty = true;
     }
     void fill_w( float* data ) override
     {
@@ -232,6 +289,29 @@ public:
          m_bias->grouped_fill( data );
     }
 
+    // Get training state tensors
+    void training_tensors( std::vector<tensor*>& tensors ) override
+    {
+        tensors.push_back( m_weights );
+        tensors.insert( tensors.end(), m_weights_cache.begin(), m_weights_cache.end() );
+        tensors.push_back( m_bias );
+        tensors.insert( tensors.end(), m_bias_cache.begin(), m_bias_cache.end() );
+
+        if ( m_quantizer )
+            tensors.push_back( m_quantizer->training_tensor() );
+    }
+
+    // Get/Set learned input quantization scale
+    float input_scale() const override
+    {
+        return m_quantizer ? m_quantizer->input_scale() : 0.f;
+    }
+    void set_input_scale( const float scale ) override
+    {
+        if ( m_quantizer )
+            m_quantizer->set_input_scale( scale );
+    }
+
     //! get gradient checker
     std::unique_ptr<tensor_gradient_checker> get_gradient_checker() override
     {
@@ -252,6 +332,20 @@ protected:
 
 private:
 
+    // feed forward weights, fake quantized if quantization aware training
+    const tensor& _weights() const { return m_quantizer ? m_quantizer->weights() : *m_weights; }
+
+    // sparse copy of the weights, built lazily after weights modification (empty if not sparse enough)
+    bool _sparse_weights()
+    {
+        if ( m_sparse_dirty )
+        {
+            m_sparse_weights.build( *m_weights, m_sparse_threshold );
+            m_sparse_dirty = false;
+        }
+        return !m_sparse_weights.empty();
+    }
+
     const std::string m_name;
 
     std::shared_ptr<layer> m_prev_layer;
@@ -268,6 +362,12 @@ private:
     std::vector<tensor*> m_bias_cache;
 
     bool m_prev_group_features;
+
+    std::unique_ptr<tensor_fake_quantizer> m_quantizer;
+
+    tensor m_prune_mask;
+    tensor_sparse m_sparse_weights;
+    bool m_sparse_dirty;
 };
 
 } /*namespace neurocl*/ } /*namespace convnet*/
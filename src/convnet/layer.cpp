@@ -28,5 +28,8 @@ namespace neurocl { namespace convnet {
 
 bool layer::m_training = false;
 bool layer::m_shared = false;
+bool layer::m_quantization_aware = false;
+bool layer::m_quantization_per_channel = true;
+float layer::m_sparse_threshold = 0.7f;
 
 } /*namespace neurocl*/ } /*namespace convnet*/
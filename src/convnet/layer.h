@@ -65,6 +65,9 @@ public:
     virtual void fill_b( const size_t data_size, const float* data ) = 0;
     virtual void fill_b( float* data ) = 0;
 
+    //! Get training state tensors : parameters followed by their solver caches, dropout masks... (checkpointing)
+    virtual void training_tensors( std::vector<tensor*>& tensors ) {}
+
     //! Apply activation gradient function
     virtual tensor d_activation( const tensor& in ) const = 0;
 
@@ -79,6 +82,29 @@ public:
 
     //! Set shared flag
     static void set_shared( bool shared ) { m_shared = shared; }
+    //! Get shared flag
+    static bool get_shared() { return m_shared; }
+
+    //! Set quantization aware training flags (to be set before layers populating)
+    static void set_quantization_aware( bool quantization_aware, bool per_channel )
+    {
+        m_quantization_aware = quantization_aware;
+        m_quantization_per_channel = per_channel;
+    }
+
+    //! Get/Set learned input quantization scale (null if quantization aware training is not managed)
+    virtual float input_scale() const { return 0.f; }
+    virtual void set_input_scale( const float scale ) {}
+
+    //! Set minimum null weights ratio of prunable layers sparse inference
+    static void set_sparse_threshold( float threshold ) { m_sparse_threshold = threshold; }
+
+    //! Prune smallest magnitude weights (sparsity ratio), pruned weights stay null while training
+    //! returns false if layer is not prunable
+    virtual bool prune( const float sparsity ) { return false; }
+
+    //! Notify parameters modified outside of the layer (e.g. training state restored)
+    virtual void parameters_changed() {}
 
 public:
 
@@ -114,6 +140,9 @@ protected:
 
     static bool m_training;
     static bool m_shared;
+    static bool m_quantization_aware;
+    static bool m_quantization_per_channel;
+    static float m_sparse_threshold;
 };
 
 } /*namespace neurocl*/ } /*namespace convnet*/
@@ -34,17 +34,38 @@ THE SOFTWARE.
 #include "output_layer.h"
 #include "dropout_layer.h"
 
+#include "common/network_config.h"
+#include "common/network_random.h"
+#include "common/profiler.h"
+#include "common/allocation_tracker.h"
+#include "common/thread_pool.h"
+
 #include <boost/range/adaptor/reversed.hpp>
 
+#include <limits>
+#include <numeric>
+#include <unordered_set>
+
 namespace neurocl { namespace convnet {
 
 std::atomic_size_t network::m_training_samples{ 0 };
 
 //#define VERBOSE_NETWORK
 
-network::network()
+network::network() : m_quantization_aware( false )
 {
     m_solver = tensor_solver_factory::build();
+
+    // quantization aware training : int8 rounding is simulated in feed forward, learned scales are exported
+    bool per_channel = true;
+    network_config::instance().update_optional( "quantization_aware_training", m_quantization_aware );
+    network_config::instance().update_optional( "quantization_per_channel", per_channel );
+    layer::set_quantization_aware( m_quantization_aware, per_channel );
+
+    // pruned layers use sparse inference above this null weights ratio
+    float sparse_threshold = 0.7f;
+    network_config::instance().update_optional( "sparse_threshold", sparse_threshold );
+    layer::set_sparse_threshold( sparse_threshold );
 }
 
 network::~network()
@@ -121,6 +142,8 @@ void network::add_layers( const std::vector<layer_descr>& layers )
             break;
         }
         m_layers.emplace_back( l );
+        m_layers.back()->training_tensors( m_training_tensors );
+        m_layers_descr.push_back( _layer );
     }
 }
 
@@ -200,6 +223,74 @@ void network::set_layer_ptr( const size_t layer_idx, const layer_ptr& l )
     _layer->fill_b( _layer->nb_bias(), l.bias.get() );
 }
 
+float network::get_layer_input_scale( const size_t layer_idx ) const
+{
+    if ( layer_idx >= m_layers.size() )
+    {
+        LOGGER(error) << "network::get_layer_input_scale - cannot access layer " << layer_idx << std::endl;
+        throw network_exception( "invalid layer index" );
+    }
+
+    return m_layers[layer_idx]->input_scale();
+}
+
+void network::set_layer_input_scale( const size_t layer_idx, const float scale )
+{
+    if ( layer_idx >= m_layers.size() )
+    {
+        LOGGER(error) << "network::set_layer_input_scale - cannot access layer " << layer_idx << std::endl;
+        throw network_exception( "invalid layer index" );
+    }
+
+    m_layers[layer_idx]->set_input_scale( scale );
+}
+
+size_t network::training_state_size()
+{
+    size_t size = m_solver->get_state_size();
+    for ( const auto _tensor : m_training_tensors )
+        size += _tensor->size();
+
+    return size;
+}
+
+void network::get_training_state( float* state )
+{
+    // no allocation here : state is copied straight to the caller buffer
+    m_solver->get_state( state );
+    state += m_solver->get_state_size();
+
+    for ( const auto _tensor : m_training_tensors )
+    {
+        _tensor->grouped_fill( state );
+        state += _tensor->size();
+    }
+}
+
+void network::set_training_state( const float* state )
+{
+    m_solver->set_state( state );
+    state += m_solver->get_state_size();
+
+    for ( const auto _tensor : m_training_tensors )
+    {
+        _tensor->grouped_fill( _tensor->size(), state );
+        state += _tensor->size();
+    }
+
+    for ( auto _layer : m_layers )
+        _layer->parameters_changed();
+}
+
+bool network::prune( const float sparsity )
+{
+    bool pruned = false;
+    for ( auto _layer : m_layers )
+        pruned = _layer->prune( sparsity ) || pruned;
+
+    return pruned;
+}
+
 const output_ptr network::output()
 {
     // TODO-CNN : for now works only because last layer has no depth for now
@@ -230,6 +321,8 @@ void network::feed_forward()
 #ifdef VERBOSE_NETWORK
         std::cout << "--> feed forwarding " << _layer->type() << " layer" << std::endl;
 #endif
+        PROFILE_SCOPE( _layer->type(), "feed_forward" );
+        ALLOCATION_SCOPE( _layer->type(), "feed_forward" );
         _layer->feed_forward();
     }
 }
@@ -241,6 +334,8 @@ void network::back_propagate()
 #ifdef VERBOSE_NETWORK
         std::cout << "--> back propagating " << _layer->type() << " layer" << std::endl;
 #endif
+        PROFILE_SCOPE( _layer->type(), "back_propagate" );
+        ALLOCATION_SCOPE( _layer->type(), "back_propagate" );
         _layer->back_propagate();
     }
 
@@ -249,6 +344,8 @@ void network::back_propagate()
 #ifdef VERBOSE_NETWORK
         std::cout << "--> updating gradients " << _layer->type() << " layer" << std::endl;
 #endif
+        PROFILE_SCOPE( _layer->type(), "update_gradients" );
+        ALLOCATION_SCOPE( _layer->type(), "update_gradients" );
         _layer->update_gradients();
     }
 
@@ -261,6 +358,8 @@ void network::gradient_descent()
 
     for ( auto _layer : m_layers )
     {
+        PROFILE_SCOPE( _layer->type(), "gradient_descent" );
+        ALLOCATION_SCOPE( _layer->type(), "gradient_descent" );
         _layer->gradient_descent( m_solver );
     }
 }
@@ -271,65 +370,195 @@ float network::loss()
 }
 
 void network::gradient_check( const output_ptr& out_ref )
+{
+    size_t threads = std::max( 1u, std::thread::hardware_concurrency() );
+    network_config::instance().update_optional( "gradient_check_threads", threads );
+
+    gradient_check( out_ref, threads );
+}
+
+void network::gradient_check( const output_ptr& out_ref, size_t threads )
 {
     // NOTE : network input & output have to be previously set!!
 
-    auto err_func = []( output_ptr a, output_ptr b ) {
-        float _acc = 0.f;
-        float* pa = a.outputs.get();
-        float* pb = b.outputs.get();
-        for ( size_t i=0; i<a.num_outputs; i++ )
-            _acc += (pa[i] - pb[i])*(pa[i] - pb[i]);
+    // parameters randomly checked per layer (0 checks all of them) & parameters increment
+    size_t samples = 0;
+    float epsilon = 1e-3f;
+    network_config::instance().update_optional( "gradient_check_samples", samples );
+    network_config::instance().update_optional( "gradient_check_epsilon", epsilon );
+    threads = std::max( threads, size_t( 1 ) );
+
+    if ( m_quantization_aware )
+    {
+        LOGGER(warning) << "network::gradient_check - quantization aware training relies on straight-through gradients, "
+            << "large errors are expected" << std::endl;
+    }
+
+    const bool training = layer::get_training();
+    layer::set_training( true );
 
-        return _acc / ( 2.f * static_cast<float>( a.num_outputs ) ); // TODO : mse error, use a generic loss class?
-     };
+    // snapshot taken before back propagation draws new dropout masks
+    std::vector<float> state( training_state_size() );
+    get_training_state( state.data() );
 
-    float epsilon = 1e-4f;
+    tensor input = m_layers.front()->feature_maps();
+    std::vector<float> input_data( input.size() );
+    input.grouped_fill( input_data.data() );
 
-    for ( auto _layer : m_layers )
+    // analytic gradients : a single forward & backward pass
+    clear_gradients();
+    feed_forward();
+    back_propagate();
+
+    // smallest gradient the single precision central difference resolves
+    const float loss = std::static_pointer_cast<output_layer_iface>( m_layers.back() )->sample_loss();
+    const double resolution = std::max( std::abs( loss ), 1.f ) * std::numeric_limits<float>::epsilon() / epsilon;
+
+    struct checked_layer
+    {
+        size_t layer_idx;
+        std::unique_ptr<tensor_gradient_checker> grad_check;
+        std::vector<size_t> indices;
+        std::vector<float> numerical_grads;
+    };
+
+    std::vector<checked_layer> checked_layers;
+    std::vector<std::pair<size_t,size_t>> probes; // (checked layer, index position)
+
+    random::philox_generator rng( random::seed::instance()() );
+
+    for ( size_t i = 0; i < m_layers.size(); i++ )
     {
-        std::unique_ptr<tensor_gradient_checker> grad_check = _layer->get_gradient_checker();
+        std::unique_ptr<tensor_gradient_checker> grad_check = m_layers[i]->get_gradient_checker();
         if ( !grad_check )
             continue;
 
-        for ( size_t i = 0; i<grad_check->size(); i++ )
+        const size_t size = grad_check->size();
+        std::vector<size_t> indices;
+
+        if ( samples && ( samples < size ) )
+        {
+            // random subset without replacement (Floyd's algorithm)
+            std::vector<float> u( samples );
+            rng.uniform( u.data(), samples );
+
+            std::unordered_set<size_t> subset;
+            for ( size_t j = size - samples, k = 0; j < size; j++, k++ )
+            {
+                const size_t t = std::min( j, static_cast<size_t>( u[k] * static_cast<float>( j + 1 ) ) );
+                subset.insert( subset.count( t ) ? j : t );
+            }
+            indices.assign( subset.begin(), subset.end() );
+            std::sort( indices.begin(), indices.end() );
+        }
+        else
+        {
+            indices.resize( size );
+            std::iota( indices.begin(), indices.end(), size_t( 0 ) );
+        }
+
+        for ( size_t k = 0; k < indices.size(); k++ )
+            probes.emplace_back( checked_layers.size(), k );
+
+        checked_layers.push_back( { i, std::move( grad_check ), std::move( indices ), std::vector<float>() } );
+        checked_layers.back().numerical_grads.resize( checked_layers.back().indices.size() );
+    }
+
+    threads = std::min( threads, std::max( probes.size(), size_t( 1 ) ) );
+
+    // replicas own their parameters, even when built alongside a parallel network
+    const bool shared = layer::get_shared();
+    layer::set_shared( false );
+    while ( m_check_networks.size() < threads )
+    {
+        m_check_networks.emplace_back( std::make_shared<network>() );
+        m_check_networks.back()->add_layers( m_layers_descr );
+    }
+    layer::set_shared( shared );
+
+    std::atomic_size_t next_probe{ 0 };
+
+    // each replica probes its parameters with forward passes only, starting from the perturbed layer
+    auto _probe = [&]( network& net )
+    {
+        net.set_training_state( state.data() );
+        net.set_input( input_data.size(), input_data.data() );
+        net.set_output( out_ref.num_outputs, out_ref.outputs.get() );
+        net.feed_forward();
+
+        const auto& out_layer = std::static_pointer_cast<output_layer_iface>( net.m_layers.back() );
+
+        auto _loss = [&]( const size_t first_layer )
         {
-            // Store weight
-            grad_check->store();
+            for ( size_t l = first_layer; l < net.m_layers.size(); l++ )
+                net.m_layers[l]->feed_forward();
+            return out_layer->sample_loss();
+        };
 
-            // Compute output with +epsilon increment
-            grad_check->mod( +epsilon );
-            feed_forward();
-            back_propagate();
+        std::vector<std::unique_ptr<tensor_gradient_checker>> grad_checks;
+        for ( const auto& _checked : checked_layers )
+            grad_checks.emplace_back( net.m_layers[_checked.layer_idx]->get_gradient_checker() );
 
-            const output_ptr out_p = output();
-            float err_p = err_func( out_p, out_ref );
+        // feature maps from this layer on were last computed with a perturbed parameter
+        size_t stale_layer = net.m_layers.size();
 
-            // Compute output with -epsilon increment
-            grad_check->mod( -epsilon );
-            feed_forward();
-            back_propagate();
+        for ( size_t p = next_probe++; p < probes.size(); p = next_probe++ )
+        {
+            checked_layer& _checked = checked_layers[probes[p].first];
+            tensor_gradient_checker& grad_check = *grad_checks[probes[p].first];
+            const size_t k = probes[p].second;
+
+            // layers feeding the probed one are refreshed once restored parameters moved to a later layer
+            for ( size_t l = stale_layer; l < _checked.layer_idx; l++ )
+                net.m_layers[l]->feed_forward();
 
-            const output_ptr out_m = output();
-            float err_m = err_func( out_m, out_ref );
+            grad_check.seek( _checked.indices[k] );
+            grad_check.store();
 
-            grad_check->set_grad( ( err_p - err_m ) / ( 2.f * epsilon ) );
+            grad_check.mod( +epsilon );
+            const float loss_p = _loss( _checked.layer_idx );
 
-            // Restore weight
-            grad_check->restore();
+            grad_check.mod( -epsilon );
+            const float loss_m = _loss( _checked.layer_idx );
 
-            // switch to next parameter
-            grad_check->next();
+            grad_check.restore();
+            stale_layer = _checked.layer_idx;
 
-            clear_gradients();
+            _checked.numerical_grads[k] = ( loss_p - loss_m ) / ( 2.f * epsilon );
         }
+    };
 
-        // compute "standard" deltas
-        feed_forward();
-        back_propagate();
+    LOGGER(info) << "network::gradient_check - " << probes.size() << " parameters probed by " << threads << " threads" << std::endl;
 
-        LOGGER(info) << "network::gradient_check - layer " << _layer->type() << " gradient check error : " << grad_check->error() << std::endl;
+    {
+        thread_pool pool{ threads };
+        for ( size_t t = 0; t < threads; t++ )
+            pool.add_job( std::bind( _probe, std::ref( *m_check_networks[t] ) ) );
+        pool.wait_all();
     }
+
+    m_gradient_check_errors.clear();
+
+    for ( auto& _checked : checked_layers )
+    {
+        gradient_check_histogram histogram( resolution );
+        for ( size_t k = 0; k < _checked.indices.size(); k++ )
+        {
+            _checked.grad_check->seek( _checked.indices[k] );
+            histogram.add( _checked.grad_check->analytic_grad(), _checked.numerical_grads[k] );
+        }
+
+        const std::string type = m_layers[_checked.layer_idx]->type();
+
+        LOGGER(info) << "network::gradient_check - layer " << type << " : " << histogram.count() << "/" << _checked.grad_check->size()
+            << " parameters, mean relative error " << histogram.mean() << ", max " << histogram.max() << std::endl;
+        LOGGER(info) << "network::gradient_check - layer " << type << " relative errors : " << histogram.dump() << std::endl;
+
+        m_gradient_check_errors.push_back( histogram.max() );
+    }
+
+    clear_gradients();
+    layer::set_training( training );
 }
 
 void network::dump_image_features()
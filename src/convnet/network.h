@@ -25,6 +25,7 @@ THE SOFTWARE.
 #ifndef NETWORK_CONVNET_H
 #define NETWORK_CONVNET_H
 
+#include "common/export.h"
 #include "network_interface_convnet.h"
 
 #include <atomic>
@@ -34,9 +35,10 @@ THE SOFTWARE.
 namespace neurocl { namespace convnet {
 
 class layer;
+class tensor;
 class tensor_solver_iface;
 
-class network final : public network_interface_convnet
+class NEUROCL_PUBLIC network final : public network_interface_convnet
 {
 public:
 
@@ -56,6 +58,10 @@ public:
     void gradient_descent() override;
 	void clear_gradients() override;
 	void gradient_check( const output_ptr& out_ref ) override;
+    //! gradient check probed by given threads count, whatever the configuration
+    void gradient_check( const output_ptr& out_ref, size_t threads );
+    //! maximum relative errors of the last gradient check, per checked layer
+    const std::vector<double>& gradient_check_errors() const { return m_gradient_check_errors; }
     float loss() override;
 
 	const std::string  dump_weights() override { return "NOT IMPLEMENTED YET"; }
@@ -68,6 +74,22 @@ public:
 	const layer_ptr get_layer_ptr( const size_t layer_idx ) override;
     void set_layer_ptr( const size_t layer_idx, const layer_ptr& l ) override;
 
+    size_t training_state_size() override;
+    void get_training_state( float* state ) override;
+    void set_training_state( const float* state ) override;
+
+    bool prune( const float sparsity ) override;
+
+    //! training state tensors, solver scalars excluded
+    const std::vector<tensor*>& training_tensors() const { return m_training_tensors; }
+
+    //! check if quantization aware training is enabled
+    bool quantization_aware() const { return m_quantization_aware; }
+    //! learned input quantization scale of a weighted layer (null if not learned yet)
+    float get_layer_input_scale( const size_t layer_idx ) const;
+    //! set learned input quantization scale of a weighted layer (e.g. to resume quantization aware training)
+    void set_layer_input_scale( const size_t layer_idx, const float scale );
+
 protected:
 
     static std::atomic_size_t m_training_samples;
@@ -75,6 +97,16 @@ protected:
 	std::shared_ptr<tensor_solver_iface> m_solver;
 
     std::vector<std::shared_ptr<layer>> m_layers;
+    std::vector<layer_descr> m_layers_descr;
+
+    // training state tensors (parameters, solver caches...), in checkpoint order
+    std::vector<tensor*> m_training_tensors;
+
+    bool m_quantization_aware;
+
+    // gradient check replicas, kept for subsequent checks
+    std::vector<std::shared_ptr<network>> m_check_networks;
+    std::vector<double> m_gradient_check_errors;
 };
 
 } /*namespace neurocl*/ } /*namespace convnet*/
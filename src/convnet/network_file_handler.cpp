@@ -25,10 +25,13 @@ THE SOFTWARE.
 #include "network_file_handler.h"
 
 #include "common/network_exception.h"
+#include "network_int8.h"
+#include "network.h"
+
+#include "common/weights_file.h"
 #include "common/logger.h"
 
 #include "common/portable_binary_archive/portable_binary_iarchive.hpp"
-#include "common/portable_binary_archive/portable_binary_oarchive.hpp"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
@@ -171,6 +174,13 @@ void network_file_handler::load_network_weights( const std::string& weights_path
         return;
     }
 
+    // versioned weights file is memory mapped, legacy archive is deserialized
+    if ( weights_file::is_weights_file( weights_path ) )
+    {
+        _load_mapped_weights( weights_path );
+        return;
+    }
+
     std::ifstream input_weights( weights_path, std::ios::in | std::ios::binary );
 
     if ( input_weights.is_open() )
@@ -209,27 +219,90 @@ void network_file_handler::load_network_weights( const std::string& weights_path
     LOGGER(info) << "network_file_handler::load_network_weights - successfully loaded network weights" << std::endl;
 }
 
-void network_file_handler::save_network_weights()
+void network_file_handler::_load_mapped_weights( const std::string& weights_path )
 {
-    std::ofstream output_weights( m_weights_path, std::ios::out | std::ios::binary | std::ios::trunc );
+    std::shared_ptr<weights_file> file = std::make_shared<weights_file>( weights_path );
 
-    if ( output_weights.is_open() )
+    size_t k = 0;
+    for ( size_t i=0; i<m_layers_descr.size(); i++ )
     {
-        portable_binary_oarchive oar( output_weights, endian_little );
+        if ( !m_layers_descr[i].has_storage )
+            continue;
+
+        if ( ( k >= file->layers_count() ) || ( file->entry( k ).layer_index != i ) )
+            throw network_exception( "weights file does not match network topology" );
+
+        const weights_file_entry& entry = file->entry( k );
+
+        LOGGER(info) << "network_file_handler::load_network_weights - mapping layer" << i << " weights" << std::endl;
+
+        // parameters are copied straight from the mapped pages
+        layer_ptr lp( entry.num_weights, file->weights( k ), entry.num_bias, file->bias( k ) );
+
+        // int8 network uses quantized weights as is, float networks get them dequantized
+        std::shared_ptr<network_int8> int8_net = std::dynamic_pointer_cast<network_int8>( m_net );
+        if ( int8_net && file->quantized( k ) )
+            int8_net->set_layer_quantization( i, file->quantization( k ), lp );
+        else
+            m_net->set_layer_ptr( i, lp );
+
+        // quantization aware training resumes from the stored input scales
+        std::shared_ptr<network> float_net = std::dynamic_pointer_cast<network>( m_net );
+        if ( float_net && float_net->quantization_aware() && file->quantized( k ) )
+            float_net->set_layer_input_scale( i, file->quantization( k ).input_scale );
+
+        ++k;
+    }
+
+    if ( k != file->layers_count() )
+        throw network_exception( "weights file does not match network topology" );
 
-        for ( size_t i=0; i<m_net->count_layers(); i++ )
+    LOGGER(info) << "network_file_handler::load_network_weights - successfully loaded network weights" << std::endl;
+}
+
+void network_file_handler::save_network_weights()
+{
+    std::vector<layer_ptr> ptrs;
+    std::vector<weights_file_layer> layers;
+
+    // quantized int8 network saves its int8 weights
+    std::shared_ptr<network_int8> int8_net = std::dynamic_pointer_cast<network_int8>( m_net );
+    std::vector<weights_file_quantization> quantizations;
+    quantizations.reserve( m_net->count_layers() );
+
+    // quantization aware trained network saves int8 weights quantized with its learned input scales
+    std::shared_ptr<network> qat_net = std::dynamic_pointer_cast<network>( m_net );
+    std::unique_ptr<network_int8> qat_quantizer;
+    if ( qat_net && qat_net->quantization_aware() )
+    {
+        qat_quantizer.reset( new network_int8() );
+        qat_quantizer->add_layers( m_layers_descr );
+    }
+
+    for ( size_t i=0; i<m_net->count_layers(); i++ )
+    {
+        if ( m_layers_descr[i].has_storage )
         {
-            if ( m_layers_descr[i].has_storage )
+            LOGGER(info) << "network_file_handler::save_network_weights - saving layer" << i << " weights" << std::endl;
+            ptrs.push_back( m_net->get_layer_ptr( i ) );
+            layers.push_back( { i, ptrs.back().num_weights, ptrs.back().weights.get(), ptrs.back().num_bias, ptrs.back().bias.get() } );
+
+            if ( int8_net && int8_net->quantized() && ptrs.back().num_weights )
             {
-            	LOGGER(info) << "network_file_handler::save_network_weights - saving layer" << i << " weights" << std::endl;
-            	layer_ptr ptr = m_net->get_layer_ptr( i );
-            	layer_storage l( ptr.num_weights, ptr.weights, ptr.num_bias, ptr.bias );
-            	oar << l;
+                quantizations.push_back( int8_net->get_layer_quantization( i ) );
+                layers.back().quantization = &quantizations.back();
+            }
+            else if ( qat_quantizer && ptrs.back().num_weights && ( qat_net->get_layer_input_scale( i ) > 0.f ) )
+            {
+                qat_quantizer->set_layer_ptr( i, ptrs.back() );
+                qat_quantizer->quantize_layer( i, qat_net->get_layer_input_scale( i ) );
+                quantizations.push_back( qat_quantizer->get_layer_quantization( i ) );
+                layers.back().quantization = &quantizations.back();
             }
         }
     }
-    else
-      throw network_exception( "unable to open weights file for saving" );
+
+    weights_file::write( m_weights_path, layers, weights_file::configured_format() );
 }
 
 } /*namespace neurocl*/ } /*namespace convnet*/
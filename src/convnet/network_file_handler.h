@@ -47,6 +47,13 @@ public:
     void load_network_weights( const std::string& weights_path ) override;
     void save_network_weights() override;
 
+    //! loaded topology layers description
+    const std::vector<layer_descr>& layers_descr() const { return m_layers_descr; }
+
+private:
+
+    void _load_mapped_weights( const std::string& weights_path );
+
 private:
 
     std::vector<layer_descr> m_layers_descr;
@@ -0,0 +1,629 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "network_int8.h"
+
+#include "common/network_config.h"
+#include "common/network_exception.h"
+#include "common/logger.h"
+#include "common/profiler.h"
+#include "common/allocation_tracker.h"
+
+#include <boost/range/adaptor/reversed.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+namespace neurocl { namespace convnet {
+
+// symmetric quantization range, -128 is not used so that pairs of products cannot overflow int16
+static const float s_int8_range = 127.f;
+
+inline std::int8_t _quantize( const float value, const float inv_scale )
+{
+    const long q = std::lrint( value * inv_scale );
+    return static_cast<std::int8_t>( std::max( -127L, std::min( 127L, q ) ) );
+}
+
+inline float _dot_f32( const float* a, const float* b, const size_t n )
+{
+    float sum = 0.f;
+    for ( size_t i=0; i<n; i++ )
+        sum += a[i] * b[i];
+    return sum;
+}
+
+// int8 dot product with int32 accumulation
+inline std::int32_t _dot_s8( const std::int8_t* a, const std::int8_t* b, const size_t n )
+{
+    std::int32_t sum = 0;
+    size_t i = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+    int32x4_t _neon_sum = vdupq_n_s32( 0 );
+
+    for ( ; i + 16 <= n; i += 16 )
+    {
+        const int8x16_t _neon_a = vld1q_s8( a + i );
+        const int8x16_t _neon_b = vld1q_s8( b + i );
+
+        // widening multiply to int16, then pairwise accumulation to int32
+        int16x8_t _neon_prod = vmull_s8( vget_low_s8( _neon_a ), vget_low_s8( _neon_b ) );
+        _neon_prod = vmlal_s8( _neon_prod, vget_high_s8( _neon_a ), vget_high_s8( _neon_b ) );
+        _neon_sum = vpadalq_s16( _neon_sum, _neon_prod );
+    }
+
+    const int32x2_t _neon_half = vadd_s32( vget_low_s32( _neon_sum ), vget_high_s32( _neon_sum ) );
+    sum = vget_lane_s32( vpadd_s32( _neon_half, _neon_half ), 0 );
+
+#elif defined(__SSE2__)
+
+    __m128i _mm_sum = _mm_setzero_si128();
+
+    for ( ; i + 16 <= n; i += 16 )
+    {
+        const __m128i _mm_a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( a + i ) );
+        const __m128i _mm_b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( b + i ) );
+
+        // sign extension to int16 (SSE2 only), then multiply & pairwise add to int32
+        const __m128i _mm_a_lo = _mm_srai_epi16( _mm_unpacklo_epi8( _mm_a, _mm_a ), 8 );
+        const __m128i _mm_a_hi = _mm_srai_epi16( _mm_unpackhi_epi8( _mm_a, _mm_a ), 8 );
+        const __m128i _mm_b_lo = _mm_srai_epi16( _mm_unpacklo_epi8( _mm_b, _mm_b ), 8 );
+        const __m128i _mm_b_hi = _mm_srai_epi16( _mm_unpackhi_epi8( _mm_b, _mm_b ), 8 );
+
+        _mm_sum = _mm_add_epi32( _mm_sum, _mm_madd_epi16( _mm_a_lo, _mm_b_lo ) );
+        _mm_sum = _mm_add_epi32( _mm_sum, _mm_madd_epi16( _mm_a_hi, _mm_b_hi ) );
+    }
+
+    _mm_sum = _mm_add_epi32( _mm_sum, _mm_shuffle_epi32( _mm_sum, _MM_SHUFFLE(1,0,3,2) ) );
+    _mm_sum = _mm_add_epi32( _mm_sum, _mm_shuffle_epi32( _mm_sum, _MM_SHUFFLE(2,3,0,1) ) );
+    sum = _mm_cvtsi128_si32( _mm_sum );
+
+#endif
+
+    // end of the vector in non-dividable-by-16 size case
+    for ( ; i < n; i++ )
+        sum += static_cast<std::int32_t>( a[i] ) * static_cast<std::int32_t>( b[i] );
+
+    return sum;
+}
+
+// gather convolution patches (im2col), one row of depth x filter x filter values per output position
+template<typename T>
+void _gather_patches( const T* in, const size_t in_width, const size_t in_height, const size_t in_depth,
+    const size_t width, const size_t height, const size_t filter, T* patches )
+{
+    for ( auto i = size_t(0); i < width; i++ )
+        for ( auto j = size_t(0); j < height; j++ )
+            for ( auto d1 = size_t(0); d1 < in_depth; d1++ )
+            {
+                const T* _in = in + d1 * in_width * in_height + i * in_height + j;
+                for ( auto a = size_t(0); a < filter; a++ )
+                    patches = std::copy( _in + a * in_height, _in + a * in_height + filter, patches );
+            }
+}
+
+// max pooling, sampling positions are the same as tensor_operation::subsample
+template<typename T>
+void _max_pool( const T* in, const size_t in_width, const size_t in_height,
+    const size_t width, const size_t height, const size_t depth, const size_t subsample, T* out )
+{
+    for ( auto d = size_t(0); d < depth; d++ )
+        for ( auto x = size_t(0); x < width; x++ )
+            for ( auto y = size_t(0); y < height; y++ )
+            {
+                const T* _in = in + d * in_width * in_height + x * subsample * in_height + y * subsample;
+                T max_value = std::numeric_limits<T>::lowest();
+                for ( auto j = size_t(0); j < subsample; j++ )
+                    for ( auto i = size_t(0); i < subsample; i++ )
+                        max_value = std::max( max_value, _in[i + j * in_width] );
+                *out++ = max_value;
+            }
+}
+
+inline void _softmax( std::vector<float>& values )
+{
+    const float alpha = *std::max_element( values.begin(), values.end() );
+    float denom = 0.f;
+    for ( auto& value : values )
+    {
+        value = std::exp( value - alpha );
+        denom += value;
+    }
+    for ( auto& value : values )
+        value /= denom;
+}
+
+network_int8::network_int8() : m_quantized( false ), m_per_channel( true )
+{
+    network_config::instance().update_optional( "quantization_per_channel", m_per_channel );
+}
+
+void network_int8::add_layers( const std::vector<layer_descr>& layers )
+{
+    m_layers.clear();
+    m_quantized = false;
+
+    for ( auto& _layer : layers )
+    {
+        layer_int8 l;
+        l.type = _layer.type;
+        l.width = _layer.sizeX;
+        l.height = _layer.sizeY;
+        l.depth = _layer.sizeZ;
+        l.filter = _layer.sizeF;
+        l.channels = 0;
+        l.row_size = 0;
+        l.in_scale = 1.f;
+        l.out_scale = 1.f;
+        l.quantized = false;
+
+        if ( ( l.type != INPUT_LAYER ) && m_layers.empty() )
+            throw network_exception( "first layer should be an input layer" );
+
+        switch( l.type )
+        {
+        case INPUT_LAYER:
+            break;
+        case CONV_LAYER:
+            {
+                const layer_int8& prev = m_layers.back();
+                if ( ( l.width != ( prev.width - l.filter + 1 ) ) || ( l.height != ( prev.height - l.filter + 1 ) ) )
+                    throw network_exception( "inconsistent convolutional layer size" );
+                l.channels = l.depth;
+                l.row_size = prev.depth * l.filter * l.filter;
+                l.bias.resize( l.size() );
+                l.f_patches.resize( l.width * l.height * l.row_size );
+                l.q_patches.resize( l.width * l.height * l.row_size );
+            }
+            break;
+        case POOL_LAYER:
+            {
+                const layer_int8& prev = m_layers.back();
+                if ( ( prev.width % l.width ) != 0 )
+                    throw network_exception( "invalid subsampling for max pooling" );
+                l.filter = prev.width / l.width;
+            }
+            break;
+        case DROPOUT_LAYER:
+            break;
+        case FULL_LAYER:
+        case OUTPUT_LAYER:
+            {
+                // replicated feature maps are not managed, previous maps are grouped
+                if ( l.depth > 1 )
+                    throw network_exception( "full layer depth not managed by int8 network" );
+                l.channels = l.size();
+                l.row_size = m_layers.back().size();
+                l.bias.resize( l.size() );
+            }
+            break;
+        }
+
+        l.weights.resize( l.channels * l.row_size );
+        l.q_weights.resize( l.weights.size() );
+        l.q_rows.resize( l.weights.size() );
+        l.f_rows.resize( l.weights.size() );
+        l.w_scales.resize( l.channels, 1.f );
+        l.f_maps.resize( l.size() );
+        l.q_maps.resize( l.size() );
+
+        m_layers.push_back( l );
+    }
+
+    LOGGER(info) << "network_int8::add_layers - " << m_layers.size() << " layers, " << ( m_per_channel ? "per channel" : "per layer" ) << " weights quantization" << std::endl;
+}
+
+void network_int8::set_training( bool training )
+{
+    if ( training )
+        throw network_exception( "int8 network is inference only" );
+}
+
+void network_int8::set_input(  const size_t& in_size, const float* in )
+{
+    if ( in_size > m_layers.front().size() )
+        throw network_exception( "sample size exceeds allocated layer size!" );
+
+    std::copy( in, in + in_size, m_layers.front().f_maps.begin() );
+}
+
+void network_int8::set_output( const size_t& out_size, const float* out )
+{
+    throw network_exception( "int8 network is inference only" );
+}
+
+const output_ptr network_int8::output()
+{
+    const std::vector<float>& _outputs = m_layers.back().f_maps;
+
+    output_ptr o( _outputs.size() );
+    std::copy( _outputs.begin(), _outputs.end(), o.outputs.get() );
+
+    return o;
+}
+
+void network_int8::feed_forward()
+{
+    if ( !m_quantized )
+        throw network_exception( "int8 network is not quantized (calibration or int8 weights file required)" );
+
+    _forward_int8();
+}
+
+void network_int8::back_propagate()
+{
+    throw network_exception( "int8 network is inference only" );
+}
+
+void network_int8::gradient_descent()
+{
+    throw network_exception( "int8 network is inference only" );
+}
+
+void network_int8::clear_gradients()
+{
+    throw network_exception( "int8 network is inference only" );
+}
+
+void network_int8::gradient_check( const output_ptr& out_ref )
+{
+    throw network_exception( "int8 network is inference only" );
+}
+
+float network_int8::loss()
+{
+    throw network_exception( "int8 network is inference only" );
+}
+
+network_int8::layer_int8& network_int8::_layer( const size_t layer_idx )
+{
+    if ( layer_idx >= m_layers.size() )
+    {
+        LOGGER(error) << "network_int8::_layer - cannot access layer " << layer_idx << std::endl;
+        throw network_exception( "invalid layer index" );
+    }
+
+    return m_layers[layer_idx];
+}
+
+void network_int8::_row_position( const layer_int8& l, const size_t k, size_t& row, size_t& pos ) const
+{
+    if ( l.type == CONV_LAYER )
+    {
+        // filters are stored by input map then output map, and flipped for feed forward
+        const size_t _filter_size = l.filter * l.filter;
+        const size_t _block = k / _filter_size;
+        row = _block % l.channels;
+        pos = ( _block / l.channels ) * _filter_size + ( _filter_size - 1 - ( k % _filter_size ) );
+    }
+    else
+    {
+        row = k / l.row_size;
+        pos = k % l.row_size;
+    }
+}
+
+const layer_ptr network_int8::get_layer_ptr( const size_t layer_idx )
+{
+    const layer_int8& l = _layer( layer_idx );
+
+    layer_ptr lp( l.weights.size(), l.bias.size() );
+    std::copy( l.weights.begin(), l.weights.end(), lp.weights.get() );
+    std::copy( l.bias.begin(), l.bias.end(), lp.bias.get() );
+
+    return lp;
+}
+
+void network_int8::set_layer_ptr( const size_t layer_idx, const layer_ptr& lp )
+{
+    layer_int8& l = _layer( layer_idx );
+
+    if ( ( l.weights.size() != lp.num_weights ) || ( l.bias.size() != lp.num_bias ) )
+    {
+        LOGGER(error) << "network_int8::set_layer_ptr - inconsistent layer " << layer_idx << " size" << std::endl;
+        throw network_exception( "inconsistent layer size" );
+    }
+
+    std::copy( lp.weights.get(), lp.weights.get() + lp.num_weights, l.weights.begin() );
+    std::copy( lp.bias.get(), lp.bias.get() + lp.num_bias, l.bias.begin() );
+
+    size_t row, pos;
+    for ( size_t k=0; k<l.weights.size(); k++ )
+    {
+        _row_position( l, k, row, pos );
+        l.f_rows[row * l.row_size + pos] = l.weights[k];
+    }
+
+    // float parameters have to be calibrated again
+    if ( l.weighted() )
+    {
+        l.quantized = false;
+        m_quantized = false;
+    }
+}
+
+weights_file_quantization network_int8::get_layer_quantization( const size_t layer_idx ) const
+{
+    if ( ( layer_idx >= m_layers.size() ) || !m_layers[layer_idx].weighted() || !m_layers[layer_idx].quantized )
+        throw network_exception( "layer is not quantized" );
+
+    const layer_int8& l = m_layers[layer_idx];
+
+    weights_file_quantization q;
+    q.channels = l.channels;
+    q.channel_stride = ( l.type == CONV_LAYER ) ? ( l.filter * l.filter ) : l.row_size;
+    q.input_scale = l.in_scale;
+    q.scales = l.w_scales;
+    q.weights = l.q_weights.data();
+
+    return q;
+}
+
+void network_int8::set_layer_quantization( const size_t layer_idx, const weights_file_quantization& q, const layer_ptr& lp )
+{
+    set_layer_ptr( layer_idx, lp );
+
+    layer_int8& l = m_layers[layer_idx];
+
+    const size_t channel_stride = ( l.type == CONV_LAYER ) ? ( l.filter * l.filter ) : l.row_size;
+
+    if ( !l.weighted() || ( q.channels != l.channels ) || ( q.channel_stride != channel_stride ) || ( q.input_scale <= 0.f ) )
+    {
+        LOGGER(error) << "network_int8::set_layer_quantization - inconsistent layer " << layer_idx << " quantization" << std::endl;
+        throw network_exception( "quantization does not match network topology" );
+    }
+
+    l.in_scale = q.input_scale;
+    l.w_scales = q.scales;
+    std::copy( q.weights, q.weights + l.q_weights.size(), l.q_weights.begin() );
+
+    size_t row, pos;
+    for ( size_t k=0; k<l.q_weights.size(); k++ )
+    {
+        _row_position( l, k, row, pos );
+        l.q_rows[row * l.row_size + pos] = l.q_weights[k];
+    }
+
+    l.quantized = true;
+
+    _update_scales();
+}
+
+void network_int8::quantize_layer( const size_t layer_idx, const float input_scale )
+{
+    layer_int8& l = _layer( layer_idx );
+
+    if ( !l.weighted() || ( input_scale <= 0.f ) )
+    {
+        LOGGER(error) << "network_int8::quantize_layer - cannot quantize layer " << layer_idx << std::endl;
+        throw network_exception( "invalid layer quantization" );
+    }
+
+    _quantize_layer( l, input_scale );
+    _update_scales();
+}
+
+void network_int8::_quantize_layer( layer_int8& l, const float in_scale )
+{
+    // symmetric scales : per output channel (weights row) or per layer
+    std::vector<float> max_abs( l.channels, 0.f );
+    for ( size_t r=0; r<l.channels; r++ )
+        for ( size_t p=0; p<l.row_size; p++ )
+            max_abs[r] = std::max( max_abs[r], std::fabs( l.f_rows[r * l.row_size + p] ) );
+
+    if ( !m_per_channel )
+        std::fill( max_abs.begin(), max_abs.end(), *std::max_element( max_abs.begin(), max_abs.end() ) );
+
+    for ( size_t r=0; r<l.channels; r++ )
+        l.w_scales[r] = std::max( max_abs[r], std::numeric_limits<float>::epsilon() ) / s_int8_range;
+
+    size_t row, pos;
+    for ( size_t k=0; k<l.weights.size(); k++ )
+    {
+        _row_position( l, k, row, pos );
+        l.q_weights[k] = _quantize( l.weights[k], 1.f / l.w_scales[row] );
+        l.q_rows[row * l.row_size + pos] = l.q_weights[k];
+    }
+
+    l.in_scale = in_scale;
+    l.quantized = true;
+}
+
+void network_int8::_update_scales()
+{
+    m_quantized = true;
+
+    // feature maps are requantized with the input scale of the next weighted layer, pooling & dropout keep it
+    float next_scale = 1.f;
+    for ( auto& _layer : boost::adaptors::reverse( m_layers ) )
+    {
+        _layer.out_scale = next_scale;
+        if ( _layer.weighted() )
+        {
+            m_quantized = m_quantized && _layer.quantized;
+            next_scale = _layer.in_scale;
+        }
+    }
+}
+
+void network_int8::calibrate( const size_t& samples_size, const size_t& in_size, const float* in )
+{
+    if ( !samples_size )
+        throw network_exception( "empty calibration samples set" );
+
+    // weighted layers input ranges, given by the float reference pass
+    std::vector<float> max_abs( m_layers.size(), 0.f );
+
+    for ( size_t s=0; s<samples_size; s++ )
+    {
+        set_input( in_size, in + s * in_size );
+        _forward_float();
+
+        for ( size_t i=1; i<m_layers.size(); i++ )
+        {
+            if ( !m_layers[i].weighted() )
+                continue;
+
+            for ( const auto& value : m_layers[i-1].f_maps )
+                max_abs[i] = std::max( max_abs[i], std::fabs( value ) );
+        }
+    }
+
+    for ( size_t i=1; i<m_layers.size(); i++ )
+    {
+        if ( !m_layers[i].weighted() )
+            continue;
+
+        _quantize_layer( m_layers[i], std::max( max_abs[i], std::numeric_limits<float>::epsilon() ) / s_int8_range );
+
+        LOGGER(info) << "network_int8::calibrate - layer " << i << " input range " << max_abs[i] << std::endl;
+    }
+
+    _update_scales();
+
+    LOGGER(info) << "network_int8::calibrate - calibrated on " << samples_size << " samples" << std::endl;
+}
+
+void network_int8::_forward_float()
+{
+    for ( size_t i=1; i<m_layers.size(); i++ )
+    {
+        const layer_int8& prev = m_layers[i-1];
+        layer_int8& l = m_layers[i];
+
+        switch( l.type )
+        {
+        case CONV_LAYER:
+            {
+                _gather_patches( prev.f_maps.data(), prev.width, prev.height, prev.depth, l.width, l.height, l.filter, l.f_patches.data() );
+
+                const size_t _positions = l.width * l.height;
+                for ( size_t d2=0; d2<l.depth; d2++ )
+                    for ( size_t p=0; p<_positions; p++ )
+                    {
+                        const size_t o = d2 * _positions + p;
+                        l.f_maps[o] = std::max( 0.f, _dot_f32( &l.f_rows[d2 * l.row_size], &l.f_patches[p * l.row_size], l.row_size ) + l.bias[o] );
+                    }
+            }
+            break;
+        case POOL_LAYER:
+            _max_pool( prev.f_maps.data(), prev.width, prev.height, l.width, l.height, l.depth, l.filter, l.f_maps.data() );
+            break;
+        case DROPOUT_LAYER:
+            l.f_maps = prev.f_maps;
+            break;
+        case FULL_LAYER:
+        case OUTPUT_LAYER:
+            for ( size_t r=0; r<l.channels; r++ )
+                l.f_maps[r] = _dot_f32( &l.f_rows[r * l.row_size], prev.f_maps.data(), l.row_size ) + l.bias[r];
+
+            if ( l.type == OUTPUT_LAYER )
+                _softmax( l.f_maps );
+            else
+                for ( auto& value : l.f_maps )
+                    value = std::max( 0.f, value );
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void network_int8::_forward_int8()
+{
+    // input quantization
+    {
+        layer_int8& in = m_layers.front();
+        const float inv_scale = 1.f / in.out_scale;
+        for ( size_t k=0; k<in.f_maps.size(); k++ )
+            in.q_maps[k] = _quantize( in.f_maps[k], inv_scale );
+    }
+
+    for ( size_t i=1; i<m_layers.size(); i++ )
+    {
+        const layer_int8& prev = m_layers[i-1];
+        layer_int8& l = m_layers[i];
+
+        PROFILE_SCOPE( "int8 layer" + std::to_string( i ), "feed_forward" );
+        ALLOCATION_SCOPE( "int8 layer" + std::to_string( i ), "feed_forward" );
+
+        const float inv_out_scale = 1.f / l.out_scale;
+
+        switch( l.type )
+        {
+        case CONV_LAYER:
+            {
+                _gather_patches( prev.q_maps.data(), prev.width, prev.height, prev.depth, l.width, l.height, l.filter, l.q_patches.data() );
+
+                const size_t _positions = l.width * l.height;
+                for ( size_t d2=0; d2<l.depth; d2++ )
+                {
+                    const float _scale = l.in_scale * l.w_scales[d2];
+                    for ( size_t p=0; p<_positions; p++ )
+                    {
+                        const size_t o = d2 * _positions + p;
+                        const std::int32_t acc = _dot_s8( &l.q_rows[d2 * l.row_size], &l.q_patches[p * l.row_size], l.row_size );
+                        l.q_maps[o] = _quantize( std::max( 0.f, acc * _scale + l.bias[o] ), inv_out_scale );
+                    }
+                }
+            }
+            break;
+        case POOL_LAYER:
+            _max_pool( prev.q_maps.data(), prev.width, prev.height, l.width, l.height, l.depth, l.filter, l.q_maps.data() );
+            break;
+        case DROPOUT_LAYER:
+            l.q_maps = prev.q_maps;
+            break;
+        case FULL_LAYER:
+            for ( size_t r=0; r<l.channels; r++ )
+            {
+                const std::int32_t acc = _dot_s8( &l.q_rows[r * l.row_size], prev.q_maps.data(), l.row_size );
+                l.q_maps[r] = _quantize( std::max( 0.f, acc * l.in_scale * l.w_scales[r] + l.bias[r] ), inv_out_scale );
+            }
+            break;
+        case OUTPUT_LAYER:
+            // output layer is dequantized for softmax
+            for ( size_t r=0; r<l.channels; r++ )
+            {
+                const std::int32_t acc = _dot_s8( &l.q_rows[r * l.row_size], prev.q_maps.data(), l.row_size );
+                l.f_maps[r] = acc * l.in_scale * l.w_scales[r] + l.bias[r];
+            }
+            _softmax( l.f_maps );
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+} /*namespace neurocl*/ } /*namespace convnet*/
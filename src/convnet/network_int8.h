@@ -0,0 +1,139 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef NETWORK_INT8_CONVNET_H
+#define NETWORK_INT8_CONVNET_H
+
+#include "network_interface_convnet.h"
+
+#include "common/weights_file.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace neurocl { namespace convnet {
+
+/**
+ *  Post-training int8 quantized convnet, inference only : conv & full layers run int8 dot products with
+ *  int32 accumulation, pooling runs on int8 feature maps. Weights are quantized symmetrically per output
+ *  channel (or per layer), activations per tensor, using scales calibrated on a samples set with a float
+ *  reference pass. Quantization is either calibrated or loaded from an int8 weights file.
+ */
+class network_int8 final : public network_interface_convnet
+{
+public:
+
+    network_int8();
+    virtual ~network_int8() {}
+
+    void add_layers( const std::vector<layer_descr>& layers ) override;
+
+    void set_training( bool training ) override;
+
+    void set_input(  const size_t& in_size, const float* in ) override;
+    void set_output( const size_t& out_size, const float* out ) override;
+    const output_ptr output() override;
+
+    void feed_forward() override;
+    void back_propagate() override;
+    void gradient_descent() override;
+    void clear_gradients() override;
+    void gradient_check( const output_ptr& out_ref ) override;
+    float loss() override;
+
+    void calibrate( const size_t& samples_size, const size_t& in_size, const float* in ) override;
+
+    const std::string  dump_weights() override { return "NOT IMPLEMENTED YET"; }
+    const std::string  dump_bias() override { return "NOT IMPLEMENTED YET"; }
+    const std::string  dump_activations() override { return "NOT IMPLEMENTED YET"; }
+
+    const size_t count_layers() override { return m_layers.size(); }
+    const layer_ptr get_layer_ptr( const size_t layer_idx ) override;
+    void set_layer_ptr( const size_t layer_idx, const layer_ptr& l ) override;
+
+    //! check if network is quantized (calibrated or loaded from an int8 weights file)
+    bool quantized() const { return m_quantized; }
+
+    //! layer quantization (weights pointing to layer storage), layer must have weights
+    weights_file_quantization get_layer_quantization( const size_t layer_idx ) const;
+    //! set layer quantization and bias (all weighted layers have to be set for the network to be quantized)
+    void set_layer_quantization( const size_t layer_idx, const weights_file_quantization& q, const layer_ptr& l );
+    //! quantize layer float weights, using a given input scale (e.g. learned by quantization aware training)
+    void quantize_layer( const size_t layer_idx, const float input_scale );
+
+private:
+
+    struct layer_int8
+    {
+        layer_type type;
+
+        size_t width;
+        size_t height;
+        size_t depth;
+        size_t filter;      // conv filter size, pool subsampling ratio
+
+        size_t channels;    // weights rows : output maps (conv) or output neurons (full)
+        size_t row_size;    // weights row size (dot product length)
+
+        std::vector<float> weights;         // float weights, in layer_ptr order
+        std::vector<float> bias;
+        std::vector<float> f_rows;          // float weights, packed by rows
+        std::vector<std::int8_t> q_weights; // quantized weights, in layer_ptr order
+        std::vector<std::int8_t> q_rows;    // quantized weights, packed by rows
+        std::vector<float> w_scales;        // rows weights scales
+        float in_scale;                     // input activations scale
+        float out_scale;                    // output activations scale (next weighted layer input scale)
+        bool quantized;
+
+        std::vector<float> f_maps;          // float feature maps (reference pass, output layer)
+        std::vector<std::int8_t> q_maps;    // int8 feature maps
+        std::vector<float> f_patches;       // conv patches (im2col buffers)
+        std::vector<std::int8_t> q_patches;
+
+        size_t size() const { return width * height * depth; }
+        bool weighted() const { return ( type == CONV_LAYER ) || ( type == FULL_LAYER ) || ( type == OUTPUT_LAYER ); }
+    };
+
+    layer_int8& _layer( const size_t layer_idx );
+
+    // row index of a weight given in layer_ptr order, and its position in the row
+    void _row_position( const layer_int8& l, const size_t k, size_t& row, size_t& pos ) const;
+
+    void _quantize_layer( layer_int8& l, const float in_scale );
+    void _update_scales();
+
+    void _forward_float();
+    void _forward_int8();
+
+private:
+
+    bool m_quantized;
+    bool m_per_channel;
+
+    std::vector<layer_int8> m_layers;
+};
+
+} /*namespace neurocl*/ } /*namespace convnet*/
+
+#endif //NETWORK_INT8_CONVNET_H
@@ -26,8 +26,14 @@ THE SOFTWARE.
 #define NETWORK_MANAGER_CONVNET_H
 
 #include "network_parallel.h"
+#include "network_int8.h"
 #include "network_file_handler.h"
 
+#ifdef VEXCL_ENABLED
+    #include "network_vexcl.h"
+#endif
+
+#include "common/backend_selector.h"
 #include "common/network_manager.h"
 
 #include <thread>
@@ -41,22 +47,34 @@ public:
 	enum class t_convnet_impl
     {
         CONVNET = 0,
-		CONVNET_PARALLEL
+		CONVNET_PARALLEL,
+		CONVNET_VEXCL,
+		CONVNET_AUTO, // fastest available implementation, selected when loading topology
+		CONVNET_INT8 // int8 quantized inference
     };
 
 private:
 
 	friend network_factory;
 
-	static std::shared_ptr<network_manager_interface> create( const t_convnet_impl& impl )
+	static std::shared_ptr<network_manager_interface> create( const t_convnet_impl& impl, const size_t parallel_tasks = 0 )
 	{
 		struct make_shared_enabler : public network_manager_convnet {
-			make_shared_enabler( const t_convnet_impl& impl ) : network_manager_convnet( impl ) {}
+			make_shared_enabler( const t_convnet_impl& impl, const size_t parallel_tasks )
+				: network_manager_convnet( impl, parallel_tasks ) {}
 		};
-		return std::make_shared<make_shared_enabler>( impl );
+		return std::make_shared<make_shared_enabler>( impl, parallel_tasks );
 	}
 
-    network_manager_convnet( const t_convnet_impl& impl )
+    network_manager_convnet( const t_convnet_impl& impl, const size_t parallel_tasks )
+		: m_impl( impl ), m_parallel_tasks( parallel_tasks ? parallel_tasks : std::thread::hardware_concurrency()+1 )
+	{
+		// automatic implementation is built once topology is known
+		if ( impl != t_convnet_impl::CONVNET_AUTO )
+			_build( impl );
+	}
+
+	void _build( const t_convnet_impl& impl )
 	{
 		switch( impl )
 		{
@@ -64,8 +82,18 @@ private:
 	        m_net = std::make_shared<network>();
 	        break;
 		case t_convnet_impl::CONVNET_PARALLEL:
-		    m_net = std::make_shared<network_parallel>( std::thread::hardware_concurrency()+1 );
+		    m_net = std::make_shared<network_parallel>( m_parallel_tasks );
+		    break;
+		case t_convnet_impl::CONVNET_INT8:
+		    m_net = std::make_shared<network_int8>();
 		    break;
+		case t_convnet_impl::CONVNET_VEXCL:
+	#ifdef VEXCL_ENABLED
+		    m_net = std::make_shared<network_vexcl>();
+		    break;
+	#else
+		    throw network_exception( "unmanaged convnet implementation (opencl disabled)!" );
+	#endif
 	    default:
 	        throw network_exception( "unmanaged convnet implementation!" );
 		}
@@ -74,9 +102,80 @@ private:
 			std::static_pointer_cast<network_interface_convnet>( m_net ) );
 	}
 
+	t_convnet_impl _select_impl( const std::string& topology_path )
+	{
+		auto _bench_fct = [this,&topology_path]( const t_convnet_impl& impl )
+		{
+			// benchmark tensors are released from the tank, so that they are not accumulated with the selected network ones
+			if ( ( impl == t_convnet_impl::CONVNET_PARALLEL ) && scoped_tensor_tank::shared_in_use() )
+				throw network_exception( "shared tensor tank is already in use by another parallel network" );
+
+			scoped_tensor_tank _scoped_tank;
+
+			// network is destroyed (end of measure) before its tensors are released
+			auto _measure = [this,&topology_path,&impl]()
+			{
+				std::shared_ptr<network_interface_convnet> net;
+				switch( impl )
+				{
+				case t_convnet_impl::CONVNET_PARALLEL:
+					net = std::make_shared<network_parallel>( m_parallel_tasks );
+					break;
+	#ifdef VEXCL_ENABLED
+				case t_convnet_impl::CONVNET_VEXCL:
+					net = std::make_shared<network_vexcl>();
+					break;
+	#endif
+				default:
+					net = std::make_shared<network>();
+					break;
+				}
+
+				network_file_handler file_handler( net );
+				file_handler.load_network_topology( topology_path );
+
+				return backend_selector::measure_training( *net,
+					file_handler.layers_descr().front().size(), file_handler.layers_descr().back().size() );
+			};
+
+			return _measure();
+		};
+
+		std::vector<backend_selector::candidate> candidates = {
+			{ "DEFAULT", std::bind( _bench_fct, t_convnet_impl::CONVNET ) },
+			{ "PARALLEL", std::bind( _bench_fct, t_convnet_impl::CONVNET_PARALLEL ) } };
+	#ifdef VEXCL_ENABLED
+		candidates.push_back( { "VEXCL", std::bind( _bench_fct, t_convnet_impl::CONVNET_VEXCL ) } );
+	#endif
+
+		backend_selector selector( "CONVNET", topology_path );
+		const std::string selected = selector.select( candidates );
+
+		if ( selected == "PARALLEL" )
+			return t_convnet_impl::CONVNET_PARALLEL;
+		else if ( selected == "VEXCL" )
+			return t_convnet_impl::CONVNET_VEXCL;
+		else
+			return t_convnet_impl::CONVNET;
+	}
+
 public:
 
 	virtual ~network_manager_convnet() {}
+
+	//! load network topology & weights, selecting implementation first if automatic
+	void load_network( const std::string& topology_path, const std::string& weights_path ) override
+	{
+		if ( m_impl == t_convnet_impl::CONVNET_AUTO )
+			_build( _select_impl( topology_path ) );
+
+		network_manager::load_network( topology_path, weights_path );
+	}
+
+private:
+
+	const t_convnet_impl m_impl;
+	const size_t m_parallel_tasks;
 };
 
 } /*namespace neurocl*/ } /*namespace convnet*/
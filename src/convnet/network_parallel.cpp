@@ -29,8 +29,24 @@ THE SOFTWARE.
 
 #include "common/thread_pool.h"
 
+#include <algorithm>
+
 namespace neurocl { namespace convnet {
 
+scoped_tensor_tank::scoped_tensor_tank() : m_marker( new tensor_tank_marker( tensor_tank::instance().mark() ) )
+{
+}
+
+scoped_tensor_tank::~scoped_tensor_tank()
+{
+    tensor_tank::instance().release( *m_marker );
+}
+
+bool scoped_tensor_tank::shared_in_use()
+{
+    return !tensor_tank::instance().shared_empty();
+}
+
 network_parallel::network_parallel( const size_t tasks_size )
     : m_tasks_size( tasks_size ), m_current_net( 0 )
 {
@@ -73,6 +89,18 @@ void network_parallel::add_layers( const std::vector<layer_descr>& layers )
         LOGGER(info) << "network_parallel::add_layers - adding layers for net #" << i++ << "(" << &_network << ")" << std::endl;
         _network.add_layers( layers );
     }
+
+    const std::vector<tensor*>& shared_tensors = m_networks.at(0).training_tensors();
+
+    m_private_tensors.clear();
+    for ( size_t i = 1; i < m_networks.size(); i++ )
+    {
+        for ( const auto _tensor : m_networks[i].training_tensors() )
+        {
+            if ( std::find( shared_tensors.begin(), shared_tensors.end(), _tensor ) == shared_tensors.end() )
+                m_private_tensors.push_back( _tensor );
+        }
+    }
 }
 
 void network_parallel::set_input(  const size_t& in_size, const float* in )
@@ -108,6 +136,46 @@ void network_parallel::set_layer_ptr( const size_t layer_idx, const layer_ptr& l
     }
 }
 
+// NOTE : parameters & solver caches are shared between networks, the first one drives the gradient descent
+size_t network_parallel::training_state_size()
+{
+    size_t size = m_networks.at(0).training_state_size();
+    for ( const auto _tensor : m_private_tensors )
+        size += _tensor->size();
+
+    return size;
+}
+
+void network_parallel::get_training_state( float* state )
+{
+    m_networks.at(0).get_training_state( state );
+    state += m_networks.at(0).training_state_size();
+
+    for ( const auto _tensor : m_private_tensors )
+    {
+        _tensor->grouped_fill( state );
+        state += _tensor->size();
+    }
+}
+
+void network_parallel::set_training_state( const float* state )
+{
+    m_networks.at(0).set_training_state( state );
+    state += m_networks.at(0).training_state_size();
+
+    for ( const auto _tensor : m_private_tensors )
+    {
+        _tensor->grouped_fill( _tensor->size(), state );
+        state += _tensor->size();
+    }
+}
+
+bool network_parallel::prune( const float sparsity )
+{
+    // masks of the first network are enough, as it drives the gradient descent
+    return m_networks.at(0).prune( sparsity );
+}
+
 const output_ptr network_parallel::output()
 {
     return m_networks.at(0).output();
@@ -126,7 +194,14 @@ void network_parallel::feed_forward()
     if ( layer::get_training() )
     {
         m_thread_pool->add_job( m_parallel_jobs.at( m_current_net++ ) );
-        m_current_net = ( m_current_net == m_tasks_size ) ? 0 : m_current_net;
+
+        // replicas inputs are overwritten at next round : pending jobs have to be processed first,
+        // otherwise a replica could train twice on the same sample (and runs are not reproducible)
+        if ( m_current_net == m_tasks_size )
+        {
+            m_thread_pool->wait_all();
+            m_current_net = 0;
+        }
     }
     else
         _feed_back( 0 );
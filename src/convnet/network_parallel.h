@@ -39,6 +39,22 @@ class thread_pool;
 namespace convnet {
 
 class tensor_solver_iface;
+struct tensor_tank_marker;
+
+// tensors emplaced in the tank during the scope lifetime are released at its end,
+// the networks using them have to be destroyed first (used by temporary benchmark networks)
+class scoped_tensor_tank
+{
+public:
+	scoped_tensor_tank();
+	virtual ~scoped_tensor_tank();
+
+	//! shared tensors are in use by a parallel network
+	static bool shared_in_use();
+
+private:
+	std::unique_ptr<tensor_tank_marker> m_marker;
+};
 
 #define MAX_PARRALLEL_TASKS 10
 
@@ -72,6 +88,12 @@ public:
 	const layer_ptr get_layer_ptr( const size_t layer_idx ) override;
     void set_layer_ptr( const size_t layer_idx, const layer_ptr& l ) override;
 
+    size_t training_state_size() override;
+    void get_training_state( float* state ) override;
+    void set_training_state( const float* state ) override;
+
+    bool prune( const float sparsity ) override;
+
 private:
 
 	void _feed_back( const size_t i );
@@ -88,6 +110,9 @@ private:
 	std::shared_ptr<tensor_solver_iface> m_solver;
 	std::vector<network> m_networks;
 
+	// training state tensors not shared with the first network (dropout masks...)
+	std::vector<tensor*> m_private_tensors;
+
 	std::array<std::mutex,MAX_PARRALLEL_TASKS> m_mutex;
 };
 
@@ -0,0 +1,1102 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "network_vexcl.h"
+#include "tensor_solver.h"
+
+#include "common/vexcl_context.h"
+#include "common/network_config.h"
+#include "common/network_exception.h"
+#include "common/network_random.h"
+
+#include <boost/range/adaptor/reversed.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+
+namespace neurocl { namespace convnet {
+
+using vexF = vex::vector<float>;
+using vexI = vex::vector<int>;
+
+namespace {
+
+void random_normal_init( vexF& container, const float stddev = 1.f )
+{
+    random::rand_gaussian_generator rgg( 0.f, stddev );
+
+    std::vector<float> arand( container.size() );
+    for ( auto& _rand : arand )
+        _rand = rgg();
+
+    vex::copy( arand, container );
+}
+
+// one random value per feature map, uniform over the map because of parameters sharing
+void uniform_random_init( vexF& container, const size_t map_size, const float stddev = 1.f )
+{
+    random::rand_gaussian_generator rgg( 0.f, stddev );
+
+    std::vector<float> arand( container.size() );
+    for ( size_t i=0; i<arand.size(); i+=map_size )
+        std::fill( arand.begin() + i, arand.begin() + i + map_size, rgg() );
+
+    vex::copy( arand, container );
+}
+
+vexF zero_vector( const size_t size )
+{
+    vexF v( my_vex_ctx::instance().get(), size );
+    if ( size ) v = 0.f;
+    return v;
+}
+
+vexI index_vector( const std::vector<int>& indexes )
+{
+    return vexI( my_vex_ctx::instance().get(), indexes );
+}
+
+} // anonymous namespace
+
+/****************************************************************************/
+/* SOLVERS                                                                  */
+/****************************************************************************/
+
+// solver operators on device vectors
+class vexcl_operation
+{
+public:
+
+    template<typename Expr>
+    static auto sqrt( const Expr& e ) -> decltype( vex::sqrt( e ) )
+    {
+        return vex::sqrt( e );
+    }
+
+    // element wise max( decay * A, |B| )
+    template<typename ExprA, typename ExprB>
+    static auto decayed_max_abs( const ExprA& a, const ExprB& b, const float decay ) -> decltype( vex::fmax( decay * a, vex::fabs( b ) ) )
+    {
+        return vex::fmax( decay * a, vex::fabs( b ) );
+    }
+};
+
+class vexcl_solver_iface
+{
+public:
+    virtual ~vexcl_solver_iface() {}
+
+    virtual void set_size( const size_t& size ) = 0;
+    virtual size_t get_cache_size() = 0;
+
+    virtual void update( vexF& input, vexF** input_cache, const vexF& gradient ) = 0;
+    virtual void update_redux( vexF& input, vexF** input_cache, const vexF& gradient ) = 0;
+};
+
+template<class solverT>
+class vexcl_solver : public vexcl_solver_iface
+{
+public:
+
+    vexcl_solver()
+    {
+        m_solver = std::make_shared<solverT>();
+        m_solver->register_for_scheduling();
+
+        const network_config& nc = network_config::instance();
+        nc.update_set_optional<std::reference_wrapper<float>>( m_solver->get_parameters_map(), "solver.<xmlattr>" );
+    }
+    virtual ~vexcl_solver() {}
+
+    void set_size( const size_t& size ) override
+    {
+        m_solver->set_size( size );
+    }
+
+    size_t get_cache_size() override
+    {
+        return m_solver->get_cache_size();
+    }
+
+    void update( vexF& input, vexF** input_cache, const vexF& gradient ) override
+    {
+        m_solver->update( input, input_cache, gradient );
+    }
+
+    void update_redux( vexF& input, vexF** input_cache, const vexF& gradient ) override
+    {
+        m_solver->update_redux( input, input_cache, gradient );
+    }
+
+private:
+    std::shared_ptr<solverT> m_solver;
+};
+
+class vexcl_solver_factory
+{
+public:
+
+    // same solvers configuration as the reference implementation
+    static std::shared_ptr<vexcl_solver_iface> build()
+    {
+        using t_solver_impl = tensor_solver_factory::t_solver_impl;
+
+        std::string str_impl = "undefined";
+        t_solver_impl impl;
+
+        try
+        {
+            const network_config& nc = network_config::instance();
+            nc.update_mandatory( "solver.<xmlattr>.type", str_impl );
+
+            impl = boost::lexical_cast<t_solver_impl>( str_impl );
+        }
+        catch(...)
+        {
+            throw network_exception( "unmanaged solver implementation in configuration file : " + str_impl );
+        }
+
+        switch( impl )
+        {
+        case t_solver_impl::SOLVER_IMPL_SGD:
+            return std::make_shared< vexcl_solver<solver_sgd> >();
+        case t_solver_impl::SOLVER_IMPL_ADAGRAD:
+            return std::make_shared< vexcl_solver<solver_adagrad<vexcl_operation>> >();
+        case t_solver_impl::SOLVER_IMPL_ADADELTA:
+            return std::make_shared< vexcl_solver<solver_adadelta<vexcl_operation>> >();
+        case t_solver_impl::SOLVER_IMPL_ADAM:
+            return std::make_shared< vexcl_solver<solver_adam<vexcl_operation>> >();
+        case t_solver_impl::SOLVER_IMPL_ADAMAX:
+            return std::make_shared< vexcl_solver<solver_adamax<vexcl_operation>> >();
+        case t_solver_impl::SOLVER_IMPL_RMSPROP:
+            return std::make_shared< vexcl_solver<solver_rmsprop<vexcl_operation>> >();
+        default:
+            throw network_exception( "unmanaged solver implementation!" );
+        }
+    }
+};
+
+/****************************************************************************/
+/* LAYERS                                                                   */
+/****************************************************************************/
+
+class vexcl_layer
+{
+public:
+
+    vexcl_layer( const std::string& name ) : m_name( name ), m_width( 0 ), m_height( 0 ), m_depth( 0 ) {}
+    virtual ~vexcl_layer() {}
+
+    static void set_training( bool training ) { m_training = training; }
+
+    virtual const std::string type() const = 0;
+
+    size_t width() const { return m_width; }
+    size_t height() const { return m_height; }
+    size_t depth() const { return m_depth; }
+    size_t map_size() const { return m_width * m_height; }
+    size_t size() const { return m_width * m_height * m_depth; }
+
+    // relu derivative has to be applied to back propagated errors
+    virtual bool has_relu() const { return false; }
+    // input layer does not need back propagation
+    bool has_errors() const { return m_error_maps.size() != 0; }
+
+    vexF& feature_maps() { return m_feature_maps; }
+    vexF& error_maps() { return m_error_maps; }
+    vexF& weights() { return m_weights; }
+    vexF& bias() { return m_bias; }
+
+    virtual void feed_forward() = 0;
+    virtual void back_propagate() {}
+    virtual void update_gradients() {}
+
+    void clear_gradients()
+    {
+        if ( m_weights.size() )
+        {
+            m_deltas_weights = 0.f;
+            m_deltas_bias = 0.f;
+        }
+    }
+
+    void gradient_descent( const std::shared_ptr<vexcl_solver_iface>& solver )
+    {
+        if ( !m_weights.size() )
+            return;
+
+        solver->update( m_weights, _cache_ptrs( m_weights_cache ).data(), m_deltas_weights );
+        if ( m_redux_bias )
+            solver->update_redux( m_bias, _cache_ptrs( m_bias_cache ).data(), m_deltas_bias );
+        else
+            solver->update( m_bias, _cache_ptrs( m_bias_cache ).data(), m_deltas_bias );
+    }
+
+protected:
+
+    void _populate( const size_t width, const size_t height, const size_t depth, const bool with_errors = true )
+    {
+        m_width = width;
+        m_height = height;
+        m_depth = depth;
+
+        m_feature_maps = zero_vector( size() );
+        m_error_maps = zero_vector( with_errors ? size() : 0 );
+    }
+
+    void _populate_parameters( const size_t nb_weights, const size_t nb_bias, const size_t cache_size, const bool redux_bias = false )
+    {
+        m_weights = zero_vector( nb_weights );
+        m_deltas_weights = zero_vector( nb_weights );
+        m_bias = zero_vector( nb_bias );
+        m_deltas_bias = zero_vector( nb_bias );
+        m_redux_bias = redux_bias;
+
+        m_weights_cache.clear();
+        m_bias_cache.clear();
+        for ( size_t i=0; i<cache_size; i++ )
+        {
+            m_weights_cache.emplace_back( zero_vector( nb_weights ) );
+            m_bias_cache.emplace_back( zero_vector( nb_bias ) );
+        }
+    }
+
+    // back propagated errors, multiplied by previous layer activation derivative
+    template<class Expr>
+    static void _set_prev_errors( vexcl_layer& prev, const Expr& errors )
+    {
+        if ( prev.has_relu() )
+            prev.error_maps() = ( prev.feature_maps() > 0.f ) * errors;
+        else
+            prev.error_maps() = errors;
+    }
+
+private:
+
+    static std::vector<vexF*> _cache_ptrs( std::vector<vexF>& cache )
+    {
+        std::vector<vexF*> ptrs;
+        for ( auto& _cache : cache )
+            ptrs.push_back( &_cache );
+        return ptrs;
+    }
+
+protected:
+
+    static bool m_training;
+
+    const std::string m_name;
+
+    size_t m_width;
+    size_t m_height;
+    size_t m_depth;
+
+    vexF m_feature_maps;
+    vexF m_error_maps;
+
+    vexF m_weights;
+    vexF m_deltas_weights;
+    std::vector<vexF> m_weights_cache;
+
+    vexF m_bias;
+    vexF m_deltas_bias;
+    std::vector<vexF> m_bias_cache;
+
+    bool m_redux_bias;
+};
+
+bool vexcl_layer::m_training = false;
+
+class vexcl_input_layer final : public vexcl_layer
+{
+public:
+
+    vexcl_input_layer() : vexcl_layer( "in" ) {}
+    virtual ~vexcl_input_layer() {}
+
+    const std::string type() const override { return "input"; }
+
+    void populate( const size_t width, const size_t height, const size_t depth )
+    {
+        LOGGER(info) << "vexcl_input_layer::populate - populating input layer" << std::endl;
+
+        _populate( width, height, depth, false /*no errors*/ );
+    }
+
+    void feed_forward() override { /* NOTHING TO DO */ }
+};
+
+class vexcl_conv_layer final : public vexcl_layer
+{
+public:
+
+    vexcl_conv_layer( const std::string& name, const size_t filter_size ) : vexcl_layer( name ), m_filter_size( filter_size ) {}
+    virtual ~vexcl_conv_layer() {}
+
+    const std::string type() const override { return "conv " + m_name; }
+
+    bool has_relu() const override { return true; }
+
+    void populate(  const std::shared_ptr<vexcl_layer>& prev_layer,
+                    const size_t width,
+                    const size_t height,
+                    const size_t depth,
+                    const size_t cache_size )
+    {
+        LOGGER(info) << "vexcl_conv_layer::populate - populating convolutional layer " << m_name << std::endl;
+
+        if ( ( width != ( prev_layer->width() - m_filter_size + 1 ) ) ||
+            ( height != ( prev_layer->height() - m_filter_size + 1 ) ) )
+        {
+            LOGGER(error) << "vexcl_conv_layer::populate - zero padding not managed for now, "
+                "so layer size should be consistent with filter size and previous layer size" << std::endl;
+            throw network_exception( "inconsistent convolutional layer size" );
+        }
+
+        m_prev_layer = prev_layer;
+
+        _populate( width, height, depth );
+
+        const int F = static_cast<int>( m_filter_size );
+        const int FF = F * F;
+        const int Din = static_cast<int>( prev_layer->depth() );
+        const int Dout = static_cast<int>( depth );
+        const int W = static_cast<int>( width );
+        const int H = static_cast<int>( height );
+        const int PW = static_cast<int>( prev_layer->width() );
+        const int PH = static_cast<int>( prev_layer->height() );
+
+        // filters are stored as [Din][Dout][F][F], bias is uniform over each feature map
+        _populate_parameters( Din * Dout * FF, size(), cache_size );
+        random_normal_init( m_weights, std::sqrt( 2.f / static_cast<float>( FF ) ) );
+        uniform_random_init( m_bias, map_size(), 1.f );
+
+        // precompute gather indexes, so that convolutions are turned into
+        // matrix products of unrolled patches (im2col) computed by reductions
+
+        // forward patches : [W*H][Din*F*F], flipped kernel : [Dout][Din*F*F]
+        std::vector<int> ff_idx; ff_idx.reserve( W * H * Din * FF );
+        for ( int i=0; i<W; i++ ) for ( int j=0; j<H; j++ )
+            for ( int c=0; c<Din; c++ ) for ( int a=0; a<F; a++ ) for ( int b=0; b<F; b++ )
+                ff_idx.push_back( c*PW*PH + (i+a)*PH + (j+b) );
+        m_ff_idx = index_vector( ff_idx );
+        m_ff_col = zero_vector( ff_idx.size() );
+
+        std::vector<int> kernel_idx; kernel_idx.reserve( Dout * Din * FF );
+        for ( int o=0; o<Dout; o++ )
+            for ( int c=0; c<Din; c++ ) for ( int a=0; a<F; a++ ) for ( int b=0; b<F; b++ )
+                kernel_idx.push_back( c*Dout*FF + o*FF + (F-1-a)*F + (F-1-b) );
+        m_kernel_idx = index_vector( kernel_idx );
+        m_kernel = zero_vector( kernel_idx.size() );
+
+        // backward patches : [PW*PH][Dout*F*F], out of map errors being masked
+        std::vector<int> bp_idx; bp_idx.reserve( PW * PH * Dout * FF );
+        std::vector<float> bp_mask; bp_mask.reserve( PW * PH * Dout * FF );
+        for ( int x=0; x<PW; x++ ) for ( int y=0; y<PH; y++ )
+            for ( int o=0; o<Dout; o++ ) for ( int a=0; a<F; a++ ) for ( int b=0; b<F; b++ )
+            {
+                const int i = x + a - F + 1;
+                const int j = y + b - F + 1;
+                const bool valid = ( i >= 0 ) && ( i < W ) && ( j >= 0 ) && ( j < H );
+                bp_idx.push_back( valid ? o*W*H + i*H + j : 0 );
+                bp_mask.push_back( valid ? 1.f : 0.f );
+            }
+        m_bp_idx = index_vector( bp_idx );
+        m_bp_mask = vexF( my_vex_ctx::instance().get(), bp_mask );
+        m_bp_col = zero_vector( bp_idx.size() );
+
+        // gradient patches : [Din][F*F][W*H] (final flip to be consistent with kernel ff orientation)
+        std::vector<int> grad_idx; grad_idx.reserve( Din * FF * W * H );
+        for ( int c=0; c<Din; c++ ) for ( int u=0; u<F; u++ ) for ( int v=0; v<F; v++ )
+            for ( int i=0; i<W; i++ ) for ( int j=0; j<H; j++ )
+                grad_idx.push_back( c*PW*PH + (F-1-u+i)*PH + (F-1-v+j) );
+        m_grad_idx = index_vector( grad_idx );
+        m_grad_col = zero_vector( grad_idx.size() );
+
+        m_bias_sums = zero_vector( depth );
+    }
+
+    void feed_forward() override
+    {
+        const size_t P = map_size();
+        const size_t Q = m_prev_layer->depth() * m_filter_size * m_filter_size;
+
+        m_ff_col = vex::permutation( m_ff_idx )( m_prev_layer->feature_maps() );
+        m_kernel = vex::permutation( m_kernel_idx )( m_weights );
+
+        m_feature_maps = vex::fmax( vex::reduce<vex::SUM>(
+                vex::extents[m_depth][P][Q],
+                vex::reshape( m_kernel, vex::extents[m_depth][P][Q], vex::extents[0][2] )
+                *
+                vex::reshape( m_ff_col, vex::extents[m_depth][P][Q], vex::extents[1][2] ),
+                2
+            ) + m_bias, 0.f );
+    }
+
+    void back_propagate() override
+    {
+        // Need to back prop?
+        if ( !m_prev_layer->has_errors() )
+            return;
+
+        const size_t Din = m_prev_layer->depth();
+        const size_t P = m_prev_layer->map_size();
+        const size_t R = m_depth * m_filter_size * m_filter_size;
+
+        m_bp_col = vex::permutation( m_bp_idx )( m_error_maps ) * m_bp_mask;
+
+        _set_prev_errors( *m_prev_layer, vex::reduce<vex::SUM>(
+                vex::extents[Din][P][R],
+                vex::reshape( m_weights, vex::extents[Din][P][R], vex::extents[0][2] )
+                *
+                vex::reshape( m_bp_col, vex::extents[Din][P][R], vex::extents[1][2] ),
+                2
+            ) );
+    }
+
+    void update_gradients() override
+    {
+        const size_t Din = m_prev_layer->depth();
+        const size_t FF = m_filter_size * m_filter_size;
+        const size_t P = map_size();
+
+        m_grad_col = vex::permutation( m_grad_idx )( m_prev_layer->feature_maps() );
+
+        m_deltas_weights += ( 1.f / static_cast<float>( m_depth ) ) * vex::reduce<vex::SUM>(
+                vex::extents[Din][m_depth][FF][P],
+                vex::reshape( m_grad_col, vex::extents[Din][m_depth][FF][P], vex::extents[0][2][3] )
+                *
+                vex::reshape( m_error_maps, vex::extents[Din][m_depth][FF][P], vex::extents[1][3] ),
+                3
+            );
+
+        m_bias_sums = vex::reduce<vex::SUM>( vex::extents[m_depth][P], m_error_maps, 1 );
+        m_deltas_bias += vex::reshape( m_bias_sums, vex::extents[m_depth][P], vex::extents[0] );
+    }
+
+private:
+
+    const size_t m_filter_size;
+
+    std::shared_ptr<vexcl_layer> m_prev_layer;
+
+    vexI m_ff_idx;
+    vexF m_ff_col;
+    vexI m_kernel_idx;
+    vexF m_kernel;
+
+    vexI m_bp_idx;
+    vexF m_bp_mask;
+    vexF m_bp_col;
+
+    vexI m_grad_idx;
+    vexF m_grad_col;
+
+    vexF m_bias_sums;
+};
+
+class vexcl_pool_layer final : public vexcl_layer
+{
+public:
+
+    vexcl_pool_layer( const std::string& name ) : vexcl_layer( name ), m_subsample( 0 ) {}
+    virtual ~vexcl_pool_layer() {}
+
+    const std::string type() const override { return "pool " + m_name; }
+
+    bool has_relu() const override { return m_prev_layer->has_relu(); }
+
+    void populate(  const std::shared_ptr<vexcl_layer>& prev_layer,
+                    const size_t width,
+                    const size_t height,
+                    const size_t depth )
+    {
+        LOGGER(info) << "vexcl_pool_layer::populate - populating pooling layer " << m_name << std::endl;
+
+        // compute subsampling rate, throw error if not integer
+        if ( ( prev_layer->width() % width ) == 0 )
+            m_subsample = prev_layer->width() / width;
+        else
+            throw network_exception( "invalid subsampling for max pooling" );
+
+        m_prev_layer = prev_layer;
+
+        _populate( width, height, depth );
+
+        const int S = static_cast<int>( m_subsample );
+        const int W = static_cast<int>( width );
+        const int H = static_cast<int>( height );
+        const int PW = static_cast<int>( prev_layer->width() );
+        const int PH = static_cast<int>( prev_layer->height() );
+
+        // subsampling windows : [depth*W*H][S*S], scanned the same way as the reference implementation
+        std::vector<int> win_idx; win_idx.reserve( size() * S * S );
+        std::vector<int> prev_win( prev_layer->size(), 0 );
+        std::vector<int> prev_pos( prev_layer->size(), -1 );
+        for ( int d=0; d<static_cast<int>( depth ); d++ ) for ( int i=0; i<W; i++ ) for ( int j=0; j<H; j++ )
+            for ( int a=0; a<S; a++ ) for ( int b=0; b<S; b++ )
+            {
+                const int prev_idx = d*PW*PH + (i*S+a)*PH + (j*S+b);
+                win_idx.push_back( prev_idx );
+                prev_win[prev_idx] = d*W*H + i*H + j;
+                prev_pos[prev_idx] = a*S + b;
+            }
+        m_win_idx = index_vector( win_idx );
+        m_win_col = zero_vector( win_idx.size() );
+        m_offsets = index_vector( [S](){ std::vector<int> o( S*S ); std::iota( o.begin(), o.end(), 0 ); return o; }() );
+        m_argmax = vexI( my_vex_ctx::instance().get(), size() );
+        m_prev_win = index_vector( prev_win );
+        m_prev_pos = index_vector( prev_pos );
+    }
+
+    void feed_forward() override
+    {
+        const size_t N = size();
+        const size_t SS = m_subsample * m_subsample;
+
+        m_win_col = vex::permutation( m_win_idx )( m_prev_layer->feature_maps() );
+
+        m_feature_maps = vex::reduce<vex::MAX>( vex::extents[N][SS], m_win_col, 1 );
+
+        // keep first max position in each window for back propagation
+        m_argmax = vex::reduce<vex::MIN>(
+            vex::extents[N][SS],
+            vex::reshape( m_offsets, vex::extents[N][SS], vex::extents[1] )
+            + static_cast<int>( SS ) * ( m_win_col != vex::reshape( m_feature_maps, vex::extents[N][SS], vex::extents[0] ) ),
+            1 );
+    }
+
+    void back_propagate() override
+    {
+        // update error on last layer max value pixel
+        m_prev_layer->error_maps() =
+            ( m_prev_pos == vex::permutation( m_prev_win )( m_argmax ) )
+            * vex::permutation( m_prev_win )( m_error_maps );
+    }
+
+private:
+
+    size_t m_subsample;
+
+    std::shared_ptr<vexcl_layer> m_prev_layer;
+
+    vexI m_win_idx;
+    vexF m_win_col;
+    vexI m_offsets;
+    vexI m_argmax;
+    vexI m_prev_win;
+    vexI m_prev_pos;
+};
+
+class vexcl_dropout_layer final : public vexcl_layer
+{
+public:
+
+    // each layer owns its random stream, as the reference implementation
+    vexcl_dropout_layer( const std::string& name )
+        : vexcl_layer( name ), m_dropout( 0.5f ), m_rng_key( random::seed::instance()() ), m_mask_counter( 0 ) {}
+    virtual ~vexcl_dropout_layer() {}
+
+    const std::string type() const override { return "dropout " + m_name; }
+
+    bool has_relu() const override { return m_prev_layer->has_relu(); }
+
+    void populate(  const std::shared_ptr<vexcl_layer>& prev_layer,
+                    const size_t width,
+                    const size_t height,
+                    const size_t depth )
+    {
+        LOGGER(info) << "vexcl_dropout_layer::populate - populating dropout layer " << m_name << std::endl;
+
+        if ( prev_layer->depth() != depth )
+            throw network_exception( "invalid depth for dropout layer, should be same depth as previous layer" );
+
+        if ( ( prev_layer->width() != width ) || ( prev_layer->height() != height ) )
+            throw network_exception( "invalid size for dropout layer, should be same size as previous layer" );
+
+        m_prev_layer = prev_layer;
+
+        _populate( width, height, depth );
+
+        m_mask = zero_vector( size() );
+
+        // generate initial mask
+        _generate_mask();
+    }
+
+    void feed_forward() override
+    {
+        if ( m_training )
+            m_feature_maps = ( 1.f / ( 1.f - m_dropout ) ) * m_mask * m_prev_layer->feature_maps();
+        else
+            m_feature_maps = m_prev_layer->feature_maps();
+    }
+
+    void back_propagate() override
+    {
+        m_prev_layer->error_maps() = m_mask * m_error_maps;
+
+        // dropout layer has to generate new mask after each backprop
+        _generate_mask();
+    }
+
+private:
+
+    // masks are indexed streams of the layer random key : layer key and mask index are packed in the generator seed,
+    // so that layers do not share masks
+    void _generate_mask()
+    {
+        const std::uint64_t seed = ( static_cast<std::uint64_t>( m_rng_key ) << 32 ) | ( m_mask_counter++ & 0xFFFFFFFF );
+
+        vex::Random<float, vex::random::threefry> rnd;
+        m_mask = rnd( vex::element_index(), seed ) < ( 1.f - m_dropout );
+    }
+
+private:
+
+    float m_dropout;
+
+    const std::uint32_t m_rng_key;
+    std::uint64_t m_mask_counter;
+
+    std::shared_ptr<vexcl_layer> m_prev_layer;
+
+    vexF m_mask;
+};
+
+// full & output layers : previous layer feature maps are grouped if depths differ
+class vexcl_full_layer : public vexcl_layer
+{
+public:
+
+    vexcl_full_layer( const std::string& name ) : vexcl_layer( name ), m_fan_in( 0 ) {}
+    virtual ~vexcl_full_layer() {}
+
+    const std::string type() const override { return "full " + m_name; }
+
+    bool has_relu() const override { return true; }
+
+    void populate(  const std::shared_ptr<vexcl_layer>& prev_layer,
+                    const size_t width,
+                    const size_t height,
+                    const size_t depth,
+                    const size_t cache_size )
+    {
+        LOGGER(info) << "vexcl_full_layer::populate - populating full layer " << m_name << std::endl;
+
+        _populate_full( prev_layer, width, height, depth, cache_size );
+
+        random_normal_init( m_bias, std::sqrt( 2.f ) ); // stddev 1 for bias
+        random_normal_init( m_weights, std::sqrt( 2.f / static_cast<float>( m_fan_in ) ) );
+    }
+
+    void feed_forward() override
+    {
+        _muladd();
+
+        // apply activation function
+        m_feature_maps = vex::fmax( m_feature_maps, 0.f );
+    }
+
+    void back_propagate() override
+    {
+        // Need to back prop?
+        if ( !m_prev_layer->has_errors() )
+            return;
+
+        _back_propagate_errors();
+    }
+
+    void update_gradients() override
+    {
+        const size_t R = map_size();
+        const size_t K = m_fan_in;
+
+        m_deltas_weights +=
+            vex::reshape( m_error_maps, vex::extents[m_depth][R][K], vex::extents[0][1] )
+            *
+            vex::reshape( m_prev_layer->feature_maps(), vex::extents[m_depth][R][K], vex::extents[0][2] );
+        m_deltas_bias += m_error_maps;
+    }
+
+protected:
+
+    void _populate_full(    const std::shared_ptr<vexcl_layer>& prev_layer,
+                            const size_t width,
+                            const size_t height,
+                            const size_t depth,
+                            const size_t cache_size,
+                            const bool redux_bias = false )
+    {
+        // check if we have to group previous layer feature maps
+        // grouping is only allowed if current depth is 1
+        if ( ( prev_layer->depth() != depth ) && ( depth > 1 ) )
+            throw network_exception( "depth mismatch between full layer and previous layer" );
+
+        m_prev_layer = prev_layer;
+
+        // as feature maps are contiguous, grouping only changes the inputs count
+        m_fan_in = ( prev_layer->depth() != depth ) ? prev_layer->size() : prev_layer->map_size();
+
+        _populate( width, height, depth );
+        _populate_parameters( depth * width * height * m_fan_in, size(), cache_size, redux_bias );
+    }
+
+    // apply weights and bias, weights being stored as [depth][width*height][fan_in]
+    void _muladd()
+    {
+        const size_t R = map_size();
+        const size_t K = m_fan_in;
+
+        m_feature_maps = vex::reduce<vex::SUM>(
+                vex::extents[m_depth][R][K],
+                m_weights
+                *
+                vex::reshape( m_prev_layer->feature_maps(), vex::extents[m_depth][R][K], vex::extents[0][2] ),
+                2
+            ) + m_bias;
+    }
+
+    void _back_propagate_errors()
+    {
+        const size_t R = map_size();
+        const size_t K = m_fan_in;
+
+        _set_prev_errors( *m_prev_layer, vex::reduce<vex::SUM>(
+                vex::extents[m_depth][K][R],
+                vex::reshape( m_weights, vex::extents[m_depth][K][R], vex::extents[0][2][1] )
+                *
+                vex::reshape( m_error_maps, vex::extents[m_depth][K][R], vex::extents[0][2] ),
+                2
+            ) );
+    }
+
+protected:
+
+    size_t m_fan_in;
+
+    std::shared_ptr<vexcl_layer> m_prev_layer;
+};
+
+// softmax activation & cross entropy loss
+class vexcl_output_layer final : public vexcl_full_layer
+{
+public:
+
+    vexcl_output_layer() : vexcl_full_layer( "out" ), m_loss( 0.f ), m_loss_samples( 0 ) {}
+    virtual ~vexcl_output_layer() {}
+
+    const std::string type() const override { return "output"; }
+
+    bool has_relu() const override { return false; }
+
+    void populate(  const std::shared_ptr<vexcl_layer>& prev_layer,
+                    const size_t width,
+                    const size_t height,
+                    const size_t depth,
+                    const size_t cache_size )
+    {
+        LOGGER(info) << "vexcl_output_layer::populate - populating output layer" << std::endl;
+
+        _populate_full( prev_layer, width, height, depth, cache_size, true /*redux bias*/ );
+
+        random_normal_init( m_bias, std::sqrt( 2.f ) ); // stddev 1 for bias
+        random_normal_init( m_weights, std::sqrt( 2.f / static_cast<float>( m_fan_in ) ) );
+
+        m_training_output = zero_vector( size() );
+    }
+
+    vexF& training_output() { return m_training_output; }
+
+    void feed_forward() override
+    {
+        vex::Context& _ctx = my_vex_ctx::instance().get();
+        vex::Reductor<float, vex::MAX> _max( _ctx );
+        vex::Reductor<float, vex::SUM> _sum( _ctx );
+
+        _muladd();
+
+        // softmax
+        m_feature_maps = vex::exp( m_feature_maps - _max( m_feature_maps ) );
+        m_feature_maps = m_feature_maps / _sum( m_feature_maps );
+    }
+
+    void back_propagate() override
+    {
+        // Need to back prop?
+        if ( !m_prev_layer->has_errors() )
+            return;
+
+        // compute current cross entropy loss
+        vex::Reductor<float, vex::SUM> _sum( my_vex_ctx::instance().get() );
+        m_loss += _sum( vex::if_else( m_training_output > 0.f, -m_training_output * vex::log( m_feature_maps ), 0.f ) );
+        ++m_loss_samples;
+
+        // one-hot softmax cross entropy simplified error
+        m_error_maps = m_feature_maps - m_training_output;
+
+        _back_propagate_errors();
+    }
+
+    void clear_loss()
+    {
+        m_loss = 0.f;
+        m_loss_samples = 0;
+    }
+
+    float loss() const
+    {
+        return m_loss_samples ? m_loss / static_cast<float>( m_loss_samples ) : 0.f;
+    }
+
+private:
+
+    vexF m_training_output;
+
+    float m_loss;
+    size_t m_loss_samples;
+};
+
+/****************************************************************************/
+/* NETWORK                                                                  */
+/****************************************************************************/
+
+network_vexcl::network_vexcl() : m_training_samples( 0 )
+{
+    vex::Context& _ctx = my_vex_ctx::instance().get();
+
+    if ( !_ctx ) throw network_exception( "no vexcl device available" );
+
+    LOGGER(info) << "network_vexcl::network_vexcl - vexcl devices:" << std::endl;
+    LOGGER(info) << _ctx << std::endl;
+
+    m_solver = vexcl_solver_factory::build();
+}
+
+network_vexcl::~network_vexcl()
+{
+}
+
+void network_vexcl::set_training( bool training )
+{
+    vexcl_layer::set_training( training );
+}
+
+void network_vexcl::add_layers( const std::vector<layer_descr>& layers )
+{
+    size_t conv_idx = 0;
+    size_t pool_idx = 0;
+    size_t drop_idx = 0;
+    size_t full_idx = 0;
+
+    size_t cache_size = m_solver->get_cache_size();
+
+    m_layers.clear();
+
+    for ( auto& _layer : layers )
+    {
+        std::shared_ptr<vexcl_layer> l;
+        switch( _layer.type )
+        {
+        case INPUT_LAYER:
+            {
+                std::shared_ptr<vexcl_input_layer> in = std::make_shared<vexcl_input_layer>();
+                in->populate( _layer.sizeX, _layer.sizeY, _layer.sizeZ );
+                l = in;
+            }
+            break;
+        case CONV_LAYER:
+            {
+                std::shared_ptr<vexcl_conv_layer> c =
+                    std::make_shared<vexcl_conv_layer>( "c" + std::to_string(++conv_idx), _layer.sizeF );
+                c->populate( m_layers.back(), _layer.sizeX, _layer.sizeY, _layer.sizeZ, cache_size );
+                l = c;
+            }
+            break;
+        case POOL_LAYER:
+            {
+                std::shared_ptr<vexcl_pool_layer> s = std::make_shared<vexcl_pool_layer>( "s" + std::to_string(++pool_idx) );
+                s->populate( m_layers.back(), _layer.sizeX, _layer.sizeY, _layer.sizeZ );
+                l = s;
+            }
+            break;
+        case DROPOUT_LAYER:
+            {
+                std::shared_ptr<vexcl_dropout_layer> d = std::make_shared<vexcl_dropout_layer>( "d" + std::to_string(++drop_idx) );
+                d->populate( m_layers.back(), _layer.sizeX, _layer.sizeY, _layer.sizeZ );
+                l = d;
+            }
+            break;
+        case FULL_LAYER:
+            {
+                std::shared_ptr<vexcl_full_layer> f = std::make_shared<vexcl_full_layer>( "f" + std::to_string(++full_idx) );
+                f->populate( m_layers.back(), _layer.sizeX, _layer.sizeY, _layer.sizeZ, cache_size );
+                l = f;
+            }
+            break;
+        case OUTPUT_LAYER:
+            {
+                std::shared_ptr<vexcl_output_layer> out = std::make_shared<vexcl_output_layer>();
+                out->populate( m_layers.back(), _layer.sizeX, _layer.sizeY, _layer.sizeZ, cache_size );
+                l = out;
+            }
+            break;
+        }
+        m_layers.emplace_back( l );
+    }
+}
+
+void network_vexcl::set_input(  const size_t& in_size, const float* in )
+{
+    vexF& input = m_layers.front()->feature_maps();
+
+    if ( in_size > input.size() )
+        throw network_exception( "sample size exceeds allocated layer size!" );
+
+    vex::copy( in, in + in_size, input.begin() );
+}
+
+void network_vexcl::set_output( const size_t& out_size, const float* out )
+{
+    vexF& training_output = std::static_pointer_cast<vexcl_output_layer>( m_layers.back() )->training_output();
+
+    if ( out_size > training_output.size() )
+        throw network_exception( "output size exceeds allocated layer size!" );
+
+    vex::copy( out, out + out_size, training_output.begin() );
+}
+
+const output_ptr network_vexcl::output()
+{
+    vexF& output = m_layers.back()->feature_maps();
+
+    output_ptr o( output.size() );
+    vex::copy( output.begin(), output.end(), o.outputs.get() );
+
+    return o;
+}
+
+const layer_ptr network_vexcl::get_layer_ptr( const size_t layer_idx )
+{
+    if ( layer_idx >= m_layers.size() )
+	{
+        LOGGER(error) << "network_vexcl::get_layer_ptr - cannot access layer " << layer_idx << std::endl;
+        throw network_exception( "invalid layer index" );
+    }
+
+    std::shared_ptr<vexcl_layer> _layer = m_layers[layer_idx];
+
+    LOGGER(info) << "network_vexcl::get_layer_ptr - getting layer  " << _layer->type() << std::endl;
+
+    layer_ptr l( _layer->weights().size(), _layer->bias().size() );
+    if ( l.num_weights )
+        vex::copy( _layer->weights().begin(), _layer->weights().end(), l.weights.get() );
+    if ( l.num_bias )
+        vex::copy( _layer->bias().begin(), _layer->bias().end(), l.bias.get() );
+
+    return l;
+}
+
+void network_vexcl::set_layer_ptr( const size_t layer_idx, const layer_ptr& l )
+{
+    if ( layer_idx >= m_layers.size() )
+    {
+        LOGGER(error) << "network_vexcl::set_layer_ptr - cannot access layer " << layer_idx << std::endl;
+        throw network_exception( "invalid layer index" );
+    }
+
+    std::shared_ptr<vexcl_layer> _layer = m_layers[layer_idx];
+
+    if ( ( _layer->weights().size() != l.num_weights ) || ( _layer->bias().size() != l.num_bias ) )
+    {
+        LOGGER(error) << "network_vexcl::set_layer_ptr - inconsistent layer " << layer_idx << " size" << std::endl;
+        throw network_exception( "inconsistent layer size" );
+    }
+
+    LOGGER(info) << "network_vexcl::set_layer_ptr - setting layer  " << _layer->type() << std::endl;
+
+    if ( l.num_weights )
+        vex::copy( l.weights.get(), l.weights.get() + l.num_weights, _layer->weights().begin() );
+    if ( l.num_bias )
+        vex::copy( l.bias.get(), l.bias.get() + l.num_bias, _layer->bias().begin() );
+}
+
+void network_vexcl::clear_gradients()
+{
+    for ( auto _layer : m_layers )
+    {
+        _layer->clear_gradients();
+    }
+
+    std::static_pointer_cast<vexcl_output_layer>( m_layers.back() )->clear_loss();
+
+    m_training_samples = 0;
+}
+
+void network_vexcl::feed_forward()
+{
+    for ( auto _layer : m_layers )
+    {
+        _layer->feed_forward();
+    }
+}
+
+void network_vexcl::back_propagate()
+{
+    for ( auto _layer : boost::adaptors::reverse( m_layers ) )
+    {
+        _layer->back_propagate();
+    }
+
+    for ( auto _layer : m_layers )
+    {
+        _layer->update_gradients();
+    }
+
+    ++m_training_samples;
+}
+
+void network_vexcl::gradient_descent()
+{
+    m_solver->set_size( m_training_samples );
+
+    for ( auto _layer : m_layers )
+    {
+        _layer->gradient_descent( m_solver );
+    }
+}
+
+float network_vexcl::loss()
+{
+    return std::static_pointer_cast<vexcl_output_layer>( m_layers.back() )->loss();
+}
+
+void network_vexcl::gradient_check( const output_ptr& out_ref )
+{
+    LOGGER(error) << "network_vexcl::gradient_check - not implemented yet for convnet" << std::endl;
+}
+
+} /*namespace neurocl*/ } /*namespace convnet*/
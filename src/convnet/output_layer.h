@@ -26,6 +26,8 @@ THE SOFTWARE.
 #define OUTPUT_LAYER_H
 
 #include "layer.h"
+#include "tensor_fake_quantizer.h"
+#include "tensor_sparse.h"
 
 #include "common/logger.h"
 
@@ -49,6 +51,9 @@ public:
     // get current loss
     virtual float loss() = 0;
 
+    // get loss of the last feed forward, not accumulated (gradient check)
+    virtual float sample_loss() const = 0;
+
     // fill with incoming buffer
     virtual void fill(  const size_t depth1,
                         const size_t depth2,
@@ -69,7 +74,7 @@ public:
     output_layer()
      :  m_weights( nullptr ), m_deltas_weights( nullptr ),
         m_bias( nullptr ), m_deltas_bias( nullptr ),
-        m_prev_group_features( false )
+        m_prev_group_features( false ), m_sparse_dirty( true )
     {
         static_assert( !std::is_same<activationT,tensor_activations::softmax_cross_entropy>::value ||
             ( std::is_same<activationT, tensor_activations::softmax_cross_entropy>::value &&
@@ -153,6 +158,11 @@ public:
             for ( auto& _weights : m_weights_cache )
                 _weights = tensor_tank::instance().get_standard( "weights_cache" + std::to_string(j++), width * height, fan_in(), 1, depth );
         }
+
+        // weights are quantized per output neuron (matrix row)
+        if ( m_quantization_aware )
+            m_quantizer.reset( new tensor_fake_quantizer(
+                m_quantization_per_channel ? nto::quantize_mode::rows : nto::quantize_mode::layer ) );
     }
 
     size_t width() const override { return m_feature_maps.w(); }
@@ -186,7 +196,26 @@ public:
     {
         const auto& prev_feature_maps = m_prev_layer->feature_maps();
 
-        if ( m_prev_group_features )
+        if ( m_quantizer )
+        {
+            // quantization aware training : input & weights are fake quantized
+            if ( m_prev_group_features )
+                m_quantizer->quantize( nto::group( prev_feature_maps ), *m_weights, m_training );
+            else
+                m_quantizer->quantize( prev_feature_maps, *m_weights, m_training );
+
+            // apply weights and bias
+            m_feature_maps = nto::muladd( m_quantizer->weights(), m_quantizer->input(), *m_bias );
+        }
+        else if ( !m_training && _sparse_weights() )
+        {
+            // pruned weights inference : apply sparse weights and bias
+            if ( m_prev_group_features )
+                m_feature_maps = m_sparse_weights.muladd( nto::group( prev_feature_maps ), *m_bias );
+            else
+                m_feature_maps = m_sparse_weights.muladd( prev_feature_maps, *m_bias );
+        }
+        else if ( m_prev_group_features )
         {
             const tensor grouped_feature_maps = nto::group( prev_feature_maps );
 
@@ -250,7 +279,7 @@ public:
 
             const tensor grouped_error_maps = nto::elemul(
                 m_prev_layer->d_activation( grouped_feature_maps ),
-                nto::multrans1( *m_weights, m_error_maps )
+                nto::multrans1( _weights(), m_error_maps )
             );
 
             nto::ungroup( grouped_error_maps, prev_error_maps );
@@ -259,16 +288,25 @@ public:
         {
     		prev_error_maps = nto::elemul(
         		m_prev_layer->d_activation( prev_feature_maps ),
-        		nto::multrans1( *m_weights, m_error_maps )
+        		nto::multrans1( _weights(), m_error_maps )
     		);
         }
+
+        // straight-through input quantization
+        if ( m_quantizer )
+            m_quantizer->mask_errors( prev_feature_maps, prev_error_maps );
     }
 
     void update_gradients() override
     {
         // Compute gradients
 
-        if ( m_prev_group_features )
+        if ( m_quantizer )
+        {
+            *m_deltas_weights += nto::multrans2( m_error_maps, m_quantizer->input() );
+            *m_deltas_bias += m_error_maps;
+        }
+        else if ( m_prev_group_features )
         {
             const auto&& grouped_feature_maps = nto::group( m_prev_layer->feature_maps() );
 
@@ -296,6 +334,27 @@ public:
 
         nto::optimize<nto::optimize_mode::std>( solver, m_weights, m_weights_cache.data(), m_deltas_weights );
         nto::optimize<nto::optimize_mode::redux>( solver, m_bias, m_bias_cache.data(), m_deltas_bias );
+
+        // pruned weights stay null
+        if ( !m_prune_mask.empty() )
+            *m_weights = nto::elemul( *m_weights, m_prune_mask );
+
+        m_sparse_dirty = true;
+    }
+
+    bool prune( const float sparsity ) override
+    {
+        nto::prune( *m_weights, sparsity, m_prune_mask );
+        m_sparse_dirty = true;
+
+        LOGGER(info) << "output_layer::prune - output layer pruned to " << ( 100.f * sparsity ) << "% sparsity" << std::endl;
+
+        return true;
+    }
+
+    void parameters_changed() override
+    {
+        m_sparse_dirty = true;
     }
 
     float loss() override
@@ -303,10 +362,16 @@ public:
         return m_loss.mean();
     }
 
+    float sample_loss() const override
+    {
+        return errorT::f( m_feature_maps, m_training_output );
+    }
+
     // Fill weights
     void fill_w( const size_t data_size, const float* data ) override
     {
          m_weights->grouped_fill( data_size, data );
+         m_sparse_dirty = true;
     }
     void fill_w( float* data ) override
     {
@@ -323,6 +388,29 @@ public:
          m_bias->grouped_fill( data );
     }
 
+    // Get training state tensors
+    void training_tensors( std::vector<tensor*>& tensors ) override
+    {
+        tensors.push_back( m_weights );
+        tensors.insert( tensors.end(), m_weights_cache.begin(), m_weights_cache.end() );
+        tensors.push_back( m_bias );
+        tensors.insert( tensors.end(), m_bias_cache.begin(), m_bias_cache.end() );
+
+        if ( m_quantizer )
+            tensors.push_back( m_quantizer->training_tensor() );
+    }
+
+    // Get/Set learned input quantization scale
+    float input_scale() const override
+    {
+        return m_quantizer ? m_quantizer->input_scale() : 0.f;
+    }
+    void set_input_scale( const float scale ) override
+    {
+        if ( m_quantizer )
+            m_quantizer->set_input_scale( scale );
+    }
+
     //! get gradient checker
     std::unique_ptr<tensor_gradient_checker> get_gradient_checker() override
     {
@@ -343,6 +431,20 @@ protected:
 
 private:
 
+    // feed forward weights, fake quantized if quantization aware training
+    const tensor& _weights() const { return m_quantizer ? m_quantizer->weights() : *m_weights; }
+
+    // sparse copy of the weights, built lazily after weights modification (empty if not sparse enough)
+    bool _sparse_weights()
+    {
+        if ( m_sparse_dirty )
+        {
+            m_sparse_weights.build( *m_weights, m_sparse_threshold );
+            m_sparse_dirty = false;
+        }
+        return !m_sparse_weights.empty();
+    }
+
     template<class _errorT>
     class mean_loss
     {
@@ -391,6 +493,12 @@ private:
     std::vector<tensor*> m_bias_cache;
 
     bool m_prev_group_features;
+
+    std::unique_ptr<tensor_fake_quantizer> m_quantizer;
+
+    tensor m_prune_mask;
+    tensor_sparse m_sparse_weights;
+    bool m_sparse_dirty;
 };
 
 } /*namespace neurocl*/ } /*namespace convnet*/
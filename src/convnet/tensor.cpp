@@ -26,6 +26,7 @@ THE SOFTWARE.
 
 #include "common/network_exception.h"
 #include "common/network_random.h"
+#include "common/profiler.h"
 
 namespace neurocl { namespace convnet {
 
@@ -51,11 +52,7 @@ template<class T>
 inline void random_normal_init( T& container, const float stddev = 1.f )
 {
     random::rand_gaussian_generator rgg( 0.f, stddev );
-
-    for( auto& element : container.data() )
-    {
-        element = rgg();
-    }
+    rgg.fill( container.data().begin(), container.data().size() );
 }
 
 void tensor::assert_same_size( const tensor& t )
@@ -89,6 +86,8 @@ tensor::tensor( const tensor& t )
     m_depth1 = t.m_depth1;
     m_depth2 = t.m_depth2;
 
+    PROFILE_ALLOCATION( m_width * m_height * m_depth1 * m_depth2 * sizeof( float ) );
+
     m_tensor_array.resize( boost::extents[t.m_depth1][t.m_depth2] );
     m_tensor_array = t.m_tensor_array;
 }
@@ -112,6 +111,8 @@ tensor& tensor::operator=( const tensor& other )
     m_depth1 = other.m_depth1;
     m_depth2 = other.m_depth2;
 
+    PROFILE_ALLOCATION( m_width * m_height * m_depth1 * m_depth2 * sizeof( float ) );
+
     m_tensor_array.resize( boost::extents[m_depth1][m_depth2] );
     m_tensor_array = other.m_tensor_array;
 
@@ -125,6 +126,8 @@ void tensor::resize( const size_t width, const size_t height, const size_t depth
     m_depth1 = depth1;
     m_depth2 = depth2;
 
+    PROFILE_ALLOCATION( m_width * m_height * m_depth1 * m_depth2 * sizeof( float ) );
+
     m_tensor_array.resize( boost::extents[m_depth1][m_depth2] );
     for( auto _matrices : m_tensor_array )
         for( auto& _matrix : _matrices )
@@ -276,6 +279,18 @@ float tensor::norm2() const
     return std::sqrt( _acc );
 }
 
+float tensor::norm_inf() const
+{
+    float _max = 0.f;
+    tensor_foreach() {
+        std::for_each(m_tensor_array[d1][d2].data().begin(), m_tensor_array[d1][d2].data().end(),
+            [&_max] ( float a ) {
+                _max = std::max( _max, std::abs( a ) );
+            });
+    }
+    return _max;
+}
+
 float tensor::sum() const
 {
     float _acc = 0.f;
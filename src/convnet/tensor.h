@@ -147,6 +147,8 @@ public:
     float norm1() const;
     // returns L2 norm
     float norm2() const;
+    // returns L-infinity norm (max absolute value)
+    float norm_inf() const;
     // returns elements sum
     float sum() const;
 
@@ -163,6 +165,8 @@ public:
     class key
     {
         friend class tensor_gradient_checker;
+        friend class tensor_fake_quantizer;
+        friend class tensor_sparse;
         friend class tensor_activations::sigmoid;
         friend class tensor_activations::tanh;
         friend class tensor_activations::relu;
@@ -0,0 +1,121 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef TENSOR_FAKE_QUANTIZER_H
+#define TENSOR_FAKE_QUANTIZER_H
+
+#include "tensor_operations.h"
+
+namespace neurocl { namespace convnet {
+
+/**
+ *  Quantization aware training of a weighted layer : layer input and weights are fake quantized (int8
+ *  rounding simulated on floats) in feed forward, and gradients go straight-through to the float weights
+ *  and to the previous layer (except for clamped input values). Input range is learned as a moving average
+ *  of the observed max absolute values while training, weights scales are computed as in the int8 network.
+ */
+class tensor_fake_quantizer
+{
+public:
+
+    tensor_fake_quantizer( const tensor_operation::quantize_mode weights_mode )
+        : m_weights_mode( weights_mode )
+    {
+        // single value tensor, so that the learned range is part of the training state
+        m_input_range.resize( 1, 1, 1, 1 );
+    }
+    virtual ~tensor_fake_quantizer() {}
+
+    //! fake quantize input & weights, the input range being updated if training
+    void quantize( const tensor& input, const tensor& weights, const bool training )
+    {
+        // input & weights shapes are constant, buffers are sized once
+        if ( m_weights.empty() )
+        {
+            m_input.resize( input );
+            m_weights.resize( weights );
+        }
+
+        float& _range = m_input_range.m( 0, 0, {} )( 0, 0 );
+
+        if ( training )
+        {
+            const float _observed = input.norm_inf();
+            _range = ( _range > 0.f ) ? ( s_range_momentum * _range + ( 1.f - s_range_momentum ) * _observed ) : _observed;
+        }
+
+        // quantized in place : no allocation in feed forward
+        // (no quantization of the input until its range has been observed)
+        if ( _range > 0.f )
+            tensor_operation::fake_quantize( input, input_scale(), m_input );
+        else
+            tensor_operation::copy( input, m_input );
+
+        tensor_operation::fake_quantize( weights, m_weights_mode, m_weights );
+    }
+
+    //! fake quantized input & weights of last feed forward
+    const tensor& input() const { return m_input; }
+    const tensor& weights() const { return m_weights; }
+
+    //! apply straight-through estimator to the input errors (clamped values don't propagate)
+    void mask_errors( const tensor& input, tensor& errors ) const
+    {
+        if ( _range() > 0.f )
+            errors = tensor_operation::elemul( tensor_operation::d_fake_quantize( input, input_scale() ), errors );
+    }
+
+    //! learned input scale (null if the input range has not been observed yet)
+    float input_scale() const
+    {
+        return ( _range() > 0.f ) ? tensor_operation::quantize_scale( _range() ) : 0.f;
+    }
+    void set_input_scale( const float scale )
+    {
+        // range is the scale ratio to the scale of a unit range
+        m_input_range.m( 0, 0, {} )( 0, 0 ) = std::max( 0.f, scale ) / tensor_operation::quantize_scale( 1.f );
+    }
+
+    tensor* training_tensor() { return &m_input_range; }
+
+private:
+
+    float _range() const { return m_input_range.c_m( 0, 0, {} )( 0, 0 ); }
+
+private:
+
+    // input range moving average momentum (updated at each training sample)
+    static constexpr float s_range_momentum = 0.99f;
+
+    const tensor_operation::quantize_mode m_weights_mode;
+
+    tensor m_input_range;
+
+    tensor m_input;
+    tensor m_weights;
+};
+
+} /*namespace neurocl*/ } /*namespace convnet*/
+
+#endif //TENSOR_FAKE_QUANTIZER_H
@@ -25,7 +25,10 @@ THE SOFTWARE.
 #ifndef TENSOR_GRADIENT_CHECKER_H
 #define TENSOR_GRADIENT_CHECKER_H
 
-#include <boost/iterator/zip_iterator.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
 
 namespace neurocl { namespace convnet {
 
@@ -33,13 +36,12 @@ namespace neurocl { namespace convnet {
 class tensor_gradient_checker
 {
 public:
-    tensor_gradient_checker( tensor& weights, tensor& deltas )
-    	: m_weights( weights ), m_deltas( deltas ), m_index( 0 ), m_stored( 0.f )
+    //! deltas_scale undoes the normalization deltas are accumulated with, if any
+    tensor_gradient_checker( tensor& weights, tensor& deltas, const float deltas_scale = 1.f )
+    	: m_weights( weights ), m_deltas( deltas ), m_deltas_scale( deltas_scale ), m_index( 0 ), m_stored( 0.f )
     {
         m_weights.assert_same_size( m_deltas );
 
-        m_numerical_deltas.resize( m_deltas );
-
         m_line_size = m_weights.w();
         m_group_size = m_weights.d2();
         m_base_size = m_weights.w() * m_weights.h();
@@ -51,6 +53,10 @@ public:
         return m_base_size * m_weights.d1() * m_weights.d2();
     }
 
+    //! move to a given parameter (flat index)
+    void seek( const size_t index ) { m_index = index; }
+    void next() { ++m_index; }
+
     void store()
     {
         m_stored = _get_value( m_weights );
@@ -63,36 +69,13 @@ public:
     {
         _get_value( m_weights ) = m_stored;
     }
-    void set_grad( const float grad )
+
+    //! back propagated gradient of the current parameter
+    float analytic_grad()
     {
-        _get_value( m_numerical_deltas ) = grad;
+        return m_deltas_scale * _get_value( m_deltas );
     }
-    void next() { ++m_index; }
-    double error()
-    {
-        //return ( m_deltas - m_numerical_deltas ).norm2() / static_cast<float>( size() );
-
-		// TBC : relative error implementation (http://cs231n.github.io/neural-networks-3/)
-        double _err = 0.;
-        tensor_foreach_p( m_deltas.d1(), m_deltas.d2() )
-        {
-            auto iter = boost::make_zip_iterator( boost::make_tuple( m_deltas.m(d1,d2,{}).data().begin(),
-                m_numerical_deltas.m(d1,d2,{}).data().begin() ) );
-            auto end = boost::make_zip_iterator( boost::make_tuple( m_deltas.m(d1,d2,{}).data().end(),
-                m_numerical_deltas.m(d1,d2,{}).data().end() ) );
 
-            for( ; iter != end ; ++iter )
-            {
-                double fa = iter->get<0>();
-                double fn = iter->get<1>();
-
-                std::cout << "fa=" << fa << " vs fn=" << fn << " r=" << fa/fn << std::endl;
-
-                _err += std::abs( fa - fn ) / std::max( std::abs( fa ), std::abs( fn ) );
-            }
-        }
-        return _err / static_cast<double>( size() );
-    }
 private:
     float& _get_value( tensor& t )
     {
@@ -110,7 +93,7 @@ private:
 
     tensor& m_weights;
     tensor& m_deltas;
-    tensor m_numerical_deltas;
+    const float m_deltas_scale;
 
     size_t m_group_size;
     size_t m_line_size;
@@ -120,6 +103,63 @@ private:
     float m_stored;
 };
 
+//! relative errors (http://cs231n.github.io/neural-networks-3/) between analytic and numerical gradients,
+//! accumulated in decades : below 1e-7 is fine, above 1e-2 is most probably a wrong gradient.
+//! Gradients below the numerical resolution (loss rounding over the parameter increment) are compared in absolute
+class gradient_check_histogram
+{
+public:
+    gradient_check_histogram( const double resolution = 0. )
+        : m_resolution( resolution ), m_count( 0 ), m_sum( 0. ), m_max( 0. ) { m_buckets.fill( 0 ); }
+    virtual ~gradient_check_histogram() {}
+
+    void add( const float analytic, const float numerical )
+    {
+        const double fa = analytic;
+        const double fn = numerical;
+        const double norm = std::max( m_resolution, std::max( std::abs( fa ), std::abs( fn ) ) );
+        const double err = ( norm > 0. ) ? std::abs( fa - fn ) / norm : 0.;
+
+        size_t bucket = 0;
+        while ( ( bucket < s_decades ) && ( err >= std::pow( 10., -static_cast<double>( s_decades - bucket ) ) ) )
+            ++bucket;
+
+        ++m_buckets[bucket];
+        ++m_count;
+        m_sum += err;
+        m_max = std::max( m_max, err );
+    }
+
+    size_t count() const { return m_count; }
+    double mean() const { return m_count ? m_sum / static_cast<double>( m_count ) : 0.; }
+    double max() const { return m_max; }
+
+    //! e.g. "<1e-7:12 <1e-6:3 ... >=1e-1:0"
+    std::string dump() const
+    {
+        std::string out;
+        for ( size_t i = 0; i <= s_decades; i++ )
+        {
+            if ( i )
+                out += " ";
+            out += ( i < s_decades ) ? "<1e-" + std::to_string( s_decades - i ) : ">=1e-1";
+            out += ":" + std::to_string( m_buckets[i] );
+        }
+        return out;
+    }
+
+private:
+
+    static constexpr size_t s_decades = 7;
+
+    double m_resolution;
+
+    std::array<size_t,s_decades+1> m_buckets;
+    size_t m_count;
+    double m_sum;
+    double m_max;
+};
+
 } /*namespace neurocl*/ } /*namespace convnet*/
 
 #endif //TENSOR_GRADIENT_CHECKER_H
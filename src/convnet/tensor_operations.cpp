@@ -26,12 +26,19 @@ THE SOFTWARE.
 #include "tensor_operations.h"
 
 #include "common/network_random.h"
+#include "common/profiler.h"
 
 #include <boost/iterator/zip_iterator.hpp>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
+#include <cmath>
+#include <limits>
+
 namespace neurocl { namespace convnet {
 
+// symmetric quantization range, consistent with the int8 network
+static const float s_int8_range = 127.f;
+
 inline void _assert_multiple( const tensor& t, const size_t& divider )
 {
     if ( ( ( t.w() % divider ) != 0 ) || ( ( t.h() % divider ) != 0 ) )
@@ -97,6 +104,7 @@ inline void _assert_same_sizes( const tensor& t1, const tensor& t2 )
 
 tensor tensor_operation::scale( const float& val, const tensor& input )
 {
+    PROFILE_COUNT( "scale" );
     tensor output;
     output.resize( input );
 
@@ -109,6 +117,7 @@ tensor tensor_operation::scale( const float& val, const tensor& input )
 
 tensor tensor_operation::plus( const float& val, const tensor& input )
 {
+    PROFILE_COUNT( "plus" );
     tensor output;
     output.resize( input );
 
@@ -122,6 +131,7 @@ tensor tensor_operation::plus( const float& val, const tensor& input )
 
 tensor tensor_operation::minus( const float& val, const tensor& input )
 {
+    PROFILE_COUNT( "minus" );
     tensor output;
     output.resize( input );
 
@@ -135,6 +145,7 @@ tensor tensor_operation::minus( const float& val, const tensor& input )
 
 tensor tensor_operation::add( const tensor& inputA, const tensor& inputB )
 {
+    PROFILE_COUNT( "add" );
     _assert_same_sizes( inputA, inputB );
 
     tensor output;
@@ -150,6 +161,7 @@ tensor tensor_operation::add( const tensor& inputA, const tensor& inputB )
 
 tensor tensor_operation::sub( const tensor& inputA, const tensor& inputB )
 {
+    PROFILE_COUNT( "sub" );
     _assert_same_sizes( inputA, inputB );
 
     tensor output;
@@ -165,6 +177,7 @@ tensor tensor_operation::sub( const tensor& inputA, const tensor& inputB )
 
 tensor tensor_operation::group( const tensor& input )
 {
+    PROFILE_COUNT( "group" );
     _assert_no_replication( input );
 
     tensor output;
@@ -192,6 +205,7 @@ tensor tensor_operation::group( const tensor& input )
 
 void tensor_operation::ungroup( const tensor& input, tensor& output )
 {
+    PROFILE_COUNT( "ungroup" );
     _assert_no_replication( output );
 
     auto input_mat_iter = input.m_tensor_array[0][0].data().begin();
@@ -209,8 +223,21 @@ void tensor_operation::ungroup( const tensor& input, tensor& output )
     }
 }
 
+void tensor_operation::copy( const tensor& input, tensor& output )
+{
+    PROFILE_COUNT( "copy" );
+    _assert_same_sizes( input, output );
+
+    tensor_foreach_p( input.d1(), input.d2() ) {
+        std::copy( input.m_tensor_array[d1][d2].data().begin(),
+                   input.m_tensor_array[d1][d2].data().end(),
+                   output.m_tensor_array[d1][d2].data().begin() );
+    }
+}
+
 tensor tensor_operation::elediv( const tensor& inputA, const tensor& inputB )
 {
+    PROFILE_COUNT( "elediv" );
     using namespace boost::numeric::ublas;
 
     _assert_same_sizes( inputA, inputB );
@@ -228,6 +255,7 @@ tensor tensor_operation::elediv( const tensor& inputA, const tensor& inputB )
 
 tensor tensor_operation::elemul( const tensor& inputA, const tensor& inputB )
 {
+    PROFILE_COUNT( "elemul" );
     using namespace boost::numeric::ublas;
 
     _assert_same_sizes( inputA, inputB );
@@ -245,6 +273,7 @@ tensor tensor_operation::elemul( const tensor& inputA, const tensor& inputB )
 
 tensor tensor_operation::mul( const tensor& inputA, const tensor& inputB )
 {
+    PROFILE_COUNT( "mul" );
     using namespace boost::numeric::ublas;
 
     _assert_same_sizes( inputA, inputB );
@@ -262,6 +291,7 @@ tensor tensor_operation::mul( const tensor& inputA, const tensor& inputB )
 
 tensor tensor_operation::muladd( const tensor& inputA, const tensor& inputB, const tensor& inputC )
 {
+    PROFILE_COUNT( "muladd" );
     using namespace boost::numeric::ublas;
 
     _assert_muladd_sizes( inputA, inputB, inputC );
@@ -280,6 +310,7 @@ tensor tensor_operation::muladd( const tensor& inputA, const tensor& inputB, con
 
 tensor tensor_operation::multrans1( const tensor& inputA, const tensor& inputB )
 {
+    PROFILE_COUNT( "multrans1" );
     using namespace boost::numeric::ublas;
 
     _assert_multrans1_sizes( inputA, inputB );
@@ -297,6 +328,7 @@ tensor tensor_operation::multrans1( const tensor& inputA, const tensor& inputB )
 
 tensor tensor_operation::multrans2( const tensor& inputA, const tensor& inputB )
 {
+    PROFILE_COUNT( "multrans2" );
     using namespace boost::numeric::ublas;
 
     _assert_multrans2_sizes( inputA, inputB );
@@ -314,6 +346,7 @@ tensor tensor_operation::multrans2( const tensor& inputA, const tensor& inputB )
 
 tensor tensor_operation::sqrt( const tensor& input )
 {
+    PROFILE_COUNT( "sqrt" );
     tensor output;
     output.resize( input );
 
@@ -326,6 +359,12 @@ tensor tensor_operation::sqrt( const tensor& input )
     return output;
 }
 
+tensor tensor_operation::decayed_max_abs( const tensor& inputA, const tensor& inputB, const float decay )
+{
+    return binary_operator( inputA, inputB,
+        [decay](const float& a,const float& b){ return std::max( decay * a, std::abs( b ) ); } );
+}
+
 struct flipper
 {
     flipper( int sx, int sy ) { m_flipped = matrixF(sx,sy); }
@@ -339,6 +378,7 @@ template <>
 tensor tensor_operation::convolve_add_forward<tensor_operation::kernel_mode::flip,tensor_operation::pad_mode::valid>(
     const tensor& input, const tensor& filter, const int stride )
 {
+    PROFILE_COUNT( "convolve_add_forward" );
     using namespace boost::numeric::ublas;
 
     _assert_cross_depths21( input, filter );
@@ -389,6 +429,7 @@ template <>
 tensor tensor_operation::convolve_add_backward<tensor_operation::kernel_mode::std,tensor_operation::pad_mode::full>(
     const tensor& input, const tensor& filter, const int stride )
 {
+    PROFILE_COUNT( "convolve_add_backward" );
     using namespace boost::numeric::ublas;
 
     _assert_cross_depths22( input, filter );
@@ -450,6 +491,7 @@ template <>
 tensor tensor_operation::convolve_update<tensor_operation::kernel_mode::std,tensor_operation::pad_mode::valid>(
     const tensor& input, const tensor& filter, const int stride )
 {
+    PROFILE_COUNT( "convolve_update" );
     using namespace boost::numeric::ublas;
 
     tensor output;
@@ -461,7 +503,7 @@ tensor tensor_operation::convolve_update<tensor_operation::kernel_mode::std,tens
     // no replication in output features
     output.resize( stepsX, stepsY, input.d2(), filter.d2() );
 
-    matrixF conv( input.w(), filter.h() );
+    matrixF conv( filter.w(), filter.h() );
 
     for ( auto d1 = size_t(0); d1 < input.d2(); d1++ )
     {
@@ -490,6 +532,7 @@ tensor tensor_operation::convolve_update<tensor_operation::kernel_mode::std,tens
 
 tensor tensor_operation::subsample( const tensor& input, const size_t subsample )
 {
+    PROFILE_COUNT( "subsample" );
     _assert_multiple( input, subsample );
 
     tensor output;
@@ -532,6 +575,7 @@ tensor tensor_operation::subsample( const tensor& input, const size_t subsample
 
 tensor tensor_operation::d_subsample( const tensor& input, const tensor& input_ref, const size_t subsample )
 {
+    PROFILE_COUNT( "d_subsample" );
     _assert_multiple( input_ref, subsample );
 
     tensor output;
@@ -585,6 +629,7 @@ tensor tensor_operation::d_subsample( const tensor& input, const tensor& input_r
 
 tensor tensor_operation::uniform_sum( const tensor& input )
 {
+    PROFILE_COUNT( "uniform_sum" );
     tensor output;
     output.resize( input );
 
@@ -598,17 +643,158 @@ tensor tensor_operation::uniform_sum( const tensor& input )
 
 void tensor_operation::bernoulli( tensor& input, const float p )
 {
-    random::rand_bernoulli_generator bernoulli( p );
+    random::philox_generator rng( random::seed::instance()() );
+    bernoulli( input, p, rng );
+}
+
+void tensor_operation::bernoulli( tensor& input, const float p, random::philox_generator& rng )
+{
+    PROFILE_COUNT( "bernoulli" );
+
+    tensor_foreach_p( input.d1(), input.d2() ) {
+        rng.bernoulli( input.m_tensor_array[d1][d2].data().begin(), input.m_tensor_array[d1][d2].data().size(), p );
+    }
+}
+
+float tensor_operation::quantize_scale( const float max_abs )
+{
+    return std::max( max_abs, std::numeric_limits<float>::epsilon() ) / s_int8_range;
+}
+
+inline void _fake_quantize( const float* in, float* out, const size_t size, const float scale )
+{
+    // same rounding as the int8 network weights & activations quantization
+    const float inv_scale = 1.f / scale;
+    for ( size_t i=0; i<size; i++ )
+        out[i] = static_cast<float>( std::max( -127L, std::min( 127L, std::lrint( in[i] * inv_scale ) ) ) ) * scale;
+}
+
+inline float _max_abs( const float* in, const size_t size )
+{
+    float _max = 0.f;
+    for ( size_t i=0; i<size; i++ )
+        _max = std::max( _max, std::fabs( in[i] ) );
+    return _max;
+}
+
+void tensor_operation::fake_quantize( const tensor& input, const float scale, tensor& output )
+{
+    PROFILE_COUNT( "fake_quantize" );
+    _assert_same_sizes( input, output );
+
+    const size_t _size = input.w() * input.h();
+
+    tensor_foreach_p( input.d1(), input.d2() ) {
+        _fake_quantize( &input.m_tensor_array[d1][d2].data()[0], &output.m_tensor_array[d1][d2].data()[0], _size, scale );
+    }
+}
+
+void tensor_operation::fake_quantize( const tensor& input, const quantize_mode qm, tensor& output )
+{
+    PROFILE_COUNT( "fake_quantize" );
+    _assert_same_sizes( input, output );
+
+    const size_t _size = input.w() * input.h();
+    const size_t _row_size = ( qm == quantize_mode::rows ) ? input.h() : _size;
+    const float _layer_max = ( qm == quantize_mode::layer ) ? input.norm_inf() : 0.f;
+
+    for ( auto d2 = size_t(0); d2 < input.d2(); d2++ )
+    {
+        // feature map scale is shared by all its replications (e.g. all input maps of a filter)
+        float _map_max = 0.f;
+        if ( qm == quantize_mode::maps )
+            for ( auto d1 = size_t(0); d1 < input.d1(); d1++ )
+                _map_max = std::max( _map_max, _max_abs( &input.m_tensor_array[d1][d2].data()[0], _size ) );
+
+        for ( auto d1 = size_t(0); d1 < input.d1(); d1++ )
+        {
+            const float* _in = &input.m_tensor_array[d1][d2].data()[0];
+            float* _out = &output.m_tensor_array[d1][d2].data()[0];
+
+            for ( size_t r=0; r<_size; r+=_row_size )
+            {
+                const float _max = ( qm == quantize_mode::layer ) ? _layer_max :
+                    ( ( qm == quantize_mode::maps ) ? _map_max : _max_abs( _in + r, _row_size ) );
+
+                _fake_quantize( _in + r, _out + r, _row_size, quantize_scale( _max ) );
+            }
+        }
+    }
+}
+
+tensor tensor_operation::d_fake_quantize( const tensor& input, const float scale )
+{
+    PROFILE_COUNT( "d_fake_quantize" );
+    tensor output;
+    output.resize( input );
+
+    const float _clamp = s_int8_range * scale;
 
     tensor_foreach_p( input.d1(), input.d2() ) {
-        std::for_each(  input.m_tensor_array[d1][d2].data().begin(),
+        std::transform( input.m_tensor_array[d1][d2].data().begin(),
                         input.m_tensor_array[d1][d2].data().end(),
-                        [&bernoulli]( float& a ) { a = bernoulli.gen<float>(); } );
+                        output.m_tensor_array[d1][d2].data().begin(),
+                        [_clamp]( const float a ) { return ( std::fabs( a ) <= _clamp ) ? 1.f : 0.f; } );
+    }
+
+    return output;
+}
+
+void tensor_operation::prune( tensor& input, const float sparsity, tensor& mask )
+{
+    PROFILE_COUNT( "prune" );
+    if ( ( sparsity < 0.f ) || ( sparsity > 1.f ) )
+        throw network_exception( "invalid pruning sparsity" );
+
+    mask.resize( input );
+
+    const size_t _size = input.w() * input.h();
+    const size_t _pruned = static_cast<size_t>( std::lround( sparsity * static_cast<float>( input.size() ) ) );
+
+    // magnitude threshold is the largest pruned magnitude
+    std::vector<float> _magnitudes;
+    _magnitudes.reserve( input.size() );
+    tensor_foreach_p( input.d1(), input.d2() ) {
+        const float* _in = &input.m_tensor_array[d1][d2].data()[0];
+        for ( size_t i=0; i<_size; i++ )
+            _magnitudes.push_back( std::fabs( _in[i] ) );
+    }
+
+    float _threshold = -1.f;
+    size_t _ties = 0;
+    if ( _pruned )
+    {
+        std::nth_element( _magnitudes.begin(), _magnitudes.begin() + ( _pruned - 1 ), _magnitudes.end() );
+        _threshold = _magnitudes[_pruned - 1];
+
+        // elements equal to the threshold are pruned in order, until exactly the requested count is reached
+        _ties = _pruned - std::count_if( _magnitudes.begin(), _magnitudes.end(),
+            [_threshold]( const float m ) { return m < _threshold; } );
+    }
+
+    tensor_foreach_p( input.d1(), input.d2() ) {
+        float* _in = &input.m_tensor_array[d1][d2].data()[0];
+        float* _mask = &mask.m_tensor_array[d1][d2].data()[0];
+        for ( size_t i=0; i<_size; i++ )
+        {
+            const float _magnitude = std::fabs( _in[i] );
+            bool _prune = ( _magnitude < _threshold );
+            if ( !_prune && ( _magnitude == _threshold ) && _ties )
+            {
+                _prune = true;
+                --_ties;
+            }
+
+            _mask[i] = _prune ? 0.f : 1.f;
+            if ( _prune )
+                _in[i] = 0.f;
+        }
     }
 }
 
 tensor tensor_operation::binary_operator( const tensor& inputA, const tensor& inputB, std::function<float (const float&,const float&)> op )
 {
+    PROFILE_COUNT( "binary_operator" );
     _assert_same_sizes( inputA, inputB );
 
     tensor output;
@@ -636,12 +822,14 @@ tensor tensor_operation::binary_operator( const tensor& inputA, const tensor& in
 template<>
 void tensor_operation::optimize<tensor_operation::optimize_mode::redux>( const std::shared_ptr<tensor_solver_iface>& solver, tensor* input, tensor** input_cache, const tensor* deltas )
 {
+    PROFILE_COUNT( "optimize" );
     solver->update_redux( *input, input_cache, *deltas );
 }
 
 template<>
 void tensor_operation::optimize<tensor_operation::optimize_mode::std>( const std::shared_ptr<tensor_solver_iface>& solver, tensor* input, tensor** input_cache, const tensor* deltas )
 {
+    PROFILE_COUNT( "optimize" );
     solver->update( *input, input_cache, *deltas );
 }
 
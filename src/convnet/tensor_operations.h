@@ -29,6 +29,8 @@ THE SOFTWARE.
 
 #include "tensor.h"
 
+namespace neurocl { namespace random { class philox_generator; } }
+
 namespace neurocl { namespace convnet {
 
 class tensor_solver_iface;
@@ -56,6 +58,13 @@ public:
         redux
     };
 
+    enum class quantize_mode
+    {
+        layer = 0,  // single scale
+        maps,       // scale per output feature map (d2)
+        rows        // scale per matrix row
+    };
+
 public:
 
     // returns aB (scalar product)
@@ -79,6 +88,9 @@ public:
     // ungroups input matrix into multiple ones
     static void ungroup( const tensor& input, tensor& output );
 
+    // copies input into a same sized output, without reallocation
+    static void copy( const tensor& input, tensor& output );
+
     // returns A/B (element division)
     static tensor elediv( const tensor& inputA, const tensor& inputB );
 
@@ -100,6 +112,9 @@ public:
     // returns element wise square root
     static tensor sqrt( const tensor& input );
 
+    // returns element wise max( decay * A, |B| )
+    static tensor decayed_max_abs( const tensor& inputA, const tensor& inputB, const float decay );
+
     template<kernel_mode km, pad_mode pm>
     static tensor convolve_add_forward( const tensor& input, const tensor& filter, const int stride );
 
@@ -115,7 +130,22 @@ public:
 
     static tensor uniform_sum( const tensor& input );
 
+    // fills input with 0/1 values drawn with probability p, from a new random stream
     static void bernoulli( tensor& input, const float p );
+    // fills input with 0/1 values drawn with probability p, from a given random stream
+    static void bernoulli( tensor& input, const float p, random::philox_generator& rng );
+
+    // returns symmetric int8 quantization scale of a max absolute value
+    static float quantize_scale( const float max_abs );
+    // int8 fake quantizes input into a same sized output (values rounded & clamped to scale steps, but kept as floats)
+    static void fake_quantize( const tensor& input, const float scale, tensor& output );
+    // int8 fake quantizes input into a same sized output, with max absolute value scales per tensor, feature map or matrix row
+    static void fake_quantize( const tensor& input, const quantize_mode qm, tensor& output );
+    // returns fake quantization straight-through gradient mask (null for values clamped by the quantization)
+    static tensor d_fake_quantize( const tensor& input, const float scale );
+
+    // prunes the smallest magnitude elements of input (sparsity ratio), mask is null for pruned elements and 1 otherwise
+    static void prune( tensor& input, const float sparsity, tensor& mask );
 
     static tensor binary_operator( const tensor& inputA, const tensor& inputB, std::function<float (const float&,const float&)> op );
 
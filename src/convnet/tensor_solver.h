@@ -42,6 +42,10 @@ public:
 
     virtual void update( tensor& input, tensor** input_cache, const tensor& gradient ) = 0;
     virtual void update_redux( tensor& input, tensor** input_cache, const tensor& gradient ) = 0;
+
+    virtual size_t get_state_size() = 0;
+    virtual void get_state( float* state ) = 0;
+    virtual void set_state( const float* state ) = 0;
 };
 
 template<class solverT>
@@ -81,6 +85,21 @@ public:
         m_solver->update_redux( input, input_cache, gradient );
     }
 
+    size_t get_state_size() override
+    {
+        return m_solver->get_state_size();
+    }
+
+    void get_state( float* state ) override
+    {
+        m_solver->get_state( state );
+    }
+
+    void set_state( const float* state ) override
+    {
+        m_solver->set_state( state );
+    }
+
 private:
 
     void _init()
@@ -0,0 +1,188 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "tensor_sparse.h"
+
+#include "common/network_exception.h"
+
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+#elif defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+namespace neurocl { namespace convnet {
+
+// sparse row dot product : values are contiguous, dense vector elements are gathered
+inline float _sparse_dot( const float* values, const std::uint32_t* columns, const size_t size, const float* x, const size_t x_stride )
+{
+    float sum = 0.f;
+    size_t i = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+    float32x4_t _neon_sum = vdupq_n_f32( 0.f );
+
+    for ( ; i + 4 <= size; i += 4 )
+    {
+        const float _gather[4] = { x[columns[i] * x_stride], x[columns[i+1] * x_stride],
+            x[columns[i+2] * x_stride], x[columns[i+3] * x_stride] };
+        _neon_sum = vmlaq_f32( _neon_sum, vld1q_f32( values + i ), vld1q_f32( _gather ) );
+    }
+
+    const float32x2_t _neon_half = vadd_f32( vget_low_f32( _neon_sum ), vget_high_f32( _neon_sum ) );
+    sum = vget_lane_f32( vpadd_f32( _neon_half, _neon_half ), 0 );
+
+#elif defined(__SSE2__)
+
+    __m128 _mm_sum = _mm_setzero_ps();
+
+#if defined(__AVX2__)
+    // hardware gather for contiguous dense vectors
+    if ( x_stride == 1 )
+    {
+        __m256 _mm256_sum = _mm256_setzero_ps();
+
+        for ( ; i + 8 <= size; i += 8 )
+        {
+            const __m256i _mm256_idx = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( columns + i ) );
+            _mm256_sum = _mm256_add_ps( _mm256_sum,
+                _mm256_mul_ps( _mm256_loadu_ps( values + i ), _mm256_i32gather_ps( x, _mm256_idx, 4 ) ) );
+        }
+
+        _mm_sum = _mm_add_ps( _mm256_castps256_ps128( _mm256_sum ), _mm256_extractf128_ps( _mm256_sum, 1 ) );
+    }
+#endif
+
+    for ( ; i + 4 <= size; i += 4 )
+    {
+        const __m128 _mm_gather = _mm_setr_ps( x[columns[i] * x_stride], x[columns[i+1] * x_stride],
+            x[columns[i+2] * x_stride], x[columns[i+3] * x_stride] );
+        _mm_sum = _mm_add_ps( _mm_sum, _mm_mul_ps( _mm_loadu_ps( values + i ), _mm_gather ) );
+    }
+
+    _mm_sum = _mm_add_ps( _mm_sum, _mm_movehl_ps( _mm_sum, _mm_sum ) );
+    _mm_sum = _mm_add_ss( _mm_sum, _mm_shuffle_ps( _mm_sum, _mm_sum, 1 ) );
+    sum = _mm_cvtss_f32( _mm_sum );
+
+#endif
+
+    // end of the row in non-dividable-by-4 size case
+    for ( ; i < size; i++ )
+        sum += values[i] * x[columns[i] * x_stride];
+
+    return sum;
+}
+
+void tensor_sparse::build( const tensor& weights, const float threshold )
+{
+    m_matrices.clear();
+
+    if ( weights.d1() != 1 )
+        throw network_exception( "operation not supported for replicated tensors" );
+
+    const size_t _size = weights.w() * weights.h();
+
+    size_t _nulls = 0;
+    for ( auto d2 = size_t(0); d2 < weights.d2(); d2++ )
+    {
+        const float* _w = &weights.c_m( 0, d2, {} ).data()[0];
+        _nulls += std::count( _w, _w + _size, 0.f );
+    }
+
+    m_sparsity = weights.size() ? ( static_cast<float>( _nulls ) / static_cast<float>( weights.size() ) ) : 0.f;
+
+    // dense products are faster for moderately pruned weights
+    if ( !weights.size() || ( m_sparsity < threshold ) )
+        return;
+
+    m_matrices.resize( weights.d2() );
+
+    for ( auto d2 = size_t(0); d2 < weights.d2(); d2++ )
+    {
+        const float* _w = &weights.c_m( 0, d2, {} ).data()[0];
+        csr_matrix& _csr = m_matrices[d2];
+
+        _csr.rows = weights.w();
+        _csr.cols = weights.h();
+        _csr.row_offsets.assign( 1, 0 );
+        _csr.columns.clear();
+        _csr.values.clear();
+
+        for ( size_t r=0; r<_csr.rows; r++ )
+        {
+            for ( size_t c=0; c<_csr.cols; c++ )
+            {
+                const float _value = _w[r * _csr.cols + c];
+                if ( _value != 0.f )
+                {
+                    _csr.columns.push_back( static_cast<std::uint32_t>( c ) );
+                    _csr.values.push_back( _value );
+                }
+            }
+            _csr.row_offsets.push_back( static_cast<std::uint32_t>( _csr.values.size() ) );
+        }
+    }
+}
+
+tensor tensor_sparse::muladd( const tensor& inputB, const tensor& inputC ) const
+{
+    if ( ( inputB.d1() != 1 ) || ( inputC.d1() != 1 ) || ( inputB.d2() != m_matrices.size() ) || ( inputC.d2() != m_matrices.size() ) )
+        throw network_exception( "inconsistent tensor multiply/add size" );
+
+    tensor output;
+    output.resize( inputC ); // output is homogenous to inputC
+
+    const size_t _columns = inputC.h();
+
+    for ( auto d2 = size_t(0); d2 < m_matrices.size(); d2++ )
+    {
+        const csr_matrix& _csr = m_matrices[d2];
+
+        if ( ( inputB.w() != _csr.cols ) || ( inputC.w() != _csr.rows ) || ( inputB.h() != _columns ) )
+            throw network_exception( "inconsistent tensor multiply/add size" );
+
+        const float* _b = &inputB.c_m( 0, d2, {} ).data()[0];
+        const float* _c = &inputC.c_m( 0, d2, {} ).data()[0];
+        float* _out = &output.m( 0, d2, {} ).data()[0];
+
+        for ( size_t r=0; r<_csr.rows; r++ )
+        {
+            const size_t _offset = _csr.row_offsets[r];
+            const size_t _row_size = _csr.row_offsets[r+1] - _offset;
+
+            for ( size_t j=0; j<_columns; j++ )
+                _out[r * _columns + j] = _c[r * _columns + j] +
+                    _sparse_dot( _csr.values.data() + _offset, _csr.columns.data() + _offset, _row_size, _b + j, _columns );
+        }
+    }
+
+    return output;
+}
+
+} /*namespace neurocl*/ } /*namespace convnet*/
@@ -0,0 +1,79 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef TENSOR_SPARSE_H
+#define TENSOR_SPARSE_H
+
+#include "common/export.h"
+
+#include "tensor.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace neurocl { namespace convnet {
+
+/**
+ *  Compressed sparse row (CSR) copy of pruned weights matrices (one per feature map), used for
+ *  inference sparse matrix products when enough weights are null.
+ */
+class NEUROCL_PUBLIC tensor_sparse
+{
+public:
+
+    tensor_sparse() : m_sparsity( 0.f ) {}
+    virtual ~tensor_sparse() {}
+
+    //! build sparse matrices from dense weights, only if their null weights ratio reaches the given threshold
+    void build( const tensor& weights, const float threshold );
+    void clear() { m_matrices.clear(); }
+
+    //! check if sparse matrices are built
+    bool empty() const { return m_matrices.empty(); }
+
+    //! null weights ratio of the last built weights
+    float sparsity() const { return m_sparsity; }
+
+    //! returns A.B + C, A being the sparse matrices (same as tensor_operation::muladd)
+    tensor muladd( const tensor& inputB, const tensor& inputC ) const;
+
+private:
+
+    struct csr_matrix
+    {
+        size_t rows;
+        size_t cols;
+        std::vector<std::uint32_t> row_offsets; // rows + 1 offsets in columns & values
+        std::vector<std::uint32_t> columns;
+        std::vector<float> values;
+    };
+
+    std::vector<csr_matrix> m_matrices;
+
+    float m_sparsity;
+};
+
+} /*namespace neurocl*/ } /*namespace convnet*/
+
+#endif //TENSOR_SPARSE_H
@@ -28,10 +28,18 @@ THE SOFTWARE.
 #include <boost/format.hpp>
 #include <boost/container/stable_vector.hpp>
 
+#include <algorithm>
 #include <map>
 
 namespace neurocl { namespace convnet {
 
+struct tensor_tank_marker
+{
+    bool shared_empty;
+    std::map<std::string,std::map<std::string,size_t>> cumulative_sizes;
+    std::map<std::string,std::map<std::string,size_t>> standard_sizes;
+};
+
 class tensor_tank
 {
 public:
@@ -90,6 +98,28 @@ public:
         return &t;
     }
 
+    //! tank state, tensors emplaced afterwards can be released
+    using marker = tensor_tank_marker;
+
+    marker mark() const
+    {
+        marker m{ m_shared_tensor_tank.empty(), _sizes( m_cumulative_tensor_tank ), _sizes( m_standard_tensor_tank ) };
+        return m;
+    }
+
+    //! release tensors emplaced since marker, networks using them must have been destroyed
+    //! (shared tensors are only released if there were none at marker time)
+    void release( const marker& m )
+    {
+        if ( m.shared_empty )
+            m_shared_tensor_tank.clear();
+
+        _release( m.cumulative_sizes, m_cumulative_tensor_tank );
+        _release( m.standard_sizes, m_standard_tensor_tank );
+    }
+
+    bool shared_empty() const { return m_shared_tensor_tank.empty(); }
+
     void accumulate()
     {
         for ( auto& tank : m_cumulative_tensor_tank )
@@ -109,6 +139,35 @@ private:
     tensor_tank() {}
     virtual ~tensor_tank() {}
 
+    static std::map<std::string,std::map<std::string,size_t>> _sizes( const std::map<std::string,multi_tensor_tank>& tank )
+    {
+        std::map<std::string,std::map<std::string,size_t>> sizes;
+        for ( const auto& t_map : tank )
+            for ( const auto& t_vec : t_map.second )
+                sizes[t_map.first][t_vec.first] = t_vec.second.size();
+        return sizes;
+    }
+
+    static void _release( const std::map<std::string,std::map<std::string,size_t>>& sizes, std::map<std::string,multi_tensor_tank>& tank )
+    {
+        for ( auto& t_map : tank )
+        {
+            for ( auto& t_vec : t_map.second )
+            {
+                size_t size = 0;
+                const auto _sizes = sizes.find( t_map.first );
+                if ( _sizes != sizes.end() )
+                {
+                    const auto _size = _sizes->second.find( t_vec.first );
+                    if ( _size != _sizes->second.end() )
+                        size = _size->second;
+                }
+                if ( size < t_vec.second.size() )
+                    t_vec.second.erase( t_vec.second.begin() + size, t_vec.second.end() );
+            }
+        }
+    }
+
     tensor& _emplace( const std::string& key, multi_tensor_tank& map )
     {
         auto& t_vec = map[key];
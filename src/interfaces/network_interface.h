@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include <boost/shared_array.hpp>
 
+#include <algorithm>
 #include <cstddef>
 
 namespace neurocl {
@@ -108,6 +109,48 @@ public:
     //! get output values
     virtual const output_ptr output() = 0;
 
+    //! batched feed forward/back propagation of contiguously stored samples (gradients are accumulated)
+    virtual void batch_feed_back(   const size_t& batch_size,
+                                    const size_t& in_size, const float* in,
+                                    const size_t& out_size, const float* out )
+    {
+        // default implementation iterates over samples
+        for ( size_t b=0; b<batch_size; b++ )
+        {
+            set_input( in_size, in + b * in_size );
+            set_output( out_size, out + b * out_size );
+            feed_forward();
+            back_propagate();
+        }
+    }
+    //! batched feed forward of contiguously stored samples, outputs are stored contiguously
+    virtual void batch_feed_forward(    const size_t& batch_size,
+                                        const size_t& in_size, const float* in,
+                                        const size_t& out_size, float* out )
+    {
+        // default implementation iterates over samples
+        for ( size_t b=0; b<batch_size; b++ )
+        {
+            set_input( in_size, in + b * in_size );
+            feed_forward();
+            const output_ptr _output = output();
+            std::copy( _output.outputs.get(), _output.outputs.get() + std::min( out_size, _output.num_outputs ), out + b * out_size );
+        }
+    }
+
+    //! calibrate reduced precision inference on contiguously stored samples (nothing to do for float implementations)
+    virtual void calibrate( const size_t& samples_size, const size_t& in_size, const float* in ) {}
+
+    //! prune smallest magnitude weights of prunable layers up to a sparsity ratio (false if pruning is not managed)
+    virtual bool prune( const float sparsity ) { return false; }
+
+    //! training state size : parameters, solver caches & solver scalars (null if checkpointing is not managed)
+    virtual size_t training_state_size() { return 0; }
+    //! copy training state to a preallocated buffer of training_state_size() floats
+    virtual void get_training_state( float* state ) {}
+    //! restore training state from a buffer of training_state_size() floats
+    virtual void set_training_state( const float* state ) {}
+
     //! network parameters dump
     virtual const std::string dump_weights() = 0;
     virtual const std::string dump_bias() = 0;
@@ -66,6 +66,12 @@ public:
                                 const size_t& batch_size,
                                 t_progress_fct progress_fct = t_progress_fct() ) = 0;
 
+    //! train a mini-batch of contiguously stored samples, straight from the caller buffers (training flag IS managed)
+    //! returns the mini-batch loss
+    virtual float train_batch(  const size_t batch_size,
+                                const size_t isample_size, const float* inputs,
+                                const size_t osample_size, const float* outputs ) = 0;
+
     // prepare training epoch
     virtual void prepare_training_epoch() = 0;
     // finalize training epoch
@@ -76,10 +82,40 @@ public:
 	virtual void compute_augmented_output( sample& s, const std::shared_ptr<samples_augmenter>& smp_augmenter ) = 0;
     //! compute network output for multiple samples
     virtual void compute_output( std::vector<sample>& s ) = 0;
+    //! compute network outputs for contiguously stored samples, straight from/to the caller buffers
+    virtual void compute_output( const size_t batch_size,
+                                 const size_t isample_size, const float* inputs,
+                                 const size_t osample_size, float* outputs ) = 0;
+
+    //! calibrate reduced precision inference on a samples set
+    virtual void calibrate( const samples_manager& smp_manager ) = 0;
+
+    //! iterative magnitude pruning up to a target sparsity ratio, in given steps (network is fine-tuned
+    //! with epoch_size mini-batch epochs of the samples set after each step, and saved at the end)
+    virtual void prune( const samples_manager& smp_manager,
+                        const float sparsity,
+                        const size_t& steps,
+                        const size_t& epoch_size,
+                        const size_t& batch_size ) = 0;
 
     //! gradient check
 	virtual void gradient_check( const sample& s ) = 0;
 
+    //! enable/disable runtime profiling (instrumentation requires a PROFILING_ENABLED build)
+    virtual void set_profiling( const bool enable ) = 0;
+    //! clear profiling results
+    virtual void reset_profiling() = 0;
+    //! profiling results table : layers phases wall times, tensor operations calls, allocated bytes & samples/sec
+    virtual const std::string profiling_report() = 0;
+    //! dump profiled layers phases as a Chrome trace JSON file
+    virtual void dump_profiling_trace( const std::string& filename ) = 0;
+
+    //! enable/disable runtime allocations tracking, optionally flagging allocations made after the first
+    //! training mini-batch (hook requires an ALLOCATION_TRACKING_ENABLED build)
+    virtual void set_allocation_tracking( const bool enable, const bool steady_state_check = false ) = 0;
+    //! allocations count & bytes per layer and phase, with steady state violations
+    virtual const std::string allocation_report() = 0;
+
     //! dump network parameters
     virtual void dump_weights() = 0;
     virtual void dump_bias() = 0;
@@ -71,11 +71,7 @@ template<class T>
 void random_normal_init( T& container, const float stddev = 1.f )
 {
     random::rand_gaussian_generator rgg( 0.f, stddev );
-
-    for( auto& element : container.data() )
-    {
-        element = rgg();
-    }
+    rgg.fill( container.data().begin(), container.data().size() );
 }
 
 layer_bnu::layer_bnu()
@@ -122,7 +118,7 @@ const std::string layer_bnu::dump_activations() const
     return dump_vec( m_activations );
 }
 
-network_bnu_base::network_bnu_base() : m_training_samples( 0 ), m_learning_rate( 3.0f/*0.01f*/ ), m_weight_decay( 0.0f )
+network_bnu_base::network_bnu_base() : m_training( false ), m_training_samples( 0 ), m_learning_rate( 3.0f/*0.01f*/ ), m_weight_decay( 0.0f )
 {
     const network_config& nc = network_config::instance();
     nc.update_optional( "learning_rate", m_learning_rate );
@@ -167,6 +163,8 @@ void network_bnu_base::add_layers_2d( const std::vector<layer_size>& layer_sizes
         const layer_size& _next_layer_size = layer_sizes[idx+1];
         m_layers[idx].populate( _size, _next_layer_size );
     }
+
+    _parameters_changed();
 }
 
 const layer_ptr network_bnu_base::get_layer_ptr( const size_t layer_idx )
@@ -200,6 +198,42 @@ void network_bnu_base::set_layer_ptr( const size_t layer_idx, const layer_ptr& l
     std::copy( layer.weights.get(), layer.weights.get() + layer.num_weights, &weights.data()[0] );
     vectorF& bias = m_layers[layer_idx].bias();
     std::copy( layer.bias.get(), layer.bias.get() + layer.num_bias, &bias.data()[0] );
+
+    _parameters_changed();
+}
+
+// NOTE : plain gradient descent, training state is made of the parameters only
+size_t network_bnu_base::training_state_size()
+{
+    size_t size = 0;
+    for ( auto& _layer : m_layers )
+        size += _layer.weights().data().size() + _layer.bias().size();
+
+    return size;
+}
+
+void network_bnu_base::get_training_state( float* state )
+{
+    for ( auto& _layer : m_layers )
+    {
+        state = std::copy( _layer.weights().data().begin(), _layer.weights().data().end(), state );
+        state = std::copy( _layer.bias().data().begin(), _layer.bias().data().end(), state );
+    }
+}
+
+void network_bnu_base::set_training_state( const float* state )
+{
+    for ( auto& _layer : m_layers )
+    {
+        matrixF& weights = _layer.weights();
+        vectorF& bias = _layer.bias();
+        std::copy( state, state + weights.data().size(), weights.data().begin() );
+        state += weights.data().size();
+        std::copy( state, state + bias.size(), bias.data().begin() );
+        state += bias.size();
+    }
+
+    _parameters_changed();
 }
 
 const output_ptr network_bnu_base::output()
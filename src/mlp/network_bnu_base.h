@@ -84,7 +84,7 @@ public:
     // Convention : input layer is index 0
     void add_layers_2d( const std::vector<layer_size>& layer_sizes ) final override;
 
-    void set_training( bool training ) final override { /*NOTHING TO DO YET*/ }
+    void set_training( bool training ) final override { m_training = training; }
 
     void set_input(  const size_t& in_size, const float* in ) final override;
     void set_output( const size_t& out_size, const float* out ) final override;
@@ -98,6 +98,10 @@ public:
     const layer_ptr get_layer_ptr( const size_t layer_idx ) final override;
     void set_layer_ptr( const size_t layer_idx, const layer_ptr& layer ) final override;
 
+    size_t training_state_size() final override;
+    void get_training_state( float* state ) final override;
+    void set_training_state( const float* state ) final override;
+
     const output_ptr output() final override;
 
     const std::string dump_weights() final override;
@@ -106,6 +110,13 @@ public:
 
 protected:
 
+    //! called whenever parameters are replaced from outside of the training loop
+    virtual void _parameters_changed() {}
+
+protected:
+
+    bool m_training;
+
     size_t m_training_samples;
 
     vectorF m_training_output;
@@ -24,12 +24,17 @@ THE SOFTWARE.
 
 #include "network_bnu_fast.h"
 
+#include "common/weights_file.h"
+#include "common/logger.h"
+
 #ifdef __x86_64__
 	#include "xmmintrin.h"
+	#include "emmintrin.h"
 
-	#define simd_load _mm_load_ps
-	#define simd_store _mm_store_ps
-#elif __arm__
+	// weights rows are not 16 bytes aligned when layer sizes are not multiple of 4
+	#define simd_load _mm_loadu_ps
+	#define simd_store _mm_storeu_ps
+#elif defined(__arm__) || defined(__aarch64__)
 	#include <arm_neon.h>
 
 	// for neon, alignment doesn't matter, so _mm_load_ps and _mm_loadu_ps are equivalent
@@ -45,8 +50,14 @@ namespace bnu = boost::numeric::ublas;
 
 namespace neurocl { namespace mlp {
 
-network_bnu_fast::network_bnu_fast()
+network_bnu_fast::network_bnu_fast() : m_reduced_dirty( true )
 {
+    m_weights_format = weights_file::configured_format();
+
+    if ( m_weights_format != half_format::FP32 )
+    {
+        LOGGER(info) << "network_bnu_fast::network_bnu_fast - inference runs on reduced precision weights" << std::endl;
+    }
 }
 
 inline float _sigmoid( float x )
@@ -86,7 +97,7 @@ inline float _reduce_sum( __m128 value )
 	//We also could have used to extract the 0th element:
 	//return _mm_extract_ps (shufl a, 0);
 }
-#elif __arm__
+#elif defined(__arm__) || defined(__aarch64__)
 
 inline float _reduce_sum( float32x4_t value )
 {
@@ -97,10 +108,173 @@ inline float _reduce_sum( float32x4_t value )
 
 #endif
 
+template<half_format F>
+inline float _widen( const std::uint16_t value );
+
+template<>
+inline float _widen<half_format::FP16>( const std::uint16_t value ) { return half_to_float( value ); }
+
+template<>
+inline float _widen<half_format::BF16>( const std::uint16_t value ) { return bfloat16_to_float( value ); }
+
+#ifdef __x86_64__
+
+template<half_format F>
+inline __m128 _widen_x4( const std::uint16_t* values );
+
+template<>
+inline __m128 _widen_x4<half_format::FP16>( const std::uint16_t* values )
+{
+#ifdef __F16C__
+	return _mm_cvtph_ps( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( values ) ) );
+#else
+	return _mm_setr_ps( half_to_float( values[0] ), half_to_float( values[1] ), half_to_float( values[2] ), half_to_float( values[3] ) );
+#endif
+}
+
+template<>
+inline __m128 _widen_x4<half_format::BF16>( const std::uint16_t* values )
+{
+	// bfloat16 is the upper half of a float32 : interleave with zeros
+	return _mm_castsi128_ps( _mm_unpacklo_epi16( _mm_setzero_si128(), _mm_loadl_epi64( reinterpret_cast<const __m128i*>( values ) ) ) );
+}
+
+#elif defined(__arm__) || defined(__aarch64__)
+
+template<half_format F>
+inline float32x4_t _widen_x4( const std::uint16_t* values );
+
+template<>
+inline float32x4_t _widen_x4<half_format::FP16>( const std::uint16_t* values )
+{
+#if defined(__aarch64__) || ( defined(__ARM_FP) && ( __ARM_FP & 2 ) )
+	return vcvt_f32_f16( vreinterpret_f16_u16( vld1_u16( values ) ) );
+#else
+	const float widened[4] = { half_to_float( values[0] ), half_to_float( values[1] ), half_to_float( values[2] ), half_to_float( values[3] ) };
+	return vld1q_f32( widened );
+#endif
+}
+
+template<>
+inline float32x4_t _widen_x4<half_format::BF16>( const std::uint16_t* values )
+{
+	// bfloat16 is the upper half of a float32 : widening shift
+	return vreinterpretq_f32_u32( vshll_n_u16( vld1_u16( values ), 16 ) );
+}
+
+#endif
+
+void network_bnu_fast::_pack_reduced_weights()
+{
+    m_reduced_weights.resize( m_layers.size()-1 );
+
+    for ( auto c = size_t(0); c < m_layers.size()-1; c++ )
+    {
+        auto& _weights = m_layers[c].weights();
+        m_reduced_weights[c].resize( _weights.data().size() );
+        narrow_floats( m_weights_format, &_weights.data()[0], _weights.data().size(), m_reduced_weights[c].data() );
+    }
+
+    m_reduced_dirty = false;
+}
+
+template<half_format F>
+void network_bnu_fast::_feed_forward_reduced()
+{
+    for ( auto c = size_t(0); c < m_layers.size()-1; c++ )
+    {
+        auto& _activations1 = m_layers[c].activations();
+        auto& _activations2 = m_layers[c+1].activations();
+        auto& _bias = m_layers[c].bias();
+
+        const auto rows = m_layers[c].weights().size1();
+        const auto cols = m_layers[c].weights().size2();
+        const std::uint16_t* _weights = m_reduced_weights[c].data();
+
+		auto tail_start = cols - ( cols % 4 );
+
+        float _temp_sum;
+
+#if defined(__arm__) || defined(__aarch64__)
+
+        float32x4_t _neon_temp_sum;
+
+        // same as float32 kernel, weights being widened on the fly
+        for ( auto i = size_t(0); i < rows; i++ )
+        {
+            const std::uint16_t* _row = _weights + i * cols;
+
+            _temp_sum = 0.f;
+
+            _neon_temp_sum = vdupq_n_f32( 0.f );
+
+            for ( auto j = size_t(0); j < tail_start; j+=4 )
+            {
+                float32x4_t _neon_a1x4 = simd_load( &_activations1[j] );
+                float32x4_t _neon_wx4 = _widen_x4<F>( _row + j );
+
+                _neon_temp_sum = vmlaq_f32( _neon_temp_sum, _neon_wx4, _neon_a1x4 );
+            }
+
+			for ( auto r = tail_start; r < cols; r++ )
+			{
+				_temp_sum += _widen<F>( _row[r] ) * _activations1[r];
+			}
+
+            _activations2[i] = _sigmoid( _temp_sum + _reduce_sum( _neon_temp_sum ) + _bias[i] );
+		}
+
+#elif __x86_64__
+
+		__m128 _mm_temp_sum;
+
+		// same as float32 kernel, weights being widened on the fly
+		for ( auto i = size_t(0); i < rows; i++ )
+		{
+			const std::uint16_t* _row = _weights + i * cols;
+
+			_temp_sum = 0.f;
+
+			_mm_temp_sum = _mm_setzero_ps();
+
+			for ( auto j = size_t(0); j < tail_start; j+=4 )
+			{
+				__m128 _mm_a1x4 = simd_load( &_activations1[j] );
+				__m128 _mm_wx4 = _widen_x4<F>( _row + j );
+
+				_mm_temp_sum = _mm_add_ps( _mm_temp_sum, _mm_mul_ps( _mm_wx4, _mm_a1x4 ) );
+			}
+
+			for ( auto r = tail_start; r < cols; r++ )
+			{
+				_temp_sum += _widen<F>( _row[r] ) * _activations1[r];
+			}
+
+			_activations2[i] = _sigmoid( _temp_sum + _reduce_sum( _mm_temp_sum ) + _bias[i] );
+		}
+
+#endif
+
+    }
+}
+
 void network_bnu_fast::feed_forward()
 {
     //LOGGER(info) << "network_bnu_fast::feed_forward( - " << m_layers.size() << " layers propagation" << std::endl;
 
+    // reduced precision weights are used for inference only
+    if ( !m_training && ( m_weights_format != half_format::FP32 ) )
+    {
+        if ( m_reduced_dirty )
+            _pack_reduced_weights();
+
+        if ( m_weights_format == half_format::FP16 )
+            _feed_forward_reduced<half_format::FP16>();
+        else
+            _feed_forward_reduced<half_format::BF16>();
+        return;
+    }
+
     for ( auto c = size_t(0); c < m_layers.size()-1; c++ )
     {
         auto& _activations1 = m_layers[c].activations();
@@ -112,7 +286,7 @@ void network_bnu_fast::feed_forward()
 
         float _temp_sum;
 
-#ifdef __arm__
+#if defined(__arm__) || defined(__aarch64__)
 
         float32x4_t _neon_temp_sum;
 
@@ -202,7 +376,7 @@ void network_bnu_fast::back_propagate()
 		// NB : still, the following section seems to remain slightly slower than the regular for loop...
 		// It is kept in place for further simd optimizations on avx/armv8 platforms
 
-#ifdef __arm__
+#if defined(__arm__) || defined(__aarch64__)
 
 		float32x4_t _neon_temp_sum;
 		// not used since we use vmlsq intrinsic to compute a*(1-a)=a-a^2
@@ -288,7 +462,7 @@ void network_bnu_fast::back_propagate()
 
 		auto tail_start = _w_deltas.size2() - ( _w_deltas.size2() % 4 );
 
-#ifdef __arm__
+#if defined(__arm__) || defined(__aarch64__)
 
 		for ( auto k = size_t(0); k < _w_deltas.size1(); k++ )
 		{
@@ -320,7 +494,7 @@ void network_bnu_fast::back_propagate()
         {
 			__m128 _mm_ex4 = _mm_set1_ps( _errors[k] );
 
-            for ( auto l = size_t(0); l < _w_deltas.size2(); l+=4 )
+            for ( auto l = size_t(0); l < tail_start; l+=4 )
             {
 				auto* p_w_deltas = &_w_deltas(k,l);
 
@@ -352,6 +526,8 @@ void network_bnu_fast::gradient_descent()
 
     auto invm = 1.f / static_cast<float>( m_training_samples );
 
+    m_reduced_dirty = true;
+
     for ( auto c = size_t(0); c < m_layers.size()-1; c++ ) // avoid output layer
     {
         //m_layers[c].weights() -= m_learning_rate * ( ( invm * m_layers[c].w_deltas() ) + ( m_weight_decay * m_layers[c].weights() ) );
@@ -361,11 +537,11 @@ void network_bnu_fast::gradient_descent()
 
 		auto tail_start = _weights.size2() - ( _weights.size2() % 4 );
 
-#ifdef __arm__
+#if defined(__arm__) || defined(__aarch64__)
 
 		for ( auto i = size_t(0); i < _weights.size1(); i++ )
 		{
-			for ( auto j = size_t(0); j < _weights.size2(); j+=4 )
+			for ( auto j = size_t(0); j < tail_start; j+=4 )
 			{
 				float32x4_t _neon_wx4 = simd_load( &_weights(i,j) );
 				float32x4_t _neon_wdx4 = simd_load( &_w_deltas(i,j) );
@@ -387,7 +563,7 @@ void network_bnu_fast::gradient_descent()
 
 		for ( auto i = size_t(0); i < _weights.size1(); i++ )
 		{
-			for ( auto j = size_t(0); j < _weights.size2(); j+=4 )
+			for ( auto j = size_t(0); j < tail_start; j+=4 )
 			{
 				__m128 _mm_wx4 = simd_load( &_weights(i,j) );
 				__m128 _mm_wdx4 = simd_load( &_w_deltas(i,j) );
@@ -27,6 +27,8 @@ THE SOFTWARE.
 
 #include "network_bnu_base.h"
 
+#include "common/half_float.h"
+
 namespace neurocl { namespace mlp {
 
 class network_bnu_fast final : public network_bnu_base
@@ -39,6 +41,25 @@ public:
     void feed_forward() override;
     void back_propagate() override;
     void gradient_descent() override;
+
+protected:
+
+    void _parameters_changed() override { m_reduced_dirty = true; }
+
+private:
+
+    void _pack_reduced_weights();
+
+    template<half_format F>
+    void _feed_forward_reduced();
+
+private:
+
+    // reduced precision weights copy, used by the inference kernel : it only saves memory bandwidth,
+    // float32 weights being kept alongside for training and saving
+    half_format m_weights_format;
+    std::vector< std::vector<std::uint16_t> > m_reduced_weights;
+    bool m_reduced_dirty;
 };
 
 } /*namespace neurocl*/ } /*namespace mlp*/
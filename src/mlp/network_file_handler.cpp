@@ -26,10 +26,10 @@ THE SOFTWARE.
 #include "network_interface_mlp.h"
 
 #include "common/network_exception.h"
+#include "common/weights_file.h"
 #include "common/logger.h"
 
 #include "common/portable_binary_archive/portable_binary_iarchive.hpp"
-#include "common/portable_binary_archive/portable_binary_oarchive.hpp"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
@@ -63,7 +63,7 @@ void network_file_handler::load_network_topology( const std::string& topology_pa
         throw "error opening topology config file";
     }
 
-    std::vector<layer_size> layer_sizes;
+    m_layer_sizes.clear();
     m_layers = 0;
 
     size_t cur_line = 0;
@@ -100,7 +100,7 @@ void network_file_handler::load_network_topology( const std::string& topology_pa
 
                 LOGGER(info) << "network_file_handler::load_network_topology - adding layer" << _idx << " of size " << _x << "x" << _y << std::endl;
 
-                layer_sizes.push_back( layer_size( _x, _y ) );
+                m_layer_sizes.push_back( layer_size( _x, _y ) );
 
                 ++m_layers;
             }
@@ -119,8 +119,8 @@ void network_file_handler::load_network_topology( const std::string& topology_pa
         }
     }
 
-    if ( !layer_sizes.empty() )
-        m_net->add_layers_2d( layer_sizes );
+    if ( !m_layer_sizes.empty() )
+        m_net->add_layers_2d( m_layer_sizes );
     else
         throw network_exception( "empty topology file" );
 }
@@ -140,6 +140,13 @@ void network_file_handler::load_network_weights( const std::string& weights_path
         return;
     }
 
+    // versioned weights file is memory mapped, legacy archive is deserialized
+    if ( weights_file::is_weights_file( weights_path ) )
+    {
+        _load_mapped_weights( weights_path );
+        return;
+    }
+
     std::ifstream input_weights( weights_path, std::ios::in | std::ios::binary );
 
     if ( input_weights.is_open() )
@@ -175,24 +182,43 @@ void network_file_handler::load_network_weights( const std::string& weights_path
     LOGGER(info) << "network_file_handler::load_network_weights - successfully loaded network weights" << std::endl;
 }
 
-void network_file_handler::save_network_weights()
+void network_file_handler::_load_mapped_weights( const std::string& weights_path )
 {
-    std::ofstream output_weights( m_weights_path, std::ios::out | std::ios::binary | std::ios::trunc );
+    std::shared_ptr<weights_file> file = std::make_shared<weights_file>( weights_path );
+
+    if ( file->layers_count() != m_layers-1 ) // output layer has no output weights
+        throw network_exception( "weights file does not match network topology" );
 
-    if ( output_weights.is_open() )
+    for ( size_t i=0; i<file->layers_count(); i++ )
     {
-        portable_binary_oarchive oar( output_weights, endian_little );
+        const weights_file_entry& entry = file->entry( i );
 
-        for ( size_t i=0; i<m_net->count_layers()-1; i++ ) // output layer has no output weights
-        {
-            LOGGER(info) << "network_file_handler::save_network_weights - saving layer" << i << " weights" << std::endl;
-            layer_ptr ptr = m_net->get_layer_ptr( i );
-            layer_storage l( ptr.num_weights, ptr.weights, ptr.num_bias, ptr.bias );
-            oar << l;
-        }
+        if ( entry.layer_index != i )
+            throw network_exception( "weights file does not match network topology" );
+
+        LOGGER(info) << "network_file_handler::load_network_weights - mapping layer" << i << " weights" << std::endl;
+
+        // parameters are copied straight from the mapped pages
+        layer_ptr lp( entry.num_weights, file->weights( i ), entry.num_bias, file->bias( i ) );
+        m_net->set_layer_ptr( i, lp );
     }
-    else
-      throw network_exception( "unable to open weights file for saving" );
+
+    LOGGER(info) << "network_file_handler::load_network_weights - successfully loaded network weights" << std::endl;
+}
+
+void network_file_handler::save_network_weights()
+{
+    std::vector<layer_ptr> ptrs;
+    std::vector<weights_file_layer> layers;
+
+    for ( size_t i=0; i<m_net->count_layers()-1; i++ ) // output layer has no output weights
+    {
+        LOGGER(info) << "network_file_handler::save_network_weights - saving layer" << i << " weights" << std::endl;
+        ptrs.push_back( m_net->get_layer_ptr( i ) );
+        layers.push_back( { i, ptrs.back().num_weights, ptrs.back().weights.get(), ptrs.back().num_bias, ptrs.back().bias.get() } );
+    }
+
+    weights_file::write( m_weights_path, layers, weights_file::configured_format() );
 }
 
 } /*namespace neurocl*/ } /*namespace mlp*/
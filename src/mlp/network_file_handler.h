@@ -25,6 +25,8 @@ THE SOFTWARE.
 #ifndef NETWORK_FILE_HANDLER_MLP_H
 #define NETWORK_FILE_HANDLER_MLP_H
 
+#include "network_interface_mlp.h"
+
 #include "interfaces/network_file_handler_interface.h"
 
 #include "common/layer_storage.h"
@@ -33,8 +35,6 @@ THE SOFTWARE.
 
 namespace neurocl { namespace mlp {
 
-class network_interface_mlp;
-
 class network_file_handler final : public network_file_handler_interface
 {
 public:
@@ -46,9 +46,17 @@ public:
     void load_network_weights( const std::string& weights_path ) override;
     void save_network_weights() override;
 
+    //! loaded topology layer sizes
+    const std::vector<layer_size>& layer_sizes() const { return m_layer_sizes; }
+
+private:
+
+    void _load_mapped_weights( const std::string& weights_path );
+
 private:
 
     size_t m_layers;
+    std::vector<layer_size> m_layer_sizes;
 
     std::string m_weights_path;
 
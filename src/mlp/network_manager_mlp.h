@@ -36,9 +36,12 @@ THE SOFTWARE.
     #include "network_vexcl.h"
 #endif
 
+#include "common/backend_selector.h"
 #include "common/network_exception.h"
 #include "common/network_manager.h"
 
+#include <map>
+
 namespace neurocl { namespace mlp {
 
 class network_manager_mlp : public network_manager
@@ -49,7 +52,8 @@ public:
     {
         MLP_IMPL_BNU_REF = 0,
 		MLP_IMPL_BNU_FAST,
-        MLP_IMPL_VEXCL
+        MLP_IMPL_VEXCL,
+        MLP_IMPL_AUTO // fastest available implementation, selected when loading topology
     };
 
 private:
@@ -64,38 +68,88 @@ private:
 		return std::make_shared<make_shared_enabler>( impl );
 	}
 
-    network_manager_mlp( const t_mlp_impl& impl )
+    network_manager_mlp( const t_mlp_impl& impl ) : m_impl( impl )
+    {
+        // automatic implementation is built once topology is known
+        if ( impl != t_mlp_impl::MLP_IMPL_AUTO )
+            _build( impl );
+    }
+
+    static std::shared_ptr<network_interface_mlp> _make_network( const t_mlp_impl& impl )
     {
         switch( impl )
         {
         case t_mlp_impl::MLP_IMPL_BNU_REF:
-            m_net = std::make_shared<network_bnu_ref>();
-            break;
+            return std::make_shared<network_bnu_ref>();
         case t_mlp_impl::MLP_IMPL_BNU_FAST:
     #ifdef SIMD_ENABLED
-            m_net = std::make_shared<network_bnu_fast>();
+            return std::make_shared<network_bnu_fast>();
     #else
             throw network_exception( "unmanaged mlp implementation (simd disabled)!" );
     #endif
-            break;
         case t_mlp_impl::MLP_IMPL_VEXCL:
     #ifdef VEXCL_ENABLED
-            m_net = std::make_shared<network_vexcl>();
+            return std::make_shared<network_vexcl>();
     #else
             throw network_exception( "unmanaged mlp implementation (opencl disabled)!" );
     #endif
-            break;
         default:
             throw network_exception( "unmanaged mlp implementation!" );
         }
+    }
+
+    void _build( const t_mlp_impl& impl )
+    {
+        m_net = _make_network( impl );
 
         m_net_file_handler = std::make_shared<network_file_handler>(
             std::static_pointer_cast<network_interface_mlp>( m_net ) );
     }
 
+    t_mlp_impl _select_impl( const std::string& topology_path )
+    {
+        std::map<std::string,t_mlp_impl> impls = { { "BNU_REF", t_mlp_impl::MLP_IMPL_BNU_REF } };
+    #ifdef SIMD_ENABLED
+        impls.emplace( "BNU_FAST", t_mlp_impl::MLP_IMPL_BNU_FAST );
+    #endif
+    #ifdef VEXCL_ENABLED
+        impls.emplace( "VEXCL", t_mlp_impl::MLP_IMPL_VEXCL );
+    #endif
+
+        std::vector<backend_selector::candidate> candidates;
+        for ( const auto& _impl : impls )
+        {
+            const t_mlp_impl impl = _impl.second;
+            candidates.push_back( { _impl.first, [impl,&topology_path]()
+            {
+                auto net = _make_network( impl );
+                network_file_handler file_handler( net );
+                file_handler.load_network_topology( topology_path );
+                return backend_selector::measure_training( *net,
+                    file_handler.layer_sizes().front().size(), file_handler.layer_sizes().back().size() );
+            } } );
+        }
+
+        backend_selector selector( "MLP", topology_path );
+        return impls.at( selector.select( candidates ) );
+    }
+
 public:
 
 	virtual ~network_manager_mlp() {}
+
+    //! load network topology & weights, selecting implementation first if automatic
+    void load_network( const std::string& topology_path, const std::string& weights_path ) override
+    {
+        if ( m_impl == t_mlp_impl::MLP_IMPL_AUTO )
+            _build( _select_impl( topology_path ) );
+
+        network_manager::load_network( topology_path, weights_path );
+    }
+
+private:
+
+    const t_mlp_impl m_impl;
 };
 
 } /*namespace neurocl*/ } /*namespace mlp*/
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #include "network_vexcl.h"
 
 #include "common/network_config.h"
+#include "common/vexcl_context.h"
 #include "common/network_exception.h"
 #include "common/network_random.h"
 
@@ -45,18 +46,6 @@ namespace neurocl { namespace mlp {
 VEX_CONSTANT(_zero, 0.f);
 VEX_CONSTANT(_one, 1.f);
 
-class my_vex_ctx
-{
-public:
-    static my_vex_ctx& instance() { static my_vex_ctx _ctx; return _ctx; }
-    vex::Context& get() { return m_ctx; }
-protected:
-	my_vex_ctx() : m_ctx( vex::Filter::GPU && vex::Filter::Count(1) ) {}
-    virtual ~my_vex_ctx() {}
-private:
-    vex::Context m_ctx;
-};
-
 template<typename T>
 const std::string dump_vec( const vex::vector<T>& vec, boost::optional<std::string> label = boost::none )
 {
@@ -116,6 +105,14 @@ void layer_vexcl::populate( const layer_size& cur_layer_size, const layer_size&
     m_errors = _zero();
 }
 
+void layer_vexcl::populate_batch( const size_t& batch_size )
+{
+    vex::Context& _ctx = my_vex_ctx::instance().get();
+
+    m_batch_activations = vex::vector<float>( _ctx, batch_size * m_activations.size() );
+    m_batch_errors = vex::vector<float>( _ctx, batch_size * m_activations.size() );
+}
+
 const std::string layer_vexcl::dump_weights() const
 {
     return dump_vec( m_output_weights );
@@ -131,7 +128,7 @@ const std::string layer_vexcl::dump_activations() const
     return dump_vec( m_activations );
 }
 
-network_vexcl::network_vexcl() : m_training_samples( 0 ), m_learning_rate( 3.0f/*0.01f*/ ), m_weight_decay( 0.0f )
+network_vexcl::network_vexcl() : m_training_samples( 0 ), m_batch_size( 0 ), m_batch_mode( false ), m_learning_rate( 3.0f/*0.01f*/ ), m_weight_decay( 0.0f )
 {
     const network_config& nc = network_config::instance();
     nc.update_optional( "learning_rate", m_learning_rate );
@@ -168,6 +165,7 @@ void network_vexcl::set_output( const size_t& out_size, const float* out )
 void network_vexcl::add_layers_2d( const std::vector<layer_size>& layer_sizes )
 {
     m_layers.resize( layer_sizes.size() );
+    m_batch_size = 0;
 
     // Last layer should be output layer
     const layer_size& _last_size = layer_sizes.back();
@@ -233,6 +231,8 @@ void network_vexcl::feed_forward()
 {
     //std::cout << m_layers.size() << " layers propagation" << std::endl;
 
+    m_batch_mode = false;
+
     for ( size_t i=0; i<m_layers.size()-1; i++ )
     {
         const size_t n = m_layers[i].w_size().first;
@@ -306,6 +306,133 @@ void network_vexcl::back_propagate()
     ++m_training_samples;
 }
 
+void network_vexcl::batch_feed_back(    const size_t& batch_size,
+                                        const size_t& in_size, const float* in,
+                                        const size_t& out_size, const float* out )
+{
+    if ( out_size != m_training_output.size() )
+        throw network_exception( "batch output size differs from allocated layer size!" );
+
+    _prepare_batch( batch_size, in_size, in );
+
+    // single host to device transfer for the whole mini-batch
+    vex::copy( out, out + batch_size * out_size, m_batch_training_output.begin() );
+
+    _batch_feed_forward();
+    _batch_back_propagate();
+}
+
+void network_vexcl::batch_feed_forward( const size_t& batch_size,
+                                        const size_t& in_size, const float* in,
+                                        const size_t& out_size, float* out )
+{
+    vex::vector<float>& output = m_layers.back().activations();
+
+    if ( out_size != output.size() )
+        throw network_exception( "batch output size differs from allocated layer size!" );
+
+    _prepare_batch( batch_size, in_size, in );
+
+    _batch_feed_forward();
+
+    // single device to host transfer for the whole mini-batch
+    vex::vector<float>& batch_output = m_layers.back().batch_activations();
+    vex::copy( batch_output.begin(), batch_output.end(), out );
+}
+
+void network_vexcl::_prepare_batch( const size_t& batch_size, const size_t& in_size, const float* in )
+{
+    if ( !batch_size )
+        throw network_exception( "empty batch!" );
+
+    if ( in_size != m_layers[0].activations().size() )
+        throw network_exception( "batch sample size differs from allocated layer size!" );
+
+    // device buffers are only reallocated when batch size changes
+    if ( batch_size != m_batch_size )
+    {
+        for ( auto& _layer : m_layers )
+            _layer.populate_batch( batch_size );
+
+        m_batch_training_output = vex::vector<float>( my_vex_ctx::instance().get(), batch_size * m_training_output.size() );
+
+        m_batch_size = batch_size;
+    }
+
+    vex::copy( in, in + batch_size * in_size, m_layers[0].batch_activations().begin() );
+
+    m_batch_mode = true;
+}
+
+void network_vexcl::_batch_feed_forward()
+{
+    const size_t b = m_batch_size;
+
+    for ( size_t i=0; i<m_layers.size()-1; i++ )
+    {
+        const size_t n = m_layers[i].w_size().first;
+        const size_t m = m_layers[i].w_size().second;
+
+        // [b][n] activations computed as a [b][n][m] product reduced along its last dimension
+        m_layers[i+1].batch_activations() = _one() / ( _one() + exp(
+            -( vex::reduce<vex::SUM>(
+                vex::extents[b][n][m],
+                vex::reshape( m_layers[i].weights(), vex::extents[b][n][m], vex::extents[1][2] )
+                *
+                vex::reshape( m_layers[i].batch_activations(), vex::extents[b][n][m], vex::extents[0][2] ),
+                2
+            )
+            + vex::reshape( m_layers[i].bias(), vex::extents[b][n], vex::extents[1] ) ) )
+        );
+    }
+}
+
+void network_vexcl::_batch_back_propagate()
+{
+    const size_t b = m_batch_size;
+
+    // Output layer error vectors
+    layer_vexcl& output_layer = m_layers.back();
+    output_layer.batch_errors() = output_layer.batch_activations() * ( _one() - output_layer.batch_activations() )
+        * ( output_layer.batch_activations() - m_batch_training_output );
+
+    // Hidden layers error vectors
+    for ( size_t i=m_layers.size()-2; i>0; i-- )
+    {
+        const size_t n = m_layers[i].w_size().first;
+        const size_t m = m_layers[i].w_size().second;
+
+        m_layers[i].batch_errors() = m_layers[i].batch_activations() * ( _one() - m_layers[i].batch_activations() )
+            *
+            vex::reduce<vex::SUM>(
+                vex::extents[b][m][n],
+                vex::reshape( m_layers[i].weights(), vex::extents[b][m][n], vex::extents[2][1] )
+                *
+                vex::reshape( m_layers[i+1].batch_errors(), vex::extents[b][m][n], vex::extents[0][2] ),
+                2
+            );
+    }
+
+    // Update gradients, accumulated over the whole mini-batch
+    for ( size_t i=0; i<m_layers.size()-1; i++ )
+    {
+        const size_t n = m_layers[i].w_size().first;
+        const size_t m = m_layers[i].w_size().second;
+
+        m_layers[i].w_deltas() += vex::reduce<vex::SUM>(
+            vex::extents[n][m][b],
+            vex::reshape( m_layers[i+1].batch_errors(), vex::extents[n][m][b], vex::extents[2][0] )
+            * vex::reshape( m_layers[i].batch_activations(), vex::extents[n][m][b], vex::extents[2][1] ),
+            2 );
+        m_layers[i].b_deltas() += vex::reduce<vex::SUM>(
+            vex::extents[n][b],
+            vex::reshape( m_layers[i+1].batch_errors(), vex::extents[n][b], vex::extents[1][0] ),
+            1 );
+    }
+
+    m_training_samples += b;
+}
+
 void network_vexcl::gradient_descent()
 {
     //LOGGER(info) << "network_bnu::gradient_descent - updating after " << m_training_samples << " backpropagations" << std::endl;
@@ -336,6 +463,15 @@ float network_vexcl::loss()
     vex::Reductor<float,vex::SUM> sum;
 
     layer_vexcl& output_layer = m_layers.back();
+
+    if ( m_batch_mode )
+    {
+        // mean loss over the last mini-batch
+        float _loss = sum( ( output_layer.batch_activations() - m_batch_training_output )
+            * ( output_layer.batch_activations() - m_batch_training_output ) );
+
+        return 0.5f * _loss / static_cast<float>( m_batch_training_output.size() );
+    }
     float _loss = sum( ( output_layer.activations() - vex::constant( m_training_output ) )
         * ( output_layer.activations() - vex::constant( m_training_output ) ) );
 
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #ifndef NETWORK_VEXCL_H
 #define NETWORK_VEXCL_H
 
+#include "common/export.h"
 #include "network_interface_mlp.h"
 
 #include <vexcl/vexcl.hpp>
@@ -39,6 +40,7 @@ public:
 	virtual ~layer_vexcl() {}
 
     void populate( const layer_size& cur_layer_size, const layer_size& next_layer_size );
+    void populate_batch( const size_t& batch_size );
 
     vex::vector<float>& bias() { return m_bias; }
     vex::vector<float>& activations() { return m_activations; }
@@ -46,6 +48,8 @@ public:
     vex::vector<float>& errors() { return m_errors; }
     vex::vector<float>& w_deltas() { return m_deltas_weight; }
     vex::vector<float>& b_deltas() { return m_deltas_bias; }
+    vex::vector<float>& batch_activations() { return m_batch_activations; }
+    vex::vector<float>& batch_errors() { return m_batch_errors; }
 
     std::pair<size_t,size_t>& w_size() { return m_weights_size; }
 
@@ -66,9 +70,13 @@ private:
     // http://web.stanford.edu/class/cs294a/sparseAutoencoder.pdf
     vex::vector<float> m_output_weights;
     vex::vector<float> m_deltas_weight;
+
+    // device resident mini-batch buffers (samples are stored contiguously)
+    vex::vector<float> m_batch_activations;
+    vex::vector<float> m_batch_errors;
 };
 
-class network_vexcl final : public network_interface_mlp
+class NEUROCL_PUBLIC network_vexcl final : public network_interface_mlp
 {
 public:
 
@@ -98,18 +106,35 @@ public:
 
     const output_ptr output() override;
 
+    void batch_feed_back(   const size_t& batch_size,
+                            const size_t& in_size, const float* in,
+                            const size_t& out_size, const float* out ) override;
+    void batch_feed_forward(    const size_t& batch_size,
+                                const size_t& in_size, const float* in,
+                                const size_t& out_size, float* out ) override;
+
     const std::string dump_weights() override;
     const std::string dump_bias() override;
     const std::string dump_activations() override;
 
+private:
+
+    void _prepare_batch( const size_t& batch_size, const size_t& in_size, const float* in );
+    void _batch_feed_forward();
+    void _batch_back_propagate();
+
 private:
 
     size_t m_training_samples;
 
+    size_t m_batch_size;
+    bool m_batch_mode; // last propagation was batched
+
     float m_learning_rate;  // [0.0..1.0]
     float m_weight_decay;   // [0.0..1.0]
 
     vex::vector<float> m_training_output;
+    vex::vector<float> m_batch_training_output;
 
     std::vector<layer_vexcl> m_layers;
 };
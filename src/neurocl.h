@@ -31,7 +31,9 @@ THE SOFTWARE.
 #include "common/network_exception.h"
 #include "common/learning_scheduler.h"
 #include "common/samples_manager.h"
+#include "common/samples_streamer.h"
 #include "common/iterative_trainer.h"
+#include "common/async_batch_trainer.h"
 #include "common/logger.h"
 
 #endif //NEUROCL_H
@@ -0,0 +1,70 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "allocation_counter.h"
+
+#ifdef ALLOCATION_TRACKING_ENABLED
+
+#include "common/allocation_tracker.h"
+
+// NOTE : the library already replaces the global operator new process wide, its counter is read instead
+std::uint64_t allocations_count()
+{
+    return neurocl::allocation_tracker::process_allocations();
+}
+
+#else
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// NOTE : kept in its own translation unit, so that replaced operators are never inlined in callers
+
+static std::atomic<std::uint64_t> s_allocations( 0 );
+
+std::uint64_t allocations_count()
+{
+    return s_allocations.load( std::memory_order_relaxed );
+}
+
+void* operator new( std::size_t size )
+{
+    s_allocations.fetch_add( 1, std::memory_order_relaxed );
+    if ( void* ptr = std::malloc( size ? size : 1 ) )
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete( void* ptr ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete( void* ptr, std::size_t ) noexcept
+{
+    std::free( ptr );
+}
+
+#endif
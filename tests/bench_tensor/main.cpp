@@ -0,0 +1,409 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2016 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "convnet/tensor_operations.h"
+#include "convnet/tensor_activations.h"
+#include "convnet/tensor_solver.h"
+
+#include "allocation_counter.h"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+namespace bfs = boost::filesystem;
+namespace po = boost::program_options;
+
+using namespace neurocl::convnet;
+using nto = tensor_operation;
+namespace nta = tensor_activations;
+
+struct layer_shape
+{
+    std::string type;
+    size_t x;
+    size_t y;
+    size_t z;
+    size_t f;
+};
+
+struct benchmark
+{
+    std::string name;
+    std::string shape;
+    double flops; // per call, 0 if not relevant
+    double bytes; // per call, compulsory memory traffic
+    std::function<void()> run;
+};
+
+struct benchmark_result
+{
+    size_t iterations;
+    double ns_per_call;
+    double allocs_per_call;
+};
+
+// same syntax as network_file_handler::load_network_topology, empty for MLP topologies
+std::vector<layer_shape> load_topology( const std::string& topology_path )
+{
+    std::ifstream topology( topology_path );
+    if ( !topology || !topology.is_open() )
+        throw std::runtime_error( "error opening topology file " + topology_path );
+
+    std::vector<layer_shape> shapes;
+    std::string line;
+    while ( std::getline( topology, line ) )
+    {
+        if ( !boost::starts_with( line, "layer" ) )
+            continue;
+
+        std::vector<std::string> split_vec;
+        boost::split( split_vec, line, boost::is_any_of(":x") );
+        // MLP topologies have no layer type
+        if ( split_vec.size() < 6 )
+            return std::vector<layer_shape>();
+
+        shapes.push_back( layer_shape{ split_vec[1],
+            std::stoul( split_vec[3] ), std::stoul( split_vec[4] ), std::stoul( split_vec[5] ),
+            ( split_vec.size() > 6 ) ? std::stoul( split_vec[6] ) : 0 } );
+    }
+    return shapes;
+}
+
+std::shared_ptr<tensor> random_tensor( const size_t w, const size_t h, const size_t d1, const size_t d2 )
+{
+    std::shared_ptr<tensor> t = std::make_shared<tensor>();
+    t->resize( w, h, d1, d2 );
+    t->uniform_fill_random( 1.f );
+    return t;
+}
+
+std::string shape_str( const size_t w, const size_t h, const size_t d1, const size_t d2 )
+{
+    return std::to_string( w ) + "x" + std::to_string( h ) + "x" + std::to_string( d1 ) + "x" + std::to_string( d2 );
+}
+
+void add_solver_benchmarks( std::vector<benchmark>& benchmarks, const std::string& prefix, const size_t w, const size_t h, const size_t d1, const size_t d2 )
+{
+    using impl = tensor_solver_factory::t_solver_impl;
+
+    const std::vector<std::pair<std::string,impl>> solvers{
+        { "SGD", impl::SOLVER_IMPL_SGD }, { "ADAGRAD", impl::SOLVER_IMPL_ADAGRAD },
+        { "ADADELTA", impl::SOLVER_IMPL_ADADELTA }, { "ADAM", impl::SOLVER_IMPL_ADAM },
+        { "ADAMAX", impl::SOLVER_IMPL_ADAMAX }, { "RMSPROP", impl::SOLVER_IMPL_RMSPROP } };
+
+    const double size = static_cast<double>( w * h * d1 * d2 );
+
+    for ( const auto& _solver : solvers )
+    {
+        std::shared_ptr<tensor_solver_iface> solver = tensor_solver_factory::build( _solver.second );
+        solver->set_size( 1 );
+
+        auto weights = random_tensor( w, h, d1, d2 );
+        auto deltas = random_tensor( w, h, d1, d2 );
+        auto caches = std::make_shared<std::vector<std::shared_ptr<tensor>>>();
+        auto caches_ptr = std::make_shared<std::vector<tensor*>>();
+        for ( size_t i=0; i<solver->get_cache_size(); i++ )
+        {
+            caches->push_back( random_tensor( w, h, d1, d2 ) );
+            caches_ptr->push_back( caches->back().get() );
+        }
+
+        // parameters & caches are read/written, gradients are read
+        benchmarks.push_back( benchmark{ prefix + "/optimize_" + _solver.first, shape_str( w, h, d1, d2 ),
+            0., 4. * size * ( 3. + 2. * caches->size() ),
+            [solver,weights,deltas,caches,caches_ptr]() {
+                nto::optimize<nto::optimize_mode::std>( solver, weights.get(), caches_ptr->data(), deltas.get() );
+            } } );
+    }
+}
+
+// benchmarks the operations each layer runs in training, with its actual shapes
+std::vector<benchmark> build_benchmarks( const std::string& topology_name, const std::vector<layer_shape>& shapes )
+{
+    std::vector<benchmark> benchmarks;
+
+    for ( size_t i=1; i<shapes.size(); i++ )
+    {
+        const layer_shape& p = shapes[i-1];
+        const layer_shape& l = shapes[i];
+        const std::string prefix = topology_name + "/" + l.type + std::to_string( i );
+
+        const double in_size = static_cast<double>( p.x * p.y * p.z );
+        const double out_size = static_cast<double>( l.x * l.y * l.z );
+
+        if ( l.type == "conv" )
+        {
+            const double macs = static_cast<double>( l.f * l.f * p.z * l.z ) * l.x * l.y;
+            const double filters_size = static_cast<double>( l.f * l.f * p.z * l.z );
+
+            auto input = random_tensor( p.x, p.y, 1, p.z );
+            auto filters = random_tensor( l.f, l.f, p.z, l.z );
+            auto errors = random_tensor( l.x, l.y, 1, l.z );
+            auto maps = random_tensor( l.x, l.y, 1, l.z );
+
+            benchmarks.push_back( benchmark{ prefix + "/convolve_add_forward", shape_str( p.x, p.y, 1, p.z ) + "*" + shape_str( l.f, l.f, p.z, l.z ),
+                2. * macs, 4. * ( in_size + filters_size + out_size ),
+                [input,filters]() { const tensor output = nto::convolve_add_forward<nto::kernel_mode::flip,nto::pad_mode::valid>( *input, *filters, 1 ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/convolve_add_backward", shape_str( l.x, l.y, 1, l.z ) + "*" + shape_str( l.f, l.f, p.z, l.z ),
+                2. * static_cast<double>( l.f * l.f * p.z * l.z ) * p.x * p.y, 4. * ( out_size + filters_size + in_size ),
+                [errors,filters]() { const tensor output = nto::convolve_add_backward<nto::kernel_mode::std,nto::pad_mode::full>( *errors, *filters, 1 ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/convolve_update", shape_str( p.x, p.y, 1, p.z ) + "*" + shape_str( l.x, l.y, 1, l.z ),
+                2. * macs, 4. * ( in_size + out_size + filters_size ),
+                [input,errors]() { const tensor output = nto::convolve_update<nto::kernel_mode::std,nto::pad_mode::valid>( *input, *errors, 1 ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/relu", shape_str( l.x, l.y, 1, l.z ),
+                out_size, 8. * out_size, [maps]() { nta::relu::f( *maps ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/d_relu", shape_str( l.x, l.y, 1, l.z ),
+                out_size, 8. * out_size, [maps]() { const tensor output = nta::relu::d_f( *maps ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/elemul", shape_str( l.x, l.y, 1, l.z ),
+                out_size, 12. * out_size, [maps,errors]() { const tensor output = nto::elemul( *maps, *errors ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/uniform_sum", shape_str( l.x, l.y, 1, l.z ),
+                out_size, 4. * ( out_size + l.z ), [errors]() { const tensor output = nto::uniform_sum( *errors ); } } );
+
+            add_solver_benchmarks( benchmarks, prefix, l.f, l.f, p.z, l.z );
+        }
+        else if ( l.type == "pool" )
+        {
+            const size_t subsample = p.x / l.x;
+
+            auto input = random_tensor( p.x, p.y, 1, p.z );
+            auto errors = random_tensor( l.x, l.y, 1, l.z );
+
+            benchmarks.push_back( benchmark{ prefix + "/subsample", shape_str( p.x, p.y, 1, p.z ) + "/" + std::to_string( subsample ),
+                in_size, 4. * ( in_size + out_size ),
+                [input,subsample]() { const tensor output = nto::subsample( *input, subsample ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/d_subsample", shape_str( l.x, l.y, 1, l.z ) + "/" + std::to_string( subsample ),
+                in_size, 4. * ( out_size + 2. * in_size ),
+                [errors,input,subsample]() { const tensor output = nto::d_subsample( *errors, *input, subsample ); } } );
+        }
+        else if ( l.type == "drop" )
+        {
+            auto maps = random_tensor( l.x, l.y, 1, l.z );
+
+            benchmarks.push_back( benchmark{ prefix + "/bernoulli", shape_str( l.x, l.y, 1, l.z ),
+                0., 4. * out_size, [maps]() { nto::bernoulli( *maps, 0.5f ); } } );
+        }
+        else if ( ( l.type == "full" ) || ( l.type == "out" ) )
+        {
+            const size_t rows = l.x * l.y;
+            const size_t fan_in = p.x * p.y * p.z;
+            const double weights_size = static_cast<double>( rows * fan_in );
+
+            auto prev_maps = random_tensor( p.x, p.y, 1, p.z );
+            auto grouped = random_tensor( fan_in, 1, 1, 1 );
+            auto weights = random_tensor( rows, fan_in, 1, 1 );
+            auto bias = random_tensor( l.x, l.y, 1, 1 );
+            auto errors = random_tensor( l.x, l.y, 1, 1 );
+            auto maps = random_tensor( l.x, l.y, 1, 1 );
+
+            benchmarks.push_back( benchmark{ prefix + "/group", shape_str( p.x, p.y, 1, p.z ),
+                0., 8. * in_size, [prev_maps]() { const tensor output = nto::group( *prev_maps ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/ungroup", shape_str( fan_in, 1, 1, 1 ),
+                0., 8. * in_size, [grouped,prev_maps]() { nto::ungroup( *grouped, *prev_maps ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/muladd", shape_str( rows, fan_in, 1, 1 ),
+                2. * weights_size + rows, 4. * ( weights_size + fan_in + 2. * rows ),
+                [weights,grouped,bias]() { const tensor output = nto::muladd( *weights, *grouped, *bias ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/multrans1", shape_str( rows, fan_in, 1, 1 ),
+                2. * weights_size, 4. * ( weights_size + fan_in + rows ),
+                [weights,errors]() { const tensor output = nto::multrans1( *weights, *errors ); } } );
+            benchmarks.push_back( benchmark{ prefix + "/multrans2", shape_str( rows, fan_in, 1, 1 ),
+                weights_size, 4. * ( weights_size + fan_in + rows ),
+                [errors,grouped]() { const tensor output = nto::multrans2( *errors, *grouped ); } } );
+
+            if ( l.type == "full" )
+            {
+                benchmarks.push_back( benchmark{ prefix + "/relu", shape_str( l.x, l.y, 1, 1 ),
+                    out_size, 8. * out_size, [maps]() { nta::relu::f( *maps ); } } );
+                benchmarks.push_back( benchmark{ prefix + "/d_relu", shape_str( l.x, l.y, 1, 1 ),
+                    out_size, 8. * out_size, [maps]() { const tensor output = nta::relu::d_f( *maps ); } } );
+            }
+            else
+            {
+                benchmarks.push_back( benchmark{ prefix + "/softmax", shape_str( l.x, l.y, 1, 1 ),
+                    3. * out_size, 8. * out_size, [maps]() { nta::softmax_cross_entropy::f( *maps ); } } );
+            }
+
+            add_solver_benchmarks( benchmarks, prefix, rows, fan_in, 1, 1 );
+        }
+    }
+
+    return benchmarks;
+}
+
+// runs increasing iterations counts until the minimal time is reached (google benchmark like)
+benchmark_result run_benchmark( const benchmark& b, const double min_time )
+{
+    using clock = std::chrono::steady_clock;
+
+    b.run(); // warmup
+
+    size_t iterations = 1;
+    while ( true )
+    {
+        const std::uint64_t allocations = allocations_count();
+        const clock::time_point start = clock::now();
+
+        for ( size_t i=0; i<iterations; i++ )
+            b.run();
+
+        const double elapsed = std::chrono::duration<double>( clock::now() - start ).count();
+
+        if ( ( elapsed >= min_time ) || ( iterations >= 1000000000 ) )
+        {
+            return benchmark_result{ iterations, 1e9 * elapsed / iterations,
+                static_cast<double>( allocations_count() - allocations ) / iterations };
+        }
+
+        // aim slightly above the minimal time, growing at most 10x per round
+        const double factor = ( elapsed > 0. ) ? std::min( 10., 1.4 * min_time / elapsed ) : 10.;
+        iterations = std::max( iterations + 1, static_cast<size_t>( iterations * factor ) );
+    }
+}
+
+std::string json_escaped( const std::string& str )
+{
+    std::string escaped;
+    for ( const char c : str )
+    {
+        if ( ( c == '"' ) || ( c == '\\' ) )
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+int main( int argc, char *argv[] )
+{
+    std::vector<std::string> topologies;
+    std::string filter;
+    std::string json;
+    double min_time;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("topology,t", po::value<std::vector<std::string>>( &topologies )->multitoken(), "convnet topology files (default : all topologies of the nets directory)")
+        ("filter,f", po::value<std::string>( &filter ), "only run benchmarks whose name contains this string")
+        ("min_time,m", po::value<double>( &min_time )->default_value( 0.2 ), "minimal measuring time per benchmark (seconds)")
+        ("json,j", po::value<std::string>( &json ), "JSON results output file")
+    ;
+
+    try
+    {
+        po::variables_map vm;
+        po::store( po::parse_command_line( argc, argv, desc ), vm );
+
+        if ( vm.count( "help" ) )
+        {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+
+        po::notify( vm );
+
+        if ( topologies.empty() )
+        {
+            for ( bfs::recursive_directory_iterator it( NEUROCL_NETS_DIR ), end; it != end; ++it )
+            {
+                const std::string filename = it->path().filename().string();
+                if ( boost::starts_with( filename, "topology-" ) && ( it->path().extension() == ".txt" ) )
+                    topologies.push_back( it->path().string() );
+            }
+            std::sort( topologies.begin(), topologies.end() );
+        }
+
+        std::vector<benchmark> benchmarks;
+        for ( const auto& topology : topologies )
+        {
+            const std::string name = boost::replace_first_copy( bfs::path( topology ).stem().string(), "topology-", "" );
+            for ( auto& b : build_benchmarks( name, load_topology( topology ) ) )
+                if ( filter.empty() || ( b.name.find( filter ) != std::string::npos ) )
+                    benchmarks.push_back( std::move( b ) );
+        }
+
+        std::ofstream json_out;
+        if ( !json.empty() )
+        {
+            json_out.open( json, std::ios::out | std::ios::trunc );
+            if ( !json_out || !json_out.is_open() )
+                throw std::runtime_error( "unable to open JSON output file " + json );
+
+            json_out << std::fixed;
+
+            json_out << "{\n  \"context\": { \"min_time\": " << min_time << ", \"benchmarks\": " << benchmarks.size() << " },\n  \"benchmarks\": [";
+        }
+
+        std::cout << std::left << std::setw( 48 ) << "benchmark" << std::setw( 24 ) << "shape" << std::right
+            << std::setw( 14 ) << "time (ns)" << std::setw( 12 ) << "iterations" << std::setw( 10 ) << "GFLOP/s"
+            << std::setw( 10 ) << "GB/s" << std::setw( 12 ) << "allocs/call" << std::endl;
+
+        std::cout << std::fixed;
+
+        for ( size_t i=0; i<benchmarks.size(); i++ )
+        {
+            const benchmark& b = benchmarks[i];
+            const benchmark_result r = run_benchmark( b, min_time );
+
+            const double gflops = b.flops / r.ns_per_call;
+            const double bytes_per_second = 1e9 * b.bytes / r.ns_per_call;
+
+            std::cout << std::left << std::setw( 48 ) << b.name << std::setw( 24 ) << b.shape << std::right
+                << std::setprecision( 1 ) << std::setw( 14 ) << r.ns_per_call << std::setw( 12 ) << r.iterations
+                << std::setprecision( 3 ) << std::setw( 10 ) << gflops << std::setw( 10 ) << bytes_per_second / 1e9
+                << std::setprecision( 1 ) << std::setw( 12 ) << r.allocs_per_call << std::endl;
+
+            if ( json_out.is_open() )
+            {
+                json_out << ( i ? "," : "" ) << "\n    { \"name\": \"" << json_escaped( b.name ) << "\", \"shape\": \"" << b.shape
+                    << "\", \"iterations\": " << r.iterations << std::setprecision( 3 )
+                    << ", \"real_time\": " << r.ns_per_call << ", \"time_unit\": \"ns\""
+                    << ", \"flops_per_call\": " << b.flops << ", \"gflops_per_second\": " << gflops
+                    << ", \"bytes_per_second\": " << bytes_per_second << ", \"allocs_per_call\": " << r.allocs_per_call << " }";
+            }
+        }
+
+        if ( json_out.is_open() )
+            json_out << "\n  ]\n}" << std::endl;
+    }
+    catch( po::error& e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return -1;
+    }
+    catch( std::exception& e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
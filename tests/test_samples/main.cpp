@@ -0,0 +1,305 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "common/samples_streamer.h"
+#include "common/batch_prefetcher.h"
+#include "common/augmentation_pipeline.h"
+#include "common/network_exception.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+static const size_t s_shard_samples = 10;
+static const size_t s_input_size = 4;
+
+// samples are identified by their output value
+void write_shard( const std::string& filename, const size_t first_id )
+{
+    std::vector<float> values( s_shard_samples * ( s_input_size + 1 ) );
+    std::vector<neurocl::sample> samples;
+
+    for ( size_t i=0; i<s_shard_samples; i++ )
+    {
+        float* data = &values[i * ( s_input_size + 1 )];
+        for ( size_t j=0; j<=s_input_size; j++ )
+            data[j] = static_cast<float>( first_id + i );
+
+        samples.emplace_back( s_input_size, data, 1, data + s_input_size );
+    }
+
+    neurocl::samples_file::write( filename, samples, s_input_size, 1 );
+}
+
+std::vector<float> stream_epoch( const neurocl::samples_manager& smp_manager, const size_t batch_size )
+{
+    std::vector<float> ids;
+
+    while ( true )
+    {
+        const neurocl::samples_view samples = smp_manager.get_next_batch_view( batch_size );
+
+        if ( samples.empty() )
+            break;
+
+        for ( const auto& s : samples )
+            ids.push_back( s.osample[0] );
+    }
+
+    return ids;
+}
+
+// contiguous batches as packed by the synchronous training path
+std::vector<neurocl::prefetched_batch> synchronous_epoch(   const neurocl::samples_manager& smp_manager,
+                                                            const size_t batch_size,
+                                                            const neurocl::augmentation_pipeline& augmentation,
+                                                            std::uint64_t stream )
+{
+    std::vector<neurocl::prefetched_batch> batches;
+
+    while ( true )
+    {
+        const neurocl::samples_view samples = smp_manager.get_next_batch_view( batch_size );
+
+        if ( samples.empty() )
+            break;
+
+        neurocl::prefetched_batch batch;
+        batch.size = samples.size();
+        batch.isample_size = samples.front().isample_size;
+        batch.osample_size = samples.front().osample_size;
+
+        for ( const auto& s : samples )
+        {
+            batch.inputs.insert( batch.inputs.end(), s.isample, s.isample + s.isample_size );
+            batch.outputs.insert( batch.outputs.end(), s.osample, s.osample + s.osample_size );
+        }
+
+        augmentation.apply_batch( batch.inputs.data(), batch.size, batch.isample_size, stream );
+
+        stream += samples.size();
+        batches.push_back( std::move( batch ) );
+    }
+
+    return batches;
+}
+
+bool same_batches( const std::vector<neurocl::prefetched_batch>& batches1, const std::vector<neurocl::prefetched_batch>& batches2 )
+{
+    if ( batches1.size() != batches2.size() )
+        return false;
+
+    for ( size_t i=0; i<batches1.size(); i++ )
+    {
+        const neurocl::prefetched_batch& b1 = batches1[i];
+        const neurocl::prefetched_batch& b2 = batches2[i];
+
+        if ( ( b1.size != b2.size ) || ( b1.isample_size != b2.isample_size ) || ( b1.osample_size != b2.osample_size )
+            || ( b1.inputs != b2.inputs ) || ( b1.outputs != b2.outputs ) )
+            return false;
+    }
+
+    return true;
+}
+
+int main( int argc, char *argv[] )
+{
+    const std::vector<std::string> shards = { "test_samples_0.bin", "test_samples_1.bin", "test_samples_2.bin" };
+
+    for ( size_t i=0; i<shards.size(); i++ )
+        write_shard( shards[i], i * s_shard_samples );
+
+    // STREAMER EPOCH
+
+    {
+        neurocl::samples_streamer streamer( shards, 8, 4 );
+
+        const std::vector<float> ids = stream_epoch( streamer, 4 );
+        const std::set<float> unique_ids( ids.begin(), ids.end() );
+
+        const bool passed = ( ids.size() == shards.size() * s_shard_samples ) && ( unique_ids.size() == ids.size() );
+
+        std::cout << "samples_streamer epoch test : " << ( passed ? "PASSED" : "FAILED" ) << std::endl;
+    }
+
+    // STREAMER ORDER RESTORE
+
+    {
+        neurocl::samples_streamer streamer( shards, 8, 4 );
+        stream_epoch( streamer, 4 );
+        streamer.rewind();
+        streamer.shuffle();
+
+        std::vector<std::uint32_t> order;
+        streamer.get_samples_order( order );
+
+        const std::vector<float> ids = stream_epoch( streamer, 4 );
+
+        neurocl::samples_streamer restored_streamer( shards, 8, 4 );
+        restored_streamer.set_samples_order( order );
+
+        const std::vector<float> restored_ids = stream_epoch( restored_streamer, 4 );
+
+        std::cout << "samples_streamer order restore test : " << ( ( ids == restored_ids ) ? "PASSED" : "FAILED" ) << std::endl;
+
+        bool rejected = false;
+        try
+        {
+            restored_streamer.set_samples_order( std::vector<std::uint32_t>( order.size(), 0 ) );
+        }
+        catch( neurocl::network_exception& )
+        {
+            rejected = true;
+        }
+
+        std::cout << "samples_streamer invalid order test : " << ( rejected ? "PASSED" : "FAILED" ) << std::endl;
+    }
+
+    // PREFETCHED BATCHES
+
+    {
+        // 2D samples for augmentation
+        const size_t size_x = 4;
+        const size_t size_y = 4;
+        const size_t samples_count = 50;
+
+        std::vector<float> values( samples_count * ( size_x * size_y + 1 ) );
+        std::vector<neurocl::sample> samples;
+        for ( size_t i=0; i<samples_count; i++ )
+        {
+            float* data = &values[i * ( size_x * size_y + 1 )];
+            for ( size_t j=0; j<=size_x * size_y; j++ )
+                data[j] = static_cast<float>( i ) + 0.01f * j;
+
+            samples.emplace_back( size_x * size_y, data, 1, data + size_x * size_y );
+        }
+
+        neurocl::samples_file::write( "test_samples_2d.bin", samples, size_x, size_y );
+
+        neurocl::samples_manager smp_manager;
+        smp_manager.load_binary_samples( "test_samples_2d.bin" );
+
+        std::shared_ptr<neurocl::augmentation_pipeline> augmentation =
+            std::make_shared<neurocl::augmentation_pipeline>( size_x, size_y, 1234 );
+        augmentation->rotate( 15.f ).noise( 0.05f );
+
+        const size_t batch_size = 8;
+        const std::uint64_t first_stream = 100;
+
+        const std::vector<neurocl::prefetched_batch> sync_batches = synchronous_epoch( smp_manager, batch_size, *augmentation, first_stream );
+        smp_manager.rewind();
+
+        bool passed = true;
+
+        // double and triple buffering, with concurrent producers
+        for ( const size_t buffers : { 2, 3 } )
+        {
+            std::vector<neurocl::prefetched_batch> prefetched_batches;
+
+            // scoped prefetcher
+            {
+                neurocl::batch_prefetcher prefetcher( smp_manager, batch_size, buffers, 3, augmentation, first_stream );
+
+                while ( const neurocl::prefetched_batch* batch = prefetcher.next_batch() )
+                    prefetched_batches.push_back( *batch );
+            }
+
+            smp_manager.rewind();
+
+            passed = passed && same_batches( prefetched_batches, sync_batches );
+        }
+
+        std::cout << "batch_prefetcher synchronous match test : " << ( passed ? "PASSED" : "FAILED" ) << std::endl;
+
+        // inputs packed with a size differing from the augmented 2D size
+        bool rejected = false;
+        try
+        {
+            std::vector<float> inputs( 2 * ( size_x * size_y + 1 ) );
+            augmentation->apply_batch( inputs.data(), 2, size_x * size_y + 1, first_stream );
+        }
+        catch( neurocl::network_exception& )
+        {
+            rejected = true;
+        }
+
+        std::cout << "augmentation_pipeline sample size test : " << ( rejected ? "PASSED" : "FAILED" ) << std::endl;
+
+        std::remove( "test_samples_2d.bin" );
+    }
+
+    // NON UNIFORM OUTPUTS
+
+    {
+        // rejected while parsing, before images are decoded
+        std::ofstream samples_list( "test_samples_list.txt" );
+        samples_list << "sample_0.png 1 0" << std::endl;
+        samples_list << "sample_1.png 1" << std::endl;
+        samples_list.close();
+
+        bool rejected = false;
+        try
+        {
+            neurocl::samples_manager smp_manager;
+            smp_manager.load_samples( "test_samples_list.txt" );
+        }
+        catch( neurocl::network_exception& )
+        {
+            rejected = true;
+        }
+
+        std::cout << "samples_manager non uniform outputs test : " << ( rejected ? "PASSED" : "FAILED" ) << std::endl;
+
+        std::remove( "test_samples_list.txt" );
+    }
+
+    // STREAMER READER ERROR
+
+    {
+        neurocl::samples_streamer streamer( shards, 8, 4 );
+
+        // shard disappears once headers are read
+        std::remove( shards[1].c_str() );
+
+        bool reported = false;
+        try
+        {
+            stream_epoch( streamer, 4 );
+        }
+        catch( neurocl::network_exception& )
+        {
+            reported = true;
+        }
+
+        std::cout << "samples_streamer reader error test : " << ( reported ? "PASSED" : "FAILED" ) << std::endl;
+    }
+
+    for ( const auto& shard : shards )
+        std::remove( shard.c_str() );
+
+    return 0;
+}
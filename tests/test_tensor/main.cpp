@@ -24,8 +24,15 @@ THE SOFTWARE.
 
 #include "convnet/tensor_operations.h"
 #include "convnet/tensor_activations.h"
+#include "convnet/tensor_sparse.h"
+#include "common/half_float.h"
+#include "common/network_random.h"
 
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
 
 int main( int argc, char *argv[] )
 {
@@ -271,6 +278,50 @@ int main( int argc, char *argv[] )
     std::cout << "bernoulli test2 : " << ( ( ( Res.norm1() - 2500.f ) < 100.f ) ? "PASSED" : "FAILED" ) << std::endl;
     std::cout << "bernoulli test3 : " << ( ( ( Comp.norm1() - 2500.f ) < 100.f ) ? "PASSED" : "FAILED" ) << std::endl;
 
+    // PHILOX
+
+    using neurocl::random::philox_generator;
+
+    // Random123 philox4x32-10 known answers : counter, key, output
+    const std::uint32_t philox_kat[3][10] = {
+        { 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+        { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+        { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0, 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } };
+
+    const size_t philox_lanes = philox_generator::s_lanes;
+
+    bool philox_known_answers = true;
+    bool philox_lanes_blocks = true;
+    for ( const auto& kat : philox_kat )
+    {
+        const std::uint64_t counter = kat[0] | ( static_cast<std::uint64_t>( kat[1] ) << 32 );
+        const std::uint64_t stream = kat[2] | ( static_cast<std::uint64_t>( kat[3] ) << 32 );
+
+        // first block is in lane 0
+        philox_generator rng( kat[4], stream, kat[5] );
+        rng.set_counter( counter );
+        std::vector<std::uint32_t> bits( 4 * philox_lanes );
+        rng.bits( bits.data(), bits.size() );
+
+        for ( size_t w=0; w<4; w++ )
+            philox_known_answers &= ( bits[w*philox_lanes] == kat[6+w] );
+
+        // other lanes are the next counters blocks
+        for ( size_t l=1; l<philox_lanes; l++ )
+        {
+            philox_generator lane_rng( kat[4], stream, kat[5] );
+            lane_rng.set_counter( counter + l );
+            std::vector<std::uint32_t> lane_bits( 4 * philox_lanes );
+            lane_rng.bits( lane_bits.data(), lane_bits.size() );
+
+            for ( size_t w=0; w<4; w++ )
+                philox_lanes_blocks &= ( bits[w*philox_lanes+l] == lane_bits[w*philox_lanes] );
+        }
+    }
+
+    std::cout << "philox known answers test : " << ( philox_known_answers ? "PASSED" : "FAILED" ) << std::endl;
+    std::cout << "philox lanes test : " << ( philox_lanes_blocks ? "PASSED" : "FAILED" ) << std::endl;
+
     // GROUP
 
     A.resize(5,5,1,2);
@@ -299,6 +350,28 @@ int main( int argc, char *argv[] )
 
     std::cout << "ungroup test : " << ( ( Res == Comp ) ? "PASSED" : "FAILED" ) << std::endl;
 
+    // FAKE QUANTIZE
+
+    A.resize(4,1,1,1);
+    std::vector<float> vA({ 0.26f, -1.1f, 100.f, 0.74f });
+    A.fill(0,0,4,&vA[0]);
+
+    // rounded to 0.5 steps, clamped to 127 steps
+    Comp.resize(4,1,1,1);
+    std::vector<float> vQComp({ 0.5f, -1.f, 63.5f, 0.5f });
+    Comp.fill(0,0,4,&vQComp[0]);
+
+    Res.resize(4,1,1,1);
+
+    nto::fake_quantize( A, 0.5f, Res );
+
+    std::cout << "fake_quantize test1 : " << ( ( Res == Comp ) ? "PASSED" : "FAILED" ) << std::endl;
+
+    // single scale of the max absolute value : max value is exact
+    nto::fake_quantize( A, nto::quantize_mode::layer, Res );
+
+    std::cout << "fake_quantize test2 : " << ( ( std::fabs( Res.norm_inf() - 100.f ) < 1e-4f ) ? "PASSED" : "FAILED" ) << std::endl;
+
     // CONVOLVE ADD FORWARD FLIP/VALID
 
     A.resize(6,6,1,2);
@@ -410,6 +483,149 @@ int main( int argc, char *argv[] )
 
     std::cout << "convolve_update flip/valid test : " << ( ( Res == Comp ) ? "PASSED" : "FAILED" ) << std::endl;
 
+    // PRUNE
+
+    // odd sizes exercise the vectorized kernels remainders
+    std::mt19937 rng( 0 );
+    std::uniform_real_distribution<float> dist( -1.f, 1.f );
+
+    auto _random_fill = [&]( neurocl::convnet::tensor& t )
+    {
+        std::vector<float> values( t.w() * t.h() );
+        for ( size_t d2=0; d2<t.d2(); d2++ )
+        {
+            for ( auto& v : values ) v = dist( rng );
+            t.fill( 0, d2, values.size(), &values[0] );
+        }
+    };
+
+    A.resize(13,19,1,2);
+    _random_fill( A );
+
+    nto::prune( A, 0.8f, Res );
+
+    // requested ratio is exactly reached, and weights are null where the mask is
+    const float pruned_count = static_cast<float>( A.size() ) - Res.norm1();
+    const bool pruned_null = ( nto::elemul( A, 1.f - Res ).norm1() == 0.f );
+    std::cout << "prune test1 : " << ( ( pruned_count == std::round( 0.8f * 13 * 19 * 2 ) ) && pruned_null ? "PASSED" : "FAILED" ) << std::endl;
+
+    // equal magnitudes ties are pruned in order
+    A.uniform_fill( 0.5f );
+    nto::prune( A, 0.5f, Res );
+
+    std::cout << "prune test2 : " << ( ( A.norm1() == 0.5f * 0.5f * 13 * 19 * 2 ) && ( Res.norm1() == 0.5f * 13 * 19 * 2 ) ? "PASSED" : "FAILED" ) << std::endl;
+
+    // SPARSE MULADD
+
+    bool sparse_muladd = true;
+    for ( const size_t columns : { 1, 3 } )
+    {
+        A.resize(13,19,1,2);
+        _random_fill( A );
+        nto::prune( A, 0.8f, Res );
+
+        B.resize(19,columns,1,2);
+        _random_fill( B );
+        C.resize(13,columns,1,2);
+        _random_fill( C );
+
+        neurocl::convnet::tensor_sparse sparse_A;
+        sparse_A.build( A, 0.7f );
+
+        Comp = nto::muladd( A, B, C );
+        Res = sparse_A.muladd( B, C );
+
+        sparse_muladd = sparse_muladd && !sparse_A.empty() && ( std::fabs( sparse_A.sparsity() - 0.8f ) < 0.01f ) &&
+            ( ( Res - Comp ).norm_inf() < 1e-5f );
+    }
+
+    std::cout << "sparse muladd test : " << ( sparse_muladd ? "PASSED" : "FAILED" ) << std::endl;
+
+    // dense products are kept below the sparsity threshold
+    neurocl::convnet::tensor_sparse sparse_B;
+    sparse_B.build( B, 0.7f );
+
+    std::cout << "sparse threshold test : " << ( sparse_B.empty() ? "PASSED" : "FAILED" ) << std::endl;
+
+    // HALF FLOAT CONVERSIONS
+
+    using neurocl::half_format;
+
+    bool half_round_trip = true;
+    for ( std::uint32_t h=0; h<=0xFFFF; h++ )
+    {
+        const std::uint16_t half = static_cast<std::uint16_t>( h );
+        const bool nan = ( ( half & 0x7C00 ) == 0x7C00 ) && ( half & 0x03FF );
+        if ( !nan && ( neurocl::float_to_half( neurocl::half_to_float( half ) ) != half ) )
+            half_round_trip = false;
+    }
+
+    std::cout << "half round trip test : " << ( half_round_trip ? "PASSED" : "FAILED" ) << std::endl;
+
+    const bool half_range = ( neurocl::float_to_half( 65504.f ) == 0x7BFF ) &&
+        ( neurocl::half_to_float( 0x7BFF ) == 65504.f ) &&
+        ( neurocl::float_to_half( 65519.f ) == 0x7BFF ) &&
+        ( neurocl::float_to_half( 65520.f ) == 0x7C00 ) &&
+        ( neurocl::float_to_half( -65520.f ) == 0xFC00 ) &&
+        std::isinf( neurocl::half_to_float( 0x7C00 ) );
+
+    std::cout << "half range test : " << ( half_range ? "PASSED" : "FAILED" ) << std::endl;
+
+    const float min_subnormal = std::ldexp( 1.f, -24 );
+    const bool half_subnormals = ( neurocl::float_to_half( min_subnormal ) == 0x0001 ) &&
+        ( neurocl::half_to_float( 0x0001 ) == min_subnormal ) &&
+        ( neurocl::float_to_half( 0.5f * min_subnormal ) == 0x0000 ) &&  // tie rounds to even
+        ( neurocl::float_to_half( 1.5f * min_subnormal ) == 0x0002 ) &&  // tie rounds to even
+        ( neurocl::float_to_half( -min_subnormal ) == 0x8001 ) &&
+        ( neurocl::half_to_float( 0x03FF ) == 1023.f * min_subnormal ) &&
+        ( neurocl::float_to_half( 1024.f * min_subnormal ) == 0x0400 );
+
+    std::cout << "half subnormals test : " << ( half_subnormals ? "PASSED" : "FAILED" ) << std::endl;
+
+    const std::uint16_t half_nan = neurocl::float_to_half( std::numeric_limits<float>::quiet_NaN() );
+    const bool half_nans = ( ( half_nan & 0x7C00 ) == 0x7C00 ) && ( half_nan & 0x03FF ) &&
+        std::isnan( neurocl::half_to_float( 0x7E00 ) ) && std::isnan( neurocl::half_to_float( 0xFC01 ) );
+
+    std::cout << "half nan test : " << ( half_nans ? "PASSED" : "FAILED" ) << std::endl;
+
+    const std::uint16_t bf16_nan = neurocl::float_to_bfloat16( std::numeric_limits<float>::quiet_NaN() );
+    const bool bf16 = ( neurocl::float_to_bfloat16( 1.f ) == 0x3F80 ) &&
+        ( neurocl::bfloat16_to_float( 0x3F80 ) == 1.f ) &&
+        ( neurocl::float_to_bfloat16( neurocl::_bits_float( 0x3F808000 ) ) == 0x3F80 ) &&    // tie rounds to even
+        ( neurocl::float_to_bfloat16( neurocl::_bits_float( 0x3F818000 ) ) == 0x3F82 ) &&    // tie rounds to even
+        ( neurocl::float_to_bfloat16( neurocl::_bits_float( 0x3F808001 ) ) == 0x3F81 ) &&
+        ( neurocl::float_to_bfloat16( std::numeric_limits<float>::infinity() ) == 0x7F80 ) &&
+        std::isnan( neurocl::bfloat16_to_float( bf16_nan ) );
+
+    std::cout << "bfloat16 test : " << ( bf16 ? "PASSED" : "FAILED" ) << std::endl;
+
+    // array conversions (vectorized when available) match scalar conversions
+    std::vector<float> values( 37 );
+    for ( size_t i=0; i<values.size(); i++ )
+        values[i] = std::ldexp( ( i % 2 ) ? -1.f : 1.f, static_cast<int>( i ) - 26 ) * 1.337f;
+
+    bool half_arrays = true;
+    for ( const auto format : { half_format::FP16, half_format::BF16 } )
+    {
+        std::vector<std::uint16_t> narrowed( values.size() );
+        std::vector<float> widened( values.size() );
+        neurocl::narrow_floats( format, values.data(), values.size(), narrowed.data() );
+        neurocl::widen_floats( format, narrowed.data(), narrowed.size(), widened.data() );
+
+        for ( size_t i=0; i<values.size(); i++ )
+        {
+            const std::uint16_t scalar = ( format == half_format::FP16 ) ?
+                neurocl::float_to_half( values[i] ) : neurocl::float_to_bfloat16( values[i] );
+            const float widened_scalar = ( format == half_format::FP16 ) ?
+                neurocl::half_to_float( scalar ) : neurocl::bfloat16_to_float( scalar );
+
+            if ( ( narrowed[i] != scalar ) || ( widened[i] != widened_scalar ) )
+                half_arrays = false;
+        }
+    }
+
+    std::cout << "half arrays test : " << ( half_arrays ? "PASSED" : "FAILED" ) << std::endl;
+
     /*std::cout << A.dump(0,0) << std::endl << std::endl;
     std::cout << B.dump(0,0) << std::endl << std::endl;
     std::cout << Comp.dump(0,0) << std::endl << std::endl;
@@ -0,0 +1,402 @@
+/*
+The MIT License
+
+Copyright (c) 2015-2017 Albert Murienne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "convnet/network.h"
+#include "common/async_batch_trainer.h"
+#include "common/network_exception.h"
+#include "common/network_factory.h"
+#include "common/network_random.h"
+#include "common/samples_manager.h"
+#include "common/samples_file.h"
+#include "interfaces/network_manager_interface.h"
+
+#include <boost/filesystem.hpp>
+namespace bfs = boost::filesystem;
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// test resources are generated in a dedicated directory, used as configuration lookup path
+static const std::string s_data_path = "test_training_data";
+
+static const std::string s_config = "<neurocl>\n"
+    "    <implementation>CONVNET</implementation>\n"
+    "    <random_seed>42</random_seed>\n"
+    "    <solver type=\"ADAMAX\" lr=\"0.01\" m1=\"0.9\" m2=\"0.999\"/>\n"
+    "    <checkpoint_path>" + s_data_path + "/checkpoint.bin</checkpoint_path>\n"
+    "    <checkpoint_interval>1</checkpoint_interval>\n"
+    "    <gradient_check_epsilon>0.01</gradient_check_epsilon>\n"
+    "    <augmentation rotate=\"10\" noise=\"0.05\"/>\n"
+    "</neurocl>\n";
+
+static const std::string s_topology = "layer:in:0:6x6x1\n"
+    "layer:conv:1:4x4x2:3\n"
+    "layer:full:2:8x1x1\n"
+    "layer:drop:3:8x1x1\n"
+    "layer:out:4:3x1:1\n";
+
+// quantized inference covers conv rows packing, int8 pooling & the requantization between weighted layers
+static const std::string s_topology_int8 = "layer:in:0:6x6x1\n"
+    "layer:conv:1:4x4x3:3\n"
+    "layer:pool:2:2x2x3\n"
+    "layer:full:3:8x1x1\n"
+    "layer:out:4:3x1:1\n";
+
+std::string data_file( const std::string& filename )
+{
+    return s_data_path + "/" + filename;
+}
+
+void write_file( const std::string& filename, const std::string& content )
+{
+    std::ofstream data_out( filename );
+    data_out << content;
+}
+
+std::vector<char> read_file( const std::string& filename )
+{
+    std::ifstream data_in( filename, std::ios::in | std::ios::binary );
+    return std::vector<char>( std::istreambuf_iterator<char>( data_in ), std::istreambuf_iterator<char>() );
+}
+
+void write_samples( const std::string& filename )
+{
+    const size_t samples_count = 40;
+
+    std::mt19937 rng( 0 );
+    std::uniform_real_distribution<float> dist( 0.f, 1.f );
+
+    std::vector<float> values( samples_count * ( 36 + 3 ) );
+    std::vector<neurocl::sample> samples;
+
+    for ( size_t i=0; i<samples_count; i++ )
+    {
+        float* data = &values[i * ( 36 + 3 )];
+        for ( size_t j=0; j<36; j++ )
+            data[j] = dist( rng );
+        data[36 + ( i % 3 )] = 1.f;
+
+        samples.emplace_back( 36, data, 3, data + 36 );
+    }
+
+    neurocl::samples_file::write( filename, samples, 6, 6 );
+}
+
+// trains epoch_size epochs from given weights, resuming from an existing checkpoint,
+// the training being optionally interrupted after interrupted_epoch epochs
+void train( const std::string& weights, const size_t epoch_size, const size_t interrupted_epoch = 0 )
+{
+    // identical random sets (dropout layers keys, samples shuffling) for all trainings
+    neurocl::random::seed::instance().set_offset( 0 );
+
+    std::shared_ptr<neurocl::network_manager_interface> net_manager =
+        neurocl::network_factory::build( neurocl::network_factory::t_neural_impl::NEURAL_IMPL_CONVNET );
+    net_manager->load_network( data_file( "topology.txt" ), weights );
+
+    neurocl::samples_manager smp_manager;
+    smp_manager.load_binary_samples( data_file( "samples.bin" ) );
+
+    // progress reported after the interrupted epoch is the first mini-batch of the next one
+    const int interrupted_progress = static_cast<int>( ( 100 * interrupted_epoch ) / epoch_size );
+    net_manager->batch_train( smp_manager, epoch_size, 8, [&]( const int progress ) {
+        if ( interrupted_epoch && ( progress > interrupted_progress ) )
+            throw std::runtime_error( "training interrupted" );
+    } );
+}
+
+// training states (parameters, solver caches, dropout masks) after each back propagation of a network holding
+// a dropout layer, its training state being optionally restored first, and saved at the end
+std::vector<std::vector<float>> dropout_states( const size_t steps, std::vector<float>& state, const bool restore )
+{
+    using namespace neurocl::convnet;
+
+    // identical parameters & dropout layer key, as in a resumed training session
+    neurocl::random::seed::instance().set_offset( 0 );
+
+    network net;
+    net.add_layers( { layer_descr( INPUT_LAYER, 6, 6, 1, 0, true ),
+        layer_descr( CONV_LAYER, 4, 4, 2, 3, true ),
+        layer_descr( FULL_LAYER, 8, 1, 1, 0, true ),
+        layer_descr( DROPOUT_LAYER, 8, 1, 1, 0, false ),
+        layer_descr( OUTPUT_LAYER, 3, 1, 1, 0, true ) } );
+    net.set_training( true );
+
+    if ( restore )
+        net.set_training_state( state.data() );
+
+    const std::vector<float> input( 36, 0.5f );
+    const std::vector<float> output{ 0.f, 1.f, 0.f };
+    net.set_input( input.size(), input.data() );
+    net.set_output( output.size(), output.data() );
+
+    // no gradient descent : only dropout masks change from one state to the next
+    std::vector<std::vector<float>> states;
+    for ( size_t i=0; i<steps; i++ )
+    {
+        net.clear_gradients();
+        net.feed_forward();
+        net.back_propagate();
+
+        states.emplace_back( net.training_state_size() );
+        net.get_training_state( states.back().data() );
+    }
+
+    state = states.back();
+
+    return states;
+}
+
+// maximum relative errors per weighted layer of a gradient check probed by given threads count
+std::vector<double> gradient_check_errors( const size_t threads )
+{
+    using namespace neurocl::convnet;
+
+    // identical parameters for all checks
+    neurocl::random::seed::instance().set_offset( 0 );
+
+    network net;
+    net.add_layers( { layer_descr( INPUT_LAYER, 6, 6, 1, 0, true ),
+        layer_descr( CONV_LAYER, 4, 4, 2, 3, true ),
+        layer_descr( FULL_LAYER, 8, 1, 1, 0, true ),
+        layer_descr( DROPOUT_LAYER, 8, 1, 1, 0, false ),
+        layer_descr( OUTPUT_LAYER, 3, 1, 1, 0, true ) } );
+
+    std::mt19937 rng( 7 );
+    std::uniform_real_distribution<float> dist( 0.f, 1.f );
+
+    std::vector<float> input( 36 );
+    for ( auto& _value : input )
+        _value = dist( rng );
+
+    neurocl::output_ptr out_ref( 3 );
+    std::fill( out_ref.outputs.get(), out_ref.outputs.get() + 3, 0.f );
+    out_ref.outputs[1] = 1.f;
+
+    net.set_input( input.size(), input.data() );
+    net.set_output( out_ref.num_outputs, out_ref.outputs.get() );
+    net.gradient_check( out_ref, threads );
+
+    return net.gradient_check_errors();
+}
+
+int main( int argc, char *argv[] )
+{
+    bfs::create_directories( s_data_path );
+    setenv( "NEUROCL_RESOURCE_PATH", s_data_path.c_str(), 1 );
+
+    write_file( data_file( "neurocl.xml" ), s_config );
+    write_file( data_file( "topology.txt" ), s_topology );
+    write_file( data_file( "topology_int8.txt" ), s_topology_int8 );
+    write_samples( data_file( "samples.bin" ) );
+
+    // TRAINING RESUME
+
+    {
+        const size_t epoch_size = 5;
+        const size_t interrupted_epoch = 2;
+
+        // initial weights
+        neurocl::random::seed::instance().set_offset( 0 );
+        {
+            std::shared_ptr<neurocl::network_manager_interface> net_manager =
+                neurocl::network_factory::build( neurocl::network_factory::t_neural_impl::NEURAL_IMPL_CONVNET );
+            net_manager->load_network( data_file( "topology.txt" ), data_file( "weights.bin" ) );
+            net_manager->save_network();
+        }
+        bfs::copy_file( data_file( "weights.bin" ), data_file( "weights_resumed.bin" ), bfs::copy_option::overwrite_if_exists );
+        const std::vector<char> initial_weights = read_file( data_file( "weights.bin" ) );
+
+        // uninterrupted training, its checkpoint is removed once completed
+        train( data_file( "weights.bin" ), epoch_size );
+        const bool completed_removed = !bfs::exists( data_file( "checkpoint.bin" ) );
+
+        // training interrupted after a checkpoint, then resumed
+        bool interrupted = false;
+        try
+        {
+            train( data_file( "weights_resumed.bin" ), epoch_size, interrupted_epoch );
+        }
+        catch( std::runtime_error& )
+        {
+            interrupted = bfs::exists( data_file( "checkpoint.bin" ) );
+        }
+
+        // checkpoints beyond the requested epochs are rejected
+        bool beyond_rejected = false;
+        try
+        {
+            train( data_file( "weights_resumed.bin" ), interrupted_epoch - 1 );
+        }
+        catch( neurocl::network_exception& )
+        {
+            beyond_rejected = true;
+        }
+
+        train( data_file( "weights_resumed.bin" ), epoch_size );
+
+        const std::vector<char> weights = read_file( data_file( "weights.bin" ) );
+        const bool passed = completed_removed && interrupted && ( weights != initial_weights ) &&
+            ( weights == read_file( data_file( "weights_resumed.bin" ) ) ) && !bfs::exists( data_file( "checkpoint.bin" ) );
+
+        std::cout << "training resume test : " << ( passed ? "PASSED" : "FAILED" ) << std::endl;
+        std::cout << "training checkpoint beyond epochs test : " << ( beyond_rejected ? "PASSED" : "FAILED" ) << std::endl;
+    }
+
+    // DROPOUT MASKS RESUME
+
+    {
+        const size_t steps = 6;
+        const size_t interrupted_step = 2;
+
+        std::vector<float> state;
+        const std::vector<std::vector<float>> states = dropout_states( steps, state, false );
+
+        // training state saved after a few steps, then restored in a new network
+        std::vector<std::vector<float>> resumed_states = dropout_states( interrupted_step, state, false );
+        const std::vector<std::vector<float>> next_states = dropout_states( steps - interrupted_step, state, true );
+        resumed_states.insert( resumed_states.end(), next_states.begin(), next_states.end() );
+
+        const bool passed = ( states[0] != states[interrupted_step] ) && ( states == resumed_states );
+
+        std::cout << "dropout masks resume test : " << ( passed ? "PASSED" : "FAILED" ) << std::endl;
+    }
+
+    // GRADIENT CHECK
+
+    {
+        for ( const size_t threads : { size_t( 1 ), size_t( 3 ) } )
+        {
+            const std::vector<double> errors = gradient_check_errors( threads );
+
+            // conv, full & output layers
+            const bool passed = ( errors.size() == 3 ) &&
+                std::all_of( errors.begin(), errors.end(), []( const double error ) { return error < 1e-2; } );
+
+            std::cout << "gradient check test (" << threads << " threads) : " << ( passed ? "PASSED" : "FAILED" ) << std::endl;
+        }
+    }
+
+    // INT8 INFERENCE
+
+    {
+        neurocl::samples_manager smp_manager;
+        smp_manager.load_binary_samples( data_file( "samples.bin" ) );
+
+        // float reference, trained so that outputs are not all close to each other
+        neurocl::random::seed::instance().set_offset( 0 );
+        std::shared_ptr<neurocl::network_manager_interface> float_manager =
+            neurocl::network_factory::build( neurocl::network_factory::t_neural_impl::NEURAL_IMPL_CONVNET );
+        float_manager->load_network( data_file( "topology_int8.txt" ), data_file( "weights_int8.bin" ) );
+        float_manager->batch_train( smp_manager, 10, 8 );
+        float_manager->save_network();
+
+        std::shared_ptr<neurocl::network_manager_interface> int8_manager =
+            neurocl::network_factory::build( neurocl::network_factory::t_neural_impl::NEURAL_IMPL_CONVNET,
+                                             neurocl::network_factory::t_neural_backend::NEURAL_BACKEND_INT8 );
+        int8_manager->load_network( data_file( "topology_int8.txt" ), data_file( "weights_int8.bin" ) );
+        int8_manager->calibrate( smp_manager );
+
+        const std::vector<neurocl::sample>& samples = smp_manager.get_samples();
+        const size_t count = samples.size();
+
+        std::vector<float> inputs;
+        for ( const auto& _sample : samples )
+            inputs.insert( inputs.end(), _sample.isample, _sample.isample + 36 );
+
+        std::vector<float> float_outputs( count * 3 );
+        std::vector<float> int8_outputs( count * 3 );
+        float_manager->compute_output( count, 36, inputs.data(), 3, float_outputs.data() );
+        int8_manager->compute_output( count, 36, inputs.data(), 3, int8_outputs.data() );
+
+        float max_diff = 0.f;
+        bool argmax_match = true;
+        for ( size_t i=0; i<count; i++ )
+        {
+            const float* f_out = &float_outputs[i * 3];
+            const float* q_out = &int8_outputs[i * 3];
+
+            for ( size_t j=0; j<3; j++ )
+                max_diff = std::max( max_diff, std::fabs( f_out[j] - q_out[j] ) );
+
+            // classes are only expected to match when the float outputs are not tied within quantization error
+            std::vector<float> sorted( f_out, f_out + 3 );
+            std::sort( sorted.begin(), sorted.end() );
+            if ( ( sorted[2] - sorted[1] ) > 1e-1f )
+                argmax_match &= ( std::max_element( f_out, f_out + 3 ) - f_out ) == ( std::max_element( q_out, q_out + 3 ) - q_out );
+        }
+
+        const bool passed = ( max_diff < 5e-2f ) && argmax_match;
+
+        std::cout << "int8 inference test (max diff " << max_diff << ") : " << ( passed ? "PASSED" : "FAILED" ) << std::endl;
+    }
+
+    // ASYNC BATCH TRAINER
+
+    {
+        std::shared_ptr<neurocl::network_manager_interface> net_manager =
+            neurocl::network_factory::build( neurocl::network_factory::t_neural_impl::NEURAL_IMPL_CONVNET );
+        net_manager->load_network( data_file( "topology.txt" ), data_file( "weights_async.bin" ) );
+
+        const size_t producers_count = 4;
+        const size_t pushes = 50;
+
+        // concurrent producers of distinct batch sizes : a shared slot would miscount trained samples
+        neurocl::async_batch_trainer trainer( net_manager, 2 );
+        std::vector<std::thread> producers;
+        size_t samples = 0;
+        for ( size_t p=0; p<producers_count; p++ )
+        {
+            const size_t batch_size = p + 1;
+            samples += pushes * batch_size;
+
+            producers.emplace_back( [&trainer,batch_size,pushes]() {
+                const std::vector<float> inputs( 36 * batch_size, 0.5f );
+                const std::vector<float> outputs( 3 * batch_size, 1.f / 3.f );
+                for ( size_t i=0; i<pushes; i++ )
+                    trainer.push( batch_size, 36, inputs.data(), 3, outputs.data() );
+            } );
+        }
+        for ( auto& _producer : producers )
+            _producer.join();
+        trainer.wait();
+
+        const neurocl::async_batch_trainer::stats stats = trainer.get_stats();
+        const bool passed = ( stats.batches == producers_count * pushes ) && ( stats.samples == samples );
+
+        std::cout << "async batch trainer producers test : " << ( passed ? "PASSED" : "FAILED" ) << std::endl;
+    }
+
+    bfs::remove_all( s_data_path );
+
+    return 0;
+}
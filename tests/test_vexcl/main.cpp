@@ -22,10 +22,84 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
+#include "mlp/network_vexcl.h"
+#include "convnet/network.h"
+#include "convnet/network_vexcl.h"
+#include "common/network_exception.h"
+
+#include <cmath>
 #include <iostream>
+#include <random>
 #include <stdexcept>
 #include <vexcl/vexcl.hpp>
 
+using namespace neurocl;
+using namespace neurocl::mlp;
+
+bool compare( const float* a, const float* b, const size_t size )
+{
+    for ( size_t i=0; i<size; i++ )
+        if ( std::fabs( a[i] - b[i] ) > 1e-4f )
+            return false;
+    return true;
+}
+
+// compares convnet vexcl implementation with the reference implementation
+// NOTE : solver configuration is read from a convnet neurocl.xml file in the working directory
+bool convnet_test()
+{
+    using namespace neurocl::convnet;
+
+    const std::vector<layer_descr> layers{
+        layer_descr( INPUT_LAYER, 8, 8, 1, 0, true ),
+        layer_descr( CONV_LAYER, 6, 6, 2, 3, true ),
+        layer_descr( POOL_LAYER, 3, 3, 2, 0, true ),
+        layer_descr( FULL_LAYER, 4, 1, 1, 0, true ),
+        layer_descr( OUTPUT_LAYER, 3, 1, 1, 0, true ) };
+    const size_t in_size = layers.front().size();
+    const size_t out_size = layers.back().size();
+
+    convnet::network net_ref;
+    net_ref.add_layers( layers );
+    convnet::network_vexcl net_vexcl;
+    net_vexcl.add_layers( layers );
+
+    for ( size_t l=0; l<layers.size(); l++ )
+        net_vexcl.set_layer_ptr( l, net_ref.get_layer_ptr( l ) );
+
+    std::mt19937 rng( 0 );
+    std::uniform_real_distribution<float> dist( 0.f, 1.f );
+
+    std::vector<float> in( in_size );
+    std::vector<float> out{ 0.f, 1.f, 0.f };
+    for ( auto& v : in ) v = dist( rng );
+
+    net_ref.clear_gradients();
+    net_ref.set_input( in_size, in.data() );
+    net_ref.set_output( out_size, out.data() );
+    net_ref.feed_forward();
+    net_ref.back_propagate();
+    net_ref.gradient_descent();
+
+    net_vexcl.clear_gradients();
+    net_vexcl.set_input( in_size, in.data() );
+    net_vexcl.set_output( out_size, out.data() );
+    net_vexcl.feed_forward();
+    net_vexcl.back_propagate();
+    net_vexcl.gradient_descent();
+
+    bool ok = compare( net_ref.output().outputs.get(), net_vexcl.output().outputs.get(), out_size );
+    for ( size_t l=0; l<layers.size(); l++ )
+    {
+        const convnet::layer_ptr l_ref = net_ref.get_layer_ptr( l );
+        const convnet::layer_ptr l_vexcl = net_vexcl.get_layer_ptr( l );
+        ok &= compare( l_ref.weights.get(), l_vexcl.weights.get(), l_ref.num_weights );
+        ok &= compare( l_ref.bias.get(), l_vexcl.bias.get(), l_ref.num_bias );
+    }
+
+    return ok;
+}
+
 int main()
 {
     vex::Context ctx( vex::Filter::CPU );
@@ -34,4 +108,69 @@ int main()
 
     // Print out list of selected devices:
     std::cout << ctx << std::endl;
+
+    // network_vexcl falls back to CPU device (such as POCL) if no GPU is available
+
+    const std::vector<layer_size> sizes{ layer_size( 4, 4 ), layer_size( 3, 3 ), layer_size( 2, 1 ) };
+    const size_t batch_size = 5;
+    const size_t in_size = sizes.front().size();
+    const size_t out_size = sizes.back().size();
+
+    network_vexcl net_ref;
+    net_ref.add_layers_2d( sizes );
+    network_vexcl net_batch;
+    net_batch.add_layers_2d( sizes );
+
+    for ( size_t l=0; l<sizes.size()-1; l++ )
+        net_batch.set_layer_ptr( l, net_ref.get_layer_ptr( l ) );
+
+    std::mt19937 rng( 0 );
+    std::uniform_real_distribution<float> dist( 0.f, 1.f );
+
+    std::vector<float> in( batch_size * in_size );
+    std::vector<float> out( batch_size * out_size );
+    for ( auto& v : in ) v = dist( rng );
+    for ( auto& v : out ) v = dist( rng );
+
+    // BATCH FEED FORWARD (device resident vs per-sample transfers)
+
+    std::vector<float> res_ref( batch_size * out_size );
+    std::vector<float> res_batch( batch_size * out_size );
+
+    net_ref.network_interface::batch_feed_forward( batch_size, in_size, in.data(), out_size, res_ref.data() );
+    net_batch.batch_feed_forward( batch_size, in_size, in.data(), out_size, res_batch.data() );
+
+    std::cout << "batch_feed_forward test : " << ( compare( res_ref.data(), res_batch.data(), res_ref.size() ) ? "PASSED" : "FAILED" ) << std::endl;
+
+    // BATCH FEED BACK
+
+    net_ref.clear_gradients();
+    net_ref.network_interface::batch_feed_back( batch_size, in_size, in.data(), out_size, out.data() );
+    net_ref.gradient_descent();
+
+    net_batch.clear_gradients();
+    net_batch.batch_feed_back( batch_size, in_size, in.data(), out_size, out.data() );
+    net_batch.gradient_descent();
+
+    bool feed_back_ok = true;
+    for ( size_t l=0; l<sizes.size()-1; l++ )
+    {
+        const layer_ptr l_ref = net_ref.get_layer_ptr( l );
+        const layer_ptr l_batch = net_batch.get_layer_ptr( l );
+        feed_back_ok &= compare( l_ref.weights.get(), l_batch.weights.get(), l_ref.num_weights );
+        feed_back_ok &= compare( l_ref.bias.get(), l_batch.bias.get(), l_ref.num_bias );
+    }
+
+    std::cout << "batch_feed_back test : " << ( feed_back_ok ? "PASSED" : "FAILED" ) << std::endl;
+
+    // CONVNET
+
+    try
+    {
+        std::cout << "convnet test : " << ( convnet_test() ? "PASSED" : "FAILED" ) << std::endl;
+    }
+    catch( neurocl::network_exception& e )
+    {
+        std::cout << "convnet test : FAILED (" << e.what() << ")" << std::endl;
+    }
 }